@@ -0,0 +1,367 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 LCD display server. (shared memory, chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "typedefs.h"
+#include "i2c-lcd.h"
+#include "idle.h"
+#include "dispsrv.h"
+
+//------------------------------------------------------------------------------
+static	pthread_t		Thread;
+static	bool			Run = false;
+static	int				LcdFd;
+static	disp_shm_t		*Shm;
+static	disp_shm_t		*Client;		// disp_attach
+
+// server copy of the slots (seqlock read)
+static	disp_slot_t		Copy[DISP_SLOTS];
+static	uint_t			Seen[DISP_SLOTS];
+static	ulong_t			PostedAt[DISP_SLOTS];
+static	bool			Active[DISP_SLOTS];
+
+// last overlay sent, Pending : cut by a foreground write (or bus fault)
+static	char			Cells[LCD_ROW_MAX][LCD_COL_MAX];
+static	byte_t			Mask[LCD_ROW_MAX][LCD_COL_MAX];
+static	bool			Pending;
+
+//------------------------------------------------------------------------------
+static	ulong_t		disp_msec		(void);
+static	disp_shm_t	*disp_map		(int flags);
+static	void		disp_kick		(disp_shm_t *shm);
+static	void		disp_wait		(uint_t kick);
+static	int			disp_scan		(ulong_t now, bool check_owner);
+static	int			disp_compose	(bool force);
+static	void		*disp_thread	(void *arg);
+		int			disp_server_start	(int fd, int width, int height);
+		void		disp_server_stop	(void);
+		disp_shm_t	*disp_attach		(void);
+		disp_slot_t	*disp_claim			(disp_shm_t *shm, int prio,
+											int x, int y, int w, int h, int timeout_ms);
+		char		*disp_begin			(disp_slot_t *slot);
+		void		disp_end			(disp_slot_t *slot);
+		void		disp_post			(disp_slot_t *slot, int line, const char *text);
+		void		disp_release		(disp_slot_t *slot);
+
+//------------------------------------------------------------------------------
+static ulong_t disp_msec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+static disp_shm_t *disp_map (int flags)
+{
+	disp_shm_t *shm;
+	int fd;
+
+	if ((fd = open (DISP_SHM, O_RDWR | O_CLOEXEC | flags, 0666)) < 0)
+		return NULL;
+	// any user may post. (umask)
+	if (flags & O_CREAT) {
+		fchmod (fd, 0666);
+		if (ftruncate (fd, sizeof(disp_shm_t)) < 0) {
+			close (fd);
+			return NULL;
+		}
+	}
+	shm = mmap (NULL, sizeof(disp_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	return shm == MAP_FAILED ? NULL : shm;
+}
+
+//------------------------------------------------------------------------------
+// client change. (futex wake only if the server waits)
+//------------------------------------------------------------------------------
+static void disp_kick (disp_shm_t *shm)
+{
+	__sync_fetch_and_add (&shm->kick, 1);
+	if (shm->waiting)
+		syscall (SYS_futex, &shm->kick, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+//------------------------------------------------------------------------------
+// no timeout : a kick after the scan (kick changed) returns at once.
+//------------------------------------------------------------------------------
+static void disp_wait (uint_t kick)
+{
+	Shm->waiting = true;
+	__sync_synchronize ();
+	if (Run)
+		syscall (SYS_futex, &Shm->kick, FUTEX_WAIT, kick, NULL, NULL, 0);
+	Shm->waiting = false;
+}
+
+//------------------------------------------------------------------------------
+// copy the changed slots, drop the expired / orphan ones. return active slots.
+//------------------------------------------------------------------------------
+static int disp_scan (ulong_t now, bool check_owner)
+{
+	disp_slot_t *s;
+	uint_t seq;
+	int i, owner, active = 0;
+
+	for (i = 0; i < DISP_SLOTS; i++) {
+		s = &Shm->slot[i];
+		if ((owner = s->owner) == 0) {
+			Active[i] = false;
+			continue;
+		}
+		seq = s->seq;
+		// in the middle of a write : last copy stays, next frame.
+		if (!(seq & 1) && (seq != Seen[i])) {
+			__sync_synchronize ();
+			memcpy (&Copy[i], (const void *)s, sizeof(disp_slot_t));
+			__sync_synchronize ();
+			if (s->seq == seq) {
+				Seen[i]     = seq;
+				PostedAt[i] = now;
+				Active[i]   = true;
+			}
+		}
+		if (!Active[i])
+			continue;
+
+		if (Copy[i].timeout_ms) {
+			if (now - PostedAt[i] < Copy[i].timeout_ms)
+				continue;
+			Active[i] = false;
+			// gone owner : slot free for the next client.
+			if ((kill (owner, 0) < 0) && (errno == ESRCH))
+				__sync_bool_compare_and_swap (&s->owner, owner, 0);
+		} else if (check_owner && (kill (owner, 0) < 0) && (errno == ESRCH)) {
+			Active[i] = false;
+			__sync_bool_compare_and_swap (&s->owner, owner, 0);
+		}
+	}
+	for (i = 0; i < DISP_SLOTS; i++)
+		active += Active[i];
+	return active;
+}
+
+//------------------------------------------------------------------------------
+// low to high priority. (the same priority : slot order)
+// return false if put off for the bus budget. (force : send anyway)
+//------------------------------------------------------------------------------
+static int disp_compose (bool force)
+{
+	char cells[LCD_ROW_MAX][LCD_COL_MAX];
+	byte_t mask[LCD_ROW_MAX][LCD_COL_MAX];
+	int order[DISP_SLOTS], n = 0, i, j, x, y, t, changed = 0;
+	disp_slot_t *s;
+
+	for (i = 0; i < DISP_SLOTS; i++) {
+		if (!Active[i])
+			continue;
+		for (j = n++; (j > 0) && (Copy[order[j - 1]].prio > Copy[i].prio); j--)
+			order[j] = order[j - 1];
+		order[j] = i;
+	}
+
+	memset (cells, ' ', sizeof(cells));
+	memset (mask,  0,   sizeof(mask));
+	for (t = 0; t < n; t++) {
+		s = &Copy[order[t]];
+		for (y = s->y; (y < s->y + s->height) && (y < Shm->height); y++) {
+			for (x = s->x; (x < s->x + s->width) && (x < Shm->width); x++) {
+				cells[y][x] = s->text[y][x] ? s->text[y][x] : ' ';
+				mask [y][x] = 1;
+			}
+		}
+	}
+
+	for (y = 0; y < Shm->height; y++)
+		for (x = 0; x < Shm->width; x++)
+			changed += (cells[y][x] != Cells[y][x]) || (mask[y][x] != Mask[y][x]);
+	if (!changed && !Pending)
+		return true;
+	// over the bus budget : the slot changes coalesce into a later frame.
+	if (!force && !lcd_budget (lcd_cost_us (changed ? changed : Shm->width)))
+		return false;
+
+	memcpy (Cells, cells, sizeof(cells));
+	memcpy (Mask,  mask,  sizeof(mask));
+	Pending = !lcd_overlay (LcdFd, &Cells[0][0], &Mask[0][0]);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// no slot shown, nothing left to send : sleep until a client kicks.
+// frames put off for the bus budget : one goes anyway after DISP_LATE_MS.
+//------------------------------------------------------------------------------
+static void *disp_thread (void *arg)
+{
+	struct timespec ts = { 0, DISP_FRAME_MS * 1000000L };
+	ulong_t frame = 0;
+	uint_t kick;
+	int active, late = 0;
+	(void)arg;
+
+	while (Run) {
+		// kick before the scan : a change after it ends the wait.
+		kick = Shm->kick;
+		__sync_synchronize ();
+		active = disp_scan (disp_msec (), !(frame++ % DISP_OWNER_CHECK));
+		late   = disp_compose (late >= DISP_LATE_MS) ? 0 : late + DISP_FRAME_MS;
+		if (!active && !late && !Pending)
+			disp_wait (kick);
+		else
+			nanosleep (&ts, NULL);
+		idle_wakeup ();
+	}
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// slots of a restarted server stay. (clients keep their mapping)
+//------------------------------------------------------------------------------
+int disp_server_start (int fd, int width, int height)
+{
+	if (Run)
+		return true;
+	if ((Shm = disp_map (O_CREAT)) == NULL) {
+		err ("%s : %s\n", DISP_SHM, strerror (errno));
+		return false;
+	}
+	if (Shm->magic != DISP_MAGIC) {
+		memset (Shm, 0, sizeof(disp_shm_t));
+		Shm->magic = DISP_MAGIC;
+	}
+	Shm->width  = width  > LCD_COL_MAX ? LCD_COL_MAX : width;
+	Shm->height = height > LCD_ROW_MAX ? LCD_ROW_MAX : height;
+	Shm->waiting = false;
+
+	LcdFd = fd;
+	memset (Seen, 0, sizeof(Seen));
+	memset (Active, 0, sizeof(Active));
+	memset (Cells, ' ', sizeof(Cells));
+	memset (Mask,  0,   sizeof(Mask));
+	Pending = false;
+	Run = true;
+	if (pthread_create (&Thread, NULL, disp_thread, NULL)) {
+		Run = false;
+		munmap (Shm, sizeof(disp_shm_t));
+		return false;
+	}
+	info ("display server : %s, %d slots\n", DISP_SHM, DISP_SLOTS);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+void disp_server_stop (void)
+{
+	if (!Run)
+		return;
+	Run = false;
+	disp_kick (Shm);
+	pthread_join (Thread, NULL);
+	munmap (Shm, sizeof(disp_shm_t));
+	Shm = NULL;
+}
+
+//------------------------------------------------------------------------------
+disp_shm_t *disp_attach (void)
+{
+	disp_shm_t *shm = disp_map (0);
+
+	if (shm && (shm->magic != DISP_MAGIC)) {
+		munmap (shm, sizeof(disp_shm_t));
+		return NULL;
+	}
+	if (shm)
+		Client = shm;
+	return shm;
+}
+
+//------------------------------------------------------------------------------
+disp_slot_t *disp_claim (disp_shm_t *shm, int prio,
+							int x, int y, int w, int h, int timeout_ms)
+{
+	disp_slot_t *s;
+	int i, pid = getpid ();
+
+	for (i = 0; i < DISP_SLOTS; i++) {
+		s = &shm->slot[i];
+		if (!__sync_bool_compare_and_swap (&s->owner, 0, pid))
+			continue;
+
+		disp_begin (s);
+		s->prio       = prio;
+		s->x          = x;	s->y      = y;
+		s->width      = w;	s->height = h;
+		s->timeout_ms = timeout_ms;
+		memset (s->text, 0, sizeof(s->text));
+		disp_end (s);
+		return s;
+	}
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// text[LCD_ROW_MAX][LCD_COL_MAX] of the slot, write then disp_end.
+//------------------------------------------------------------------------------
+char *disp_begin (disp_slot_t *slot)
+{
+	slot->seq++;
+	__sync_synchronize ();
+	return &slot->text[0][0];
+}
+
+//------------------------------------------------------------------------------
+void disp_end (disp_slot_t *slot)
+{
+	__sync_synchronize ();
+	slot->seq++;
+	if (Client)
+		disp_kick (Client);
+}
+
+//------------------------------------------------------------------------------
+// one line of the region. (cut / padded to the region width)
+//------------------------------------------------------------------------------
+void disp_post (disp_slot_t *slot, int line, const char *text)
+{
+	char *row;
+	int i, y = slot->y + line;
+
+	if ((line < 0) || (line >= slot->height) || (y >= LCD_ROW_MAX))
+		return;
+
+	row = disp_begin (slot) + y * LCD_COL_MAX;
+	for (i = slot->x; (i < slot->x + slot->width) && (i < LCD_COL_MAX); i++)
+		row[i] = *text ? *text++ : ' ';
+	disp_end (slot);
+}
+
+//------------------------------------------------------------------------------
+void disp_release (disp_slot_t *slot)
+{
+	disp_begin (slot);
+	memset (slot->text, 0, sizeof(slot->text));
+	disp_end (slot);
+	slot->owner = 0;
+	if (Client)
+		disp_kick (Client);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 LCD display server. (shared memory, chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __DISPSRV_H__
+#define __DISPSRV_H__
+
+#include "typedefs.h"
+#include "i2c-lcd.h"
+//------------------------------------------------------------------------------
+/*
+	Other processes show text on the lcd through DISP_SHM. (mmap)
+
+	client : disp_attach, disp_claim a slot (screen region, priority,
+	timeout), then write the text straight into slot->text between
+	disp_begin / disp_end. (or disp_post) no syscall, no copy.
+	seq is odd while the client writes, the server takes only even,
+	unchanged seq copies. (seqlock)
+
+	server : every DISP_FRAME_MS the changed slots are copied, the active
+	slots are painted low to high priority over the screen and the cells
+	go to lcd_overlay. (only the changed cells reach the bus)
+	A frame that does not fit the lcd bus budget (lcd_budget) waits, the
+	changes of the next frames merge into it. A frame cut by a foreground
+	write is sent again with the next frame.
+	A slot is shown timeout_ms after its last post, timeout 0 : while the
+	owner process lives.
+	No slot shown and nothing left to send : the server sleeps on a futex
+	(kick) until a client claims, posts or releases. A client only makes
+	the syscall if the server is waiting.
+*/
+//------------------------------------------------------------------------------
+#define	DISP_SHM			"/dev/shm/netinfo_display"
+#define	DISP_MAGIC			0x44535032	// "DSP2"
+#define	DISP_SLOTS			8
+#define	DISP_FRAME_MS		50
+#define	DISP_LATE_MS		1000		// frame put off for the bus budget
+#define	DISP_OWNER_CHECK	20			// frames, dead owner check
+#define	DISP_POST_PRIO		1			// -p
+#define	DISP_POST_TIMEOUT	10000		// ms, -p
+
+//------------------------------------------------------------------------------
+typedef struct disp_slot__t {
+	volatile uint_t	seq;			// odd : client writing
+	volatile int	owner;			// pid, 0 : free
+	byte_t			prio;			// higher on top
+	byte_t			x, y, width, height;
+	uint_t			timeout_ms;
+	// screen position, 0 = space
+	char			text[LCD_ROW_MAX][LCD_COL_MAX];
+}	disp_slot_t;
+
+typedef struct disp_shm__t {
+	uint_t			magic;
+	byte_t			width, height;	// lcd size
+	volatile uint_t	kick;			// futex, client change count
+	volatile uint_t	waiting;		// server sleeps on kick
+	disp_slot_t		slot[DISP_SLOTS];
+}	disp_shm_t;
+
+//------------------------------------------------------------------------------
+// server
+extern int			disp_server_start	(int fd, int width, int height);
+extern void			disp_server_stop	(void);
+
+// client
+extern disp_shm_t	*disp_attach		(void);
+extern disp_slot_t	*disp_claim			(disp_shm_t *shm, int prio,
+											int x, int y, int w, int h, int timeout_ms);
+extern char			*disp_begin			(disp_slot_t *slot);
+extern void			disp_end			(disp_slot_t *slot);
+extern void			disp_post			(disp_slot_t *slot, int line, const char *text);
+extern void			disp_release		(disp_slot_t *slot);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __DISPSRV_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
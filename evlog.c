@@ -0,0 +1,275 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Network event history ring. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+
+#include "typedefs.h"
+#include "evlog.h"
+
+//------------------------------------------------------------------------------
+static	evlog_file_t	*File = NULL;
+static	bool			Writable = false;
+static	uint_t			Seq = 0;		// last written / highest valid
+
+//------------------------------------------------------------------------------
+static	bool		rec_get			(uint_t n, evlog_rec_t *r);
+static	int			flaps_scan		(evlog_flap_t *f, int max, time_t now);
+static	void		format_secs		(char *buf, int size, ulong_t secs);
+		int			evlog_open		(const char *path, bool write);
+		void		evlog_add		(int type, bool up, uint_t value);
+		int			evlog_flaps		(evlog_flap_t *f, int max);
+		int			evlog_summary	(time_t since, ulong_t *down_secs);
+		int			evlog_dump		(const char *path);
+
+//------------------------------------------------------------------------------
+// copy of event n. (false : overwritten, empty or cut)
+//------------------------------------------------------------------------------
+static bool rec_get (uint_t n, evlog_rec_t *r)
+{
+	evlog_rec_t *s = &File->rec[(n - 1) & (EVLOG_RECORDS - 1)];
+
+	if (!n || (s->seq != n))
+		return false;
+	__sync_synchronize ();
+	memcpy (r, (const void *)s, sizeof(evlog_rec_t));
+	__sync_synchronize ();
+	return s->seq == n;
+}
+
+//------------------------------------------------------------------------------
+// probe down ~ up pairs of the ring, oldest first. (return count)
+//------------------------------------------------------------------------------
+static int flaps_scan (evlog_flap_t *f, int max, time_t now)
+{
+	evlog_rec_t r;
+	uint_t n = (Seq > EVLOG_RECORDS) ? Seq - EVLOG_RECORDS + 1 : 1;
+	int count = 0;
+	bool down = false;
+
+	for (; File && (n <= Seq); n++) {
+		if (!rec_get (n, &r))
+			continue;
+		// daemon start : a down still open ended with the last run.
+		if (r.type == EVLOG_START) {
+			if (down) {
+				f[count].secs    = (r.time > f[count].down) ? r.time - f[count].down : 0;
+				f[count].ongoing = false;
+				count++;
+				down = false;
+			}
+			continue;
+		}
+		if (r.type != EVLOG_PROBE)
+			continue;
+		if (!r.up && !down) {
+			// full : the oldest one out.
+			if (count == max) {
+				memmove (&f[0], &f[1], sizeof(evlog_flap_t) * (max - 1));
+				count--;
+			}
+			f[count].down    = r.time;
+			f[count].ongoing = true;
+			down = true;
+		} else if (r.up && down) {
+			f[count].secs    = (r.time > f[count].down) ? r.time - f[count].down : 0;
+			f[count].ongoing = false;
+			count++;
+			down = false;
+		}
+	}
+	if (down) {
+		f[count].secs = (now > f[count].down) ? now - f[count].down : 0;
+		count++;
+	}
+	return count;
+}
+
+//------------------------------------------------------------------------------
+static void format_secs (char *buf, int size, ulong_t secs)
+{
+	if (secs < 60)
+		snprintf (buf, size, "%lus", secs);
+	else if (secs < 3600)
+		snprintf (buf, size, "%lum%02lus", secs / 60, secs % 60);
+	else if (secs < 86400)
+		snprintf (buf, size, "%luh%02lum", secs / 3600, secs / 60 % 60);
+	else
+		snprintf (buf, size, "%lud%02luh", secs / 86400, secs / 3600 % 24);
+}
+
+//------------------------------------------------------------------------------
+// write : create / reset the file if not an event ring. read : dump.
+//------------------------------------------------------------------------------
+int evlog_open (const char *path, bool write)
+{
+	evlog_file_t *m;
+	uint_t n;
+	int fd, prot = write ? PROT_READ | PROT_WRITE : PROT_READ;
+
+	if ((fd = open (path, (write ? O_RDWR | O_CREAT : O_RDONLY) | O_CLOEXEC, 0644)) < 0) {
+		err ("%s : can't open %s\n", __func__, path);
+		return false;
+	}
+	if (write && (ftruncate (fd, sizeof(evlog_file_t)) < 0)) {
+		close (fd);
+		return false;
+	}
+	m = mmap (NULL, sizeof(evlog_file_t), prot, MAP_SHARED, fd, 0);
+	close (fd);
+	if (m == MAP_FAILED)
+		return false;
+
+	if ((m->magic != EVLOG_MAGIC) || (m->records != EVLOG_RECORDS) ||
+		(m->rec_size != sizeof(evlog_rec_t))) {
+		if (!write) {
+			err ("%s : %s is not an event ring\n", __func__, path);
+			munmap (m, sizeof(evlog_file_t));
+			return false;
+		}
+		memset (m, 0, sizeof(evlog_file_t));
+		m->records  = EVLOG_RECORDS;
+		m->rec_size = sizeof(evlog_rec_t);
+		__sync_synchronize ();
+		m->magic    = EVLOG_MAGIC;
+	}
+	// head : the highest seq sitting in its own slot.
+	for (Seq = 0, n = 0; n < EVLOG_RECORDS; n++)
+		if ((m->rec[n].seq > Seq) &&
+			(((m->rec[n].seq - 1) & (EVLOG_RECORDS - 1)) == n))
+			Seq = m->rec[n].seq;
+	File     = m;
+	Writable = write;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// plain stores into the mapping. (the kernel writes the page back)
+//------------------------------------------------------------------------------
+void evlog_add (int type, bool up, uint_t value)
+{
+	evlog_rec_t *r;
+	uint_t n;
+
+	if (!File || !Writable)
+		return;
+	n = ++Seq;
+	r = &File->rec[(n - 1) & (EVLOG_RECORDS - 1)];
+	r->seq = 0;
+	__sync_synchronize ();
+	r->time     = (uint_t)time (NULL);
+	r->type     = type;
+	r->up       = up ? 1 : 0;
+	r->reserved = 0;
+	r->value    = value;
+	__sync_synchronize ();
+	r->seq = n;
+}
+
+//------------------------------------------------------------------------------
+// last flaps, newest first. (return count)
+//------------------------------------------------------------------------------
+int evlog_flaps (evlog_flap_t *f, int max)
+{
+	static evlog_flap_t all[EVLOG_FLAP_MAX];
+	int count, i;
+
+	count = flaps_scan (all, EVLOG_FLAP_MAX, time (NULL));
+	for (i = 0; (i < max) && (i < count); i++)
+		f[i] = all[count - 1 - i];
+	return i;
+}
+
+//------------------------------------------------------------------------------
+// flaps and down seconds since the time. (an earlier flap : its part after since)
+//------------------------------------------------------------------------------
+int evlog_summary (time_t since, ulong_t *down_secs)
+{
+	static evlog_flap_t all[EVLOG_FLAP_MAX];
+	time_t now = time (NULL), start, end;
+	int count, i, flaps = 0;
+
+	*down_secs = 0;
+	count = flaps_scan (all, EVLOG_FLAP_MAX, now);
+	for (i = 0; i < count; i++) {
+		end = all[i].down + all[i].secs;
+		if (end < since)
+			continue;
+		start = (all[i].down < since) ? since : all[i].down;
+		if (all[i].down >= since)
+			flaps++;
+		*down_secs += end - start;
+	}
+	return flaps;
+}
+
+//------------------------------------------------------------------------------
+// CLI : every event of the ring, the last 24 hours summary.
+//------------------------------------------------------------------------------
+int evlog_dump (const char *path)
+{
+	static const char *names[] = { "?", "start", "link", "addr", "probe" };
+	char stamp[32], secs[16];
+	evlog_rec_t r;
+	struct in_addr in;
+	time_t t, down = 0;
+	ulong_t total;
+	uint_t n;
+	int flaps;
+
+	if (!evlog_open (path, false))
+		return false;
+
+	n = (Seq > EVLOG_RECORDS) ? Seq - EVLOG_RECORDS + 1 : 1;
+	for (; n <= Seq; n++) {
+		if (!rec_get (n, &r))
+			continue;
+		t = r.time;
+		strftime (stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", localtime (&t));
+		printf ("%6u  %s  %-5s  %-4s", r.seq, stamp,
+			names[r.type <= EVLOG_PROBE ? r.type : 0],
+			r.type == EVLOG_START ? "" : (r.up ? "up" : "down"));
+
+		switch (r.type) {
+		case EVLOG_START:
+			down = 0;
+			break;
+		case EVLOG_LINK:
+			if (r.value)
+				printf ("  %uM", r.value);
+			break;
+		case EVLOG_ADDR:
+			in.s_addr = r.value;
+			if (r.value)
+				printf ("  %s", inet_ntoa (in));
+			break;
+		case EVLOG_PROBE:
+			if (!r.up)
+				down = t;
+			else if (down) {
+				format_secs (secs, sizeof(secs), t > down ? t - down : 0);
+				printf ("  (down %s)", secs);
+				down = 0;
+			}
+			break;
+		}
+		printf ("\n");
+	}
+	flaps = evlog_summary (time (NULL) - EVLOG_HISTORY_SEC, &total);
+	format_secs (secs, sizeof(secs), total);
+	printf ("last 24h : %d flaps, down %s\n", flaps, secs);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
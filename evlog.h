@@ -0,0 +1,72 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Network event history ring. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __EVLOG_H__
+#define __EVLOG_H__
+
+#include <time.h>
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	Link, address and probe transitions go to a fixed size ring file mapped
+	shared (MAP_SHARED), the kernel writes the pages back. An event is a few
+	stores into the mapping, no system call.
+	The slot of event n is (n - 1) % EVLOG_RECORDS, seq is cleared first
+	and written last : a record is valid only if its seq is n. A write cut
+	by a crash leaves seq 0 and the record is skipped. The next seq is the
+	highest valid one of the file, no head index to tear.
+*/
+//------------------------------------------------------------------------------
+#define	EVLOG_FILE			"/var/cache/netinfo_display.events"
+#define	EVLOG_MAGIC			0x45564C31	// "EVL1"
+#define	EVLOG_RECORDS		256			// power of 2
+#define	EVLOG_FLAP_MAX		(EVLOG_RECORDS / 2)
+#define	EVLOG_HISTORY_SEC	(24 * 3600)	// history page window
+#define	EVLOG_PAGE_FLAPS	3			// flaps shown on the history page
+
+enum {
+	EVLOG_START = 1,		// daemon start
+	EVLOG_LINK,				// value : link speed (Mbps)
+	EVLOG_ADDR,				// value : ipv4 address (network order)
+	EVLOG_PROBE,			// value : rtt (usec)
+};
+
+//------------------------------------------------------------------------------
+typedef struct evlog_rec__t {
+	volatile uint_t	seq;				// 0 : empty or cut
+	uint_t			time;				// wall clock
+	byte_t			type;
+	byte_t			up;
+	word_t			reserved;
+	uint_t			value;
+}	evlog_rec_t;
+
+typedef struct evlog_file__t {
+	uint_t			magic;
+	uint_t			records;
+	uint_t			rec_size;
+	uint_t			reserved;
+	evlog_rec_t		rec[EVLOG_RECORDS];
+}	evlog_file_t;
+
+// probe down ~ up. (ongoing : still down, secs until now)
+typedef struct evlog_flap__t {
+	time_t			down;
+	ulong_t			secs;
+	bool			ongoing;
+}	evlog_flap_t;
+
+//------------------------------------------------------------------------------
+extern int	evlog_open		(const char *path, bool write);
+extern void	evlog_add		(int type, bool up, uint_t value);
+extern int	evlog_flaps		(evlog_flap_t *f, int max);
+extern int	evlog_summary	(time_t since, ulong_t *down_secs);
+extern int	evlog_dump		(const char *path);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __EVLOG_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,462 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Fleet beacon / collector. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#define	_GNU_SOURCE		// recvmmsg
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/random.h>
+#include <linux/if_packet.h>
+
+#include "typedefs.h"
+#include "idle.h"
+#include "fleet.h"
+
+//------------------------------------------------------------------------------
+typedef struct fleet_node__t {
+	unsigned long long	id;			// 0 : empty
+	uint_t		seq, epoch;
+	ulong_t		seen;				// msec, last beacon
+	ulong_t		changed;			// msec, last up <-> down
+	int			rtt;
+	byte_t		alive;				// probe result of the node
+	byte_t		down;				// !alive or stale
+	byte_t		ifcount;
+	char		host[FLEET_HOST_MAX];
+	fleet_if_t	ifs[FLEET_IF_MAX];
+}	fleet_node_t;
+
+//------------------------------------------------------------------------------
+// beacon
+static	int				TxFd = -1;
+static	struct sockaddr_in	TxAddr;
+static	uint_t			TxSeq, TxEpoch;
+
+// collector (table : collector thread only, summary : Lock)
+static	pthread_t		Thread;
+static	int				RxFd = -1;
+static	fleet_node_t	Table[FLEET_TABLE_SIZE];
+static	int				Count;
+static	ulong_t			Beacons, Dropped;
+static	pthread_mutex_t	Lock = PTHREAD_MUTEX_INITIALIZER;
+static	fleet_summary_t	Summary;
+
+//------------------------------------------------------------------------------
+static	ulong_t	fleet_msec		(void);
+static	int		fleet_addr		(const char *arg, struct sockaddr_in *sa);
+static	int		fleet_ifs		(fleet_beacon_t *b);
+static	uint_t	fleet_hash		(unsigned long long id);
+static	fleet_node_t	*node_get	(unsigned long long id);
+static	void	node_del		(uint_t i);
+static	void	node_state		(fleet_node_t *n, bool down, ulong_t now);
+static	void	fleet_rx		(const fleet_beacon_t *b, int len, ulong_t now);
+static	ulong_t	fleet_sweep		(ulong_t now);
+static	void	*fleet_thread	(void *arg);
+		int		fleet_beacon_open		(const char *addr);
+		int		fleet_beacon_send		(int alive, int rtt);
+		int		fleet_collector_start	(const char *addr);
+		int		fleet_summary			(fleet_summary_t *s);
+
+//------------------------------------------------------------------------------
+static ulong_t fleet_msec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+// "auto" : FLEET_GROUP, "addr[:port]"
+//------------------------------------------------------------------------------
+static int fleet_addr (const char *arg, struct sockaddr_in *sa)
+{
+	char host[32], *p;
+
+	snprintf (host, sizeof(host), "%s", strcmp (arg, "auto") ? arg : FLEET_GROUP);
+	memset (sa, 0, sizeof(*sa));
+	sa->sin_family = AF_INET;
+	sa->sin_port   = htons (FLEET_PORT);
+	if ((p = strchr (host, ':')) != NULL) {
+		*p++ = 0;
+		sa->sin_port = htons (atoi (p));
+	}
+	if (!inet_pton (AF_INET, host, &sa->sin_addr)) {
+		err ("fleet address : %s\n", arg);
+		return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// ipv4 interfaces (no loopback), node id = mac of the first interface.
+//------------------------------------------------------------------------------
+static int fleet_ifs (fleet_beacon_t *b)
+{
+	struct ifaddrs *ifa, *p;
+	struct sockaddr_ll *ll;
+	fleet_if_t *fi;
+	char path[64], buf[16];
+	int fd, len;
+
+	if (getifaddrs (&ifa) < 0)
+		return false;
+
+	for (p = ifa; p; p = p->ifa_next) {
+		if (!p->ifa_addr || (p->ifa_flags & IFF_LOOPBACK))
+			continue;
+		if (p->ifa_addr->sa_family == AF_PACKET) {
+			ll = (struct sockaddr_ll *)p->ifa_addr;
+			if (!b->id[0] && !b->id[1] && !b->id[2] && (ll->sll_halen == 6))
+				memcpy (b->id, ll->sll_addr, 6);
+			continue;
+		}
+		if ((p->ifa_addr->sa_family != AF_INET) || (b->ifcount >= FLEET_IF_MAX))
+			continue;
+
+		fi = &b->ifs[b->ifcount++];
+		strncpy (fi->name, p->ifa_name, sizeof(fi->name));
+		fi->ip     = ((struct sockaddr_in *)p->ifa_addr)->sin_addr.s_addr;
+		fi->up     = (p->ifa_flags & IFF_RUNNING) ? 1 : 0;
+		fi->duplex = 0xff;
+
+		// wifi / down link : no speed file or -1.
+		snprintf (path, sizeof(path), "/sys/class/net/%s/speed", p->ifa_name);
+		if ((fd = open (path, O_RDONLY)) >= 0) {
+			if ((len = read (fd, buf, sizeof(buf) -1)) > 0) {
+				buf[len] = 0;
+				fi->speed = atoi (buf) > 0 ? htons (atoi (buf)) : 0;
+			}
+			close (fd);
+		}
+		snprintf (path, sizeof(path), "/sys/class/net/%s/duplex", p->ifa_name);
+		if ((fd = open (path, O_RDONLY)) >= 0) {
+			if (read (fd, buf, 4) == 4)
+				fi->duplex = !strncmp (buf, "full", 4) ? 1 :
+							 !strncmp (buf, "half", 4) ? 0 : 0xff;
+			close (fd);
+		}
+	}
+	freeifaddrs (ifa);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+static uint_t fleet_hash (unsigned long long id)
+{
+	return (uint_t)((id * 0x9E3779B97F4A7C15ULL) >> (64 - FLEET_TABLE_BITS));
+}
+
+//------------------------------------------------------------------------------
+// find or add. (NULL : table full)
+//------------------------------------------------------------------------------
+static fleet_node_t *node_get (unsigned long long id)
+{
+	uint_t i = fleet_hash (id);
+
+	while (Table[i].id) {
+		if (Table[i].id == id)
+			return &Table[i];
+		i = (i + 1) & (FLEET_TABLE_SIZE -1);
+	}
+	if (Count >= FLEET_NODE_MAX)
+		return NULL;
+
+	memset (&Table[i], 0, sizeof(fleet_node_t));
+	Table[i].id = id;
+	Count++;
+	return &Table[i];
+}
+
+//------------------------------------------------------------------------------
+// records after the hole move back if their home slot allows it.
+//------------------------------------------------------------------------------
+static void node_del (uint_t i)
+{
+	uint_t j = i, home;
+
+	while (true) {
+		j = (j + 1) & (FLEET_TABLE_SIZE -1);
+		if (!Table[j].id)
+			break;
+		home = fleet_hash (Table[j].id);
+		// home in (i, j] (cyclic) : stays.
+		if (((j - home) & (FLEET_TABLE_SIZE -1)) < ((j - i) & (FLEET_TABLE_SIZE -1)))
+			continue;
+		Table[i] = Table[j];
+		i = j;
+	}
+	Table[i].id = 0;
+	Count--;
+}
+
+//------------------------------------------------------------------------------
+static void node_state (fleet_node_t *n, bool down, ulong_t now)
+{
+	if (n->down == down)
+		return;
+	n->down    = down;
+	n->changed = now;
+	info ("fleet : %-16.16s %s\n", n->host, down ? "down" : "up");
+}
+
+//------------------------------------------------------------------------------
+static void fleet_rx (const fleet_beacon_t *b, int len, ulong_t now)
+{
+	unsigned long long id = 0;
+	fleet_node_t *n;
+	uint_t seq;
+	int i;
+
+	if ((len < (int)offsetof (fleet_beacon_t, ifs)) || (ntohl (b->magic) != FLEET_MAGIC) ||
+		(b->ifcount > FLEET_IF_MAX) ||
+		(len < (int)(offsetof (fleet_beacon_t, ifs) + b->ifcount * sizeof(fleet_if_t)))) {
+		Dropped++;
+		return;
+	}
+	for (i = 0; i < 6; i++)
+		id = (id << 8) | b->id[i];
+	if (!id || ((n = node_get (id)) == NULL)) {
+		Dropped++;
+		return;
+	}
+
+	// reordered / duplicated. (seq order only within the epoch of the sender)
+	seq = ntohl (b->seq);
+	if (n->seen && (n->epoch == ntohl (b->epoch)) && ((int)(seq - n->seq) <= 0)) {
+		Dropped++;
+		return;
+	}
+	Beacons++;
+	// first beacon : not a change. (collector restart)
+	if (!n->seen) {
+		n->down    = !b->alive;
+		n->changed = now - FLEET_CHANGE_SEC * 1000UL;
+	}
+	n->seq     = seq;
+	n->epoch   = ntohl (b->epoch);
+	n->seen    = now;
+	n->alive   = b->alive;
+	n->rtt     = (int)ntohl (b->rtt);
+	n->ifcount = b->ifcount;
+	memcpy (n->host, b->host, FLEET_HOST_MAX);
+	n->host[FLEET_HOST_MAX -1] = 0;
+	memcpy (n->ifs, b->ifs, b->ifcount * sizeof(fleet_if_t));
+	node_state (n, !b->alive, now);
+}
+
+//------------------------------------------------------------------------------
+// expired : removed, stale : down, then the summary.
+// return the next deadline of a node. (0 : no node)
+//------------------------------------------------------------------------------
+static ulong_t fleet_sweep (ulong_t now)
+{
+	fleet_summary_t s;
+	fleet_node_t *n;
+	ulong_t next = 0, t;
+	uint_t i;
+
+	memset (&s, 0, sizeof(s));
+	s.worst_rtt = -1;
+
+	// moved back record : the slot is checked again.
+	for (i = 0; i < FLEET_TABLE_SIZE; i++) {
+		while (Table[i].id && (now - Table[i].seen >= FLEET_EXPIRE_SEC * 1000UL))
+			node_del (i);
+	}
+
+	for (i = 0; i < FLEET_TABLE_SIZE; i++) {
+		n = &Table[i];
+		if (!n->id)
+			continue;
+		if (now - n->seen >= FLEET_STALE_SEC * 1000UL)
+			node_state (n, true, now);
+
+		s.nodes++;
+		if (n->down)
+			s.down++;
+		else {
+			s.up++;
+			if (n->rtt > s.worst_rtt) {
+				s.worst_rtt = n->rtt;
+				memcpy (s.worst, n->host, FLEET_HOST_MAX);
+			}
+		}
+		if (now - n->changed < FLEET_CHANGE_SEC * 1000UL) {
+			s.changed++;
+			t = n->changed + FLEET_CHANGE_SEC * 1000UL;
+			if (!next || (t < next))
+				next = t;
+		}
+		t = n->seen + (n->down ? FLEET_EXPIRE_SEC : FLEET_STALE_SEC) * 1000UL;
+		if (!next || (t < next))
+			next = t;
+	}
+	s.beacons = Beacons;
+	s.dropped = Dropped;
+
+	pthread_mutex_lock (&Lock);
+	Summary = s;
+	pthread_mutex_unlock (&Lock);
+	return next;
+}
+
+//------------------------------------------------------------------------------
+static void *fleet_thread (void *arg)
+{
+	static fleet_beacon_t buf[FLEET_BATCH];
+	struct mmsghdr msg[FLEET_BATCH];
+	struct iovec iov[FLEET_BATCH];
+	struct pollfd pfd = { RxFd, POLLIN, 0 };
+	ulong_t now = fleet_msec (), swept = 0, due = 0;
+	int i, n;
+	(void)arg;
+
+	for (i = 0; i < FLEET_BATCH; i++) {
+		iov[i].iov_base = &buf[i];
+		iov[i].iov_len  = sizeof(fleet_beacon_t);
+		memset (&msg[i], 0, sizeof(msg[i]));
+		msg[i].msg_hdr.msg_iov    = &iov[i];
+		msg[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	// due : next sweep. (0 : none, no node and no beacon)
+	while (true) {
+		// burst : whole batches until the socket is empty.
+		if (poll (&pfd, 1, !due ? -1 : (due > now ? (int)(due - now) : 0)) > 0) {
+			while ((n = recvmmsg (RxFd, msg, FLEET_BATCH, MSG_DONTWAIT, NULL)) > 0) {
+				now = fleet_msec ();
+				for (i = 0; i < n; i++)
+					fleet_rx (&buf[i], msg[i].msg_len, now);
+				if (n < FLEET_BATCH)
+					break;
+			}
+			// beacons : the summary at most once a second.
+			if (!due || (swept + 1000 < due))
+				due = swept + 1000;
+		}
+		idle_wakeup ();
+		now = fleet_msec ();
+		if (due && (now >= due)) {
+			due = fleet_sweep (now);
+			swept = now;
+		}
+	}
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+int fleet_beacon_open (const char *addr)
+{
+	byte_t ttl = 1;
+
+	if (!fleet_addr (addr, &TxAddr))
+		return false;
+	if ((TxFd = socket (AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0)
+		return false;
+	// rack local.
+	setsockopt (TxFd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+	// not the time : a node without rtc may start earlier than the last run.
+	if (getrandom (&TxEpoch, sizeof(TxEpoch), GRND_NONBLOCK) != sizeof(TxEpoch))
+		TxEpoch = (uint_t)time (NULL) ^ ((uint_t)getpid () << 16);
+	TxSeq = 0;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+int fleet_beacon_send (int alive, int rtt)
+{
+	fleet_beacon_t b;
+	int len;
+
+	if (TxFd < 0)
+		return false;
+
+	memset (&b, 0, sizeof(b));
+	b.magic = htonl (FLEET_MAGIC);
+	b.seq   = htonl (TxSeq++);
+	b.epoch = htonl (TxEpoch);
+	b.alive = alive ? 1 : 0;
+	b.rtt   = (int)htonl ((uint_t)rtt);
+	gethostname (b.host, sizeof(b.host) -1);
+	fleet_ifs (&b);
+	// no mac : FNV-1a of the host name.
+	if (!b.id[0] && !b.id[1] && !b.id[2]) {
+		unsigned long long h = 0xcbf29ce484222325ULL;
+		for (len = 0; b.host[len]; len++)
+			h = (h ^ (byte_t)b.host[len]) * 0x100000001b3ULL;
+		memcpy (b.id, &h, sizeof(b.id));
+		b.id[0] |= 0x02;	// locally administered
+	}
+
+	len = offsetof (fleet_beacon_t, ifs) + b.ifcount * sizeof(fleet_if_t);
+	return sendto (TxFd, &b, len, 0, (struct sockaddr *)&TxAddr, sizeof(TxAddr)) == len;
+}
+
+//------------------------------------------------------------------------------
+// group address : joined on the default interface.
+//------------------------------------------------------------------------------
+int fleet_collector_start (const char *addr)
+{
+	struct sockaddr_in sa, any;
+	struct ip_mreq mreq;
+	int on = 1, size = FLEET_RCVBUF;
+
+	if (!fleet_addr (addr, &sa))
+		return false;
+	if ((RxFd = socket (AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0)
+		return false;
+
+	setsockopt (RxFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	setsockopt (RxFd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	any = sa;
+	any.sin_addr.s_addr = htonl (INADDR_ANY);
+	if (bind (RxFd, (struct sockaddr *)&any, sizeof(any)) < 0)
+		goto out;
+	if (IN_MULTICAST (ntohl (sa.sin_addr.s_addr))) {
+		mreq.imr_multiaddr        = sa.sin_addr;
+		mreq.imr_interface.s_addr = htonl (INADDR_ANY);
+		if (setsockopt (RxFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+			goto out;
+	}
+
+	Summary.worst_rtt = -1;
+	if (pthread_create (&Thread, NULL, fleet_thread, NULL))
+		goto out;
+	info ("fleet collector : %s:%d\n", inet_ntoa (sa.sin_addr), ntohs (sa.sin_port));
+	return true;
+out:
+	err ("fleet collector : %s (%s)\n", addr, strerror (errno));
+	close (RxFd);
+	RxFd = -1;
+	return false;
+}
+
+//------------------------------------------------------------------------------
+int fleet_summary (fleet_summary_t *s)
+{
+	if (RxFd < 0)
+		return false;
+	pthread_mutex_lock (&Lock);
+	*s = Summary;
+	pthread_mutex_unlock (&Lock);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Fleet beacon / collector. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __FLEET_H__
+#define __FLEET_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	beacon : every node sends its interface table and probe result as one
+	UDP datagram (fleet_beacon_t, network byte order) to a multicast group.
+	seq counts from 0 in a random epoch of the sender start, a new epoch
+	restarts the seq order. (no rtc : the clock may go back over a reboot)
+	collector : recvmmsg batches into an open addressing table (linear probe,
+	fixed records, key : node id). The sweep counts the stale nodes down,
+	removes the expired ones (backward shift, no tombstone) and makes the
+	summary for the lcd, at most once a second after beacons and at the
+	next stale / expire / change deadline. No node : the thread sleeps
+	in poll until a beacon.
+*/
+//------------------------------------------------------------------------------
+#define	FLEET_GROUP			"239.255.77.77"
+#define	FLEET_PORT			7777
+#define	FLEET_MAGIC			0x4E494232	// "NIB2"
+#define	FLEET_IF_MAX		4
+#define	FLEET_HOST_MAX		16
+
+#define	FLEET_TABLE_BITS	14			// 16384 records
+#define	FLEET_TABLE_SIZE	(1 << FLEET_TABLE_BITS)
+#define	FLEET_NODE_MAX		(FLEET_TABLE_SIZE * 3 / 4)
+#define	FLEET_BATCH			64			// datagrams per recvmmsg
+#define	FLEET_RCVBUF		(1024 * 1024)
+#define	FLEET_STALE_SEC		15			// no beacon : down
+#define	FLEET_EXPIRE_SEC	300			// no beacon : removed
+#define	FLEET_CHANGE_SEC	60			// summary changed count
+
+//------------------------------------------------------------------------------
+typedef struct fleet_if__t {
+	char		name[8];
+	uint_t		ip;					// network order
+	uint16_t	speed;				// Mb/s
+	byte_t		duplex;				// 0 half, 1 full, 0xff unknown
+	byte_t		up;					// IFF_RUNNING
+}	__attribute__((packed)) fleet_if_t;
+
+typedef struct fleet_beacon__t {
+	uint_t		magic;
+	uint_t		seq;				// older / repeated : dropped
+	uint_t		epoch;				// random per sender start (seq reset)
+	byte_t		id[6];				// mac of the first interface
+	byte_t		alive;				// probe result
+	byte_t		ifcount;
+	int			rtt;				// usec, -1 : no reply
+	char		host[FLEET_HOST_MAX];
+	fleet_if_t	ifs[FLEET_IF_MAX];	// ifcount sent
+}	__attribute__((packed)) fleet_beacon_t;
+
+typedef struct fleet_summary__t {
+	int			nodes, up, down;
+	int			changed;			// up <-> down in FLEET_CHANGE_SEC
+	int			worst_rtt;			// usec, -1 : none
+	char		worst[FLEET_HOST_MAX];
+	ulong_t		beacons, dropped;
+}	fleet_summary_t;
+
+//------------------------------------------------------------------------------
+extern int	fleet_beacon_open		(const char *addr);
+extern int	fleet_beacon_send		(int alive, int rtt);
+extern int	fleet_collector_start	(const char *addr);
+extern int	fleet_summary			(fleet_summary_t *s);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __FLEET_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
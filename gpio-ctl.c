@@ -0,0 +1,255 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 GPIO character device Control Lib. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+#include <linux/gpio.h>
+
+#include "typedefs.h"
+#include "gpio-ctl.h"
+
+//------------------------------------------------------------------------------
+static	int		MockFd = -1, MockEvFd = -1;
+static	ulong_t	MockValue, MockOps;
+static	ulong_t	MockTrace[GPIO_MOCK_TRACE];
+
+//------------------------------------------------------------------------------
+static	int		chip_lookup		(const char *path, const char **names, int n,
+									__u32 *offsets);
+static	int		chip_request	(const char *path, const __u32 *offsets, int n, bool input);
+static	int		line_open		(const char *chip, const char **names, int n, bool input);
+		int		gpio_open		(const char *chip, const char **names, int n);
+		int		gpio_open_events(const char *chip, const char **names, int n);
+		int		gpio_read_events(int fd);
+		int		gpio_set		(int fd, ulong_t bits, ulong_t mask);
+		void	gpio_close		(int fd);
+		int		gpio_mock_trace	(ulong_t *trace, int max);
+		ulong_t	gpio_mock_ops	(void);
+		void	gpio_mock_press	(void);
+
+//------------------------------------------------------------------------------
+// line offsets of the names on this chip. return 1 if all names found.
+//------------------------------------------------------------------------------
+static int chip_lookup (const char *path, const char **names, int n, __u32 *offsets)
+{
+	struct gpiochip_info chip;
+	struct gpio_v2_line_info info;
+	int fd, i, found = 0;
+	__u32 line;
+
+	if ((fd = open (path, O_RDONLY)) < 0)
+		return 0;
+
+	if (ioctl (fd, GPIO_GET_CHIPINFO_IOCTL, &chip) < 0) {
+		close (fd);
+		return 0;
+	}
+	for (line = 0; (line < chip.lines) && (found < n); line++) {
+		memset (&info, 0, sizeof(info));
+		info.offset = line;
+		if (ioctl (fd, GPIO_V2_GET_LINEINFO_IOCTL, &info) < 0)
+			continue;
+		for (i = 0; i < n; i++) {
+			if (!strncmp (info.name, names[i], sizeof(info.name))) {
+				offsets[i] = line;
+				found++;
+				break;
+			}
+		}
+	}
+	close (fd);
+	return found == n;
+}
+
+//------------------------------------------------------------------------------
+// output line request (initial value low), or input with pull-up and falling
+// edge events. return line request fd or -1.
+//------------------------------------------------------------------------------
+static int chip_request (const char *path, const __u32 *offsets, int n, bool input)
+{
+	struct gpio_v2_line_request req;
+	int fd, ret;
+
+	if ((fd = open (path, O_RDONLY)) < 0)
+		return -1;
+
+	memset (&req, 0, sizeof(req));
+	memcpy (req.offsets, offsets, sizeof(__u32) * n);
+	strncpy (req.consumer, GPIO_CONSUMER, sizeof(req.consumer) - 1);
+	req.num_lines                      = n;
+	if (input) {
+		req.config.flags               = GPIO_V2_LINE_FLAG_INPUT |
+										 GPIO_V2_LINE_FLAG_BIAS_PULL_UP |
+										 GPIO_V2_LINE_FLAG_EDGE_FALLING;
+	} else {
+		req.config.flags               = GPIO_V2_LINE_FLAG_OUTPUT;
+		req.config.num_attrs           = 1;
+		req.config.attrs[0].attr.id    = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+		req.config.attrs[0].attr.values= 0;
+		req.config.attrs[0].mask       = (1ULL << n) - 1;
+	}
+
+	ret = ioctl (fd, GPIO_V2_GET_LINE_IOCTL, &req);
+	close (fd);
+	if (ret < 0) {
+		err ("%s : line request fail! (%s)\n", path, strerror(errno));
+		return -1;
+	}
+	return req.fd;
+}
+
+//------------------------------------------------------------------------------
+static int line_open (const char *chip, const char **names, int n, bool input)
+{
+	__u32 offsets[GPIO_LINE_MAX];
+	char path[300];
+	struct dirent *de;
+	DIR *dir;
+	int fd = -1;
+
+	if ((n < 1) || (n > GPIO_LINE_MAX))
+		return false;
+
+	// mock : one output and one input request. (input : never readable)
+	if (chip && !strcmp (chip, GPIO_MOCK_CHIP)) {
+		if (input) {
+			if (MockEvFd < 0)
+				MockEvFd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+			return MockEvFd > 0 ? MockEvFd : false;
+		}
+		if (MockFd < 0)
+			MockFd = open ("/dev/null", O_RDONLY | O_CLOEXEC);
+		MockValue = 0;	MockOps = 0;
+		return MockFd > 0 ? MockFd : false;
+	}
+
+	if (chip) {
+		if (chip_lookup (chip, names, n, offsets))
+			fd = chip_request (chip, offsets, n, input);
+	} else if ((dir = opendir (GPIO_DEV_DIR)) != NULL) {
+		while ((fd < 0) && ((de = readdir (dir)) != NULL)) {
+			if (strncmp (de->d_name, "gpiochip", 8))
+				continue;
+			snprintf (path, sizeof(path), "%s/%s", GPIO_DEV_DIR, de->d_name);
+			if (chip_lookup (path, names, n, offsets))
+				fd = chip_request (path, offsets, n, input);
+		}
+		closedir (dir);
+	}
+	if (fd < 0) {
+		err ("gpio lines not found. (%s ...)\n", names[0]);
+		return false;
+	}
+	return fd ? fd : false;
+}
+
+//------------------------------------------------------------------------------
+// return line request fd or false.
+//------------------------------------------------------------------------------
+int gpio_open (const char *chip, const char **names, int n)
+{
+	return line_open (chip, names, n, false);
+}
+
+//------------------------------------------------------------------------------
+// input lines (buttons), the fd is readable on a falling edge. (poll)
+//------------------------------------------------------------------------------
+int gpio_open_events (const char *chip, const char **names, int n)
+{
+	int fd = line_open (chip, names, n, true);
+
+	if (fd != false)
+		fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
+	return fd;
+}
+
+//------------------------------------------------------------------------------
+// drain the edge events. return the number of events.
+//------------------------------------------------------------------------------
+int gpio_read_events (int fd)
+{
+	struct gpio_v2_line_event ev[16];
+	uint64_t presses;
+	int len, n = 0;
+
+	if (fd == MockEvFd)
+		return read (fd, &presses, sizeof(presses)) == sizeof(presses) ? (int)presses : 0;
+	while ((len = read (fd, ev, sizeof(ev))) > 0)
+		n += len / sizeof(ev[0]);
+	return n;
+}
+
+//------------------------------------------------------------------------------
+// set the masked lines at once.
+//------------------------------------------------------------------------------
+int gpio_set (int fd, ulong_t bits, ulong_t mask)
+{
+	struct gpio_v2_line_values v;
+
+	if (fd == MockFd) {
+		MockValue = (MockValue & ~mask) | (bits & mask);
+		MockTrace[MockOps++ % GPIO_MOCK_TRACE] = MockValue;
+		return true;
+	}
+	v.bits = bits;
+	v.mask = mask;
+	return ioctl (fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &v) < 0 ? false : true;
+}
+
+//------------------------------------------------------------------------------
+void gpio_close (int fd)
+{
+	if (fd == MockFd)
+		MockFd = -1;
+	if (fd == MockEvFd)
+		MockEvFd = -1;
+	if (fd > 0)
+		close (fd);
+}
+
+//------------------------------------------------------------------------------
+// mock chip : copy the last written values (oldest first). return count.
+//------------------------------------------------------------------------------
+int gpio_mock_trace (ulong_t *trace, int max)
+{
+	ulong_t i, start;
+	int n = 0;
+
+	start = MockOps > GPIO_MOCK_TRACE ? MockOps - GPIO_MOCK_TRACE : 0;
+	if (MockOps - start > (ulong_t)max)
+		start = MockOps - max;
+	for (i = start; i < MockOps; i++)
+		trace[n++] = MockTrace[i % GPIO_MOCK_TRACE];
+	return n;
+}
+
+//------------------------------------------------------------------------------
+ulong_t gpio_mock_ops (void)
+{
+	return MockOps;
+}
+
+//------------------------------------------------------------------------------
+// mock chip : a falling edge on the input lines.
+//------------------------------------------------------------------------------
+void gpio_mock_press (void)
+{
+	uint64_t one = 1;
+
+	if ((MockEvFd > 0) && (write (MockEvFd, &one, sizeof(one)) < 0))
+		err ("%s : %s\n", __func__, strerror (errno));
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
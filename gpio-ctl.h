@@ -0,0 +1,46 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 GPIO character device Control Lib. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __GPIO_CTL_H__
+#define __GPIO_CTL_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	Output lines are requested by line name (gpio-line-names) with one
+	GPIO v2 line request, so all lines of the request are written by one
+	GPIO_V2_LINE_SET_VALUES ioctl. (bit n = names[n])
+
+	chip : "/dev/gpiochipN", NULL (search all chips) or GPIO_MOCK_CHIP.
+	The mock chip keeps the written values in a trace buffer instead of
+	driving hardware. Its input lines are an eventfd : no event until
+	gpio_mock_press.
+
+	gpio_open_events requests input lines (pull-up, falling edge), the fd
+	polls readable on a button press.
+*/
+//------------------------------------------------------------------------------
+#define	GPIO_DEV_DIR		"/dev"
+#define	GPIO_LINE_MAX		8
+#define	GPIO_CONSUMER		"netinfo_display"
+
+#define	GPIO_MOCK_CHIP		"mock"
+#define	GPIO_MOCK_TRACE		4096
+
+//------------------------------------------------------------------------------
+extern int		gpio_open		(const char *chip, const char **names, int n);
+extern int		gpio_set		(int fd, ulong_t bits, ulong_t mask);
+extern int		gpio_open_events(const char *chip, const char **names, int n);
+extern int		gpio_read_events(int fd);
+extern void		gpio_close		(int fd);
+extern int		gpio_mock_trace	(ulong_t *trace, int max);
+extern ulong_t	gpio_mock_ops	(void);
+extern void		gpio_mock_press	(void);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __GPIO_CTL_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,242 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 System health sampler. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/statvfs.h>
+
+#include "typedefs.h"
+#include "health.h"
+
+//------------------------------------------------------------------------------
+// EWMA accumulator. (value * 256)
+typedef struct ewma__t {
+	bool	valid;
+	long	q8;
+}	ewma_t;
+
+//------------------------------------------------------------------------------
+static	int		ThermalFd[HEALTH_THERMAL_MAX], ThermalCount;
+static	int		StatFd = -1, MemFd = -1;
+static	char	Buf[HEALTH_BUF_SIZE];
+static	ulong_t	CpuBusy, CpuTotal;
+static	bool	CpuValid;
+static	ewma_t	Temp, Cpu, Mem, Disk;
+static	ulong_t	Samples;
+
+//------------------------------------------------------------------------------
+static	void		ewma_add		(ewma_t *e, long v);
+static	const char	*parse_ulong	(const char *p, ulong_t *v);
+static	int			read_buf		(int fd);
+static	long		sample_temp		(void);
+static	int			sample_cpu		(void);
+static	int			sample_mem		(void);
+static	int			sample_disk		(void);
+		int			health_open		(void);
+		void		health_close	(void);
+		void		health_sample	(void);
+		void		health_get		(health_t *h);
+
+//------------------------------------------------------------------------------
+static void ewma_add (ewma_t *e, long v)
+{
+	if (!e->valid) {
+		e->q8    = v * 256;
+		e->valid = true;
+		return;
+	}
+	e->q8 += (v * 256 - e->q8) / (1 << HEALTH_EWMA_SHIFT);
+}
+
+//------------------------------------------------------------------------------
+// skip blanks, decimal digits. (wraps at ulong_t, jiffy deltas stay right)
+//------------------------------------------------------------------------------
+static const char *parse_ulong (const char *p, ulong_t *v)
+{
+	*v = 0;
+	while ((*p == ' ') || (*p == '\t'))
+		p++;
+	while ((*p >= '0') && (*p <= '9'))
+		*v = *v * 10 + (*p++ - '0');
+	return p;
+}
+
+//------------------------------------------------------------------------------
+// whole file from offset 0, zero terminated. (return length)
+//------------------------------------------------------------------------------
+static int read_buf (int fd)
+{
+	int len;
+
+	if ((fd < 0) || ((len = pread (fd, Buf, sizeof(Buf) -1, 0)) <= 0))
+		return 0;
+	Buf[len] = 0;
+	return len;
+}
+
+//------------------------------------------------------------------------------
+// hottest zone, milli degree C.
+//------------------------------------------------------------------------------
+static long sample_temp (void)
+{
+	long t, max = HEALTH_NO_TEMP;
+	ulong_t v;
+	int i;
+
+	for (i = 0; i < ThermalCount; i++) {
+		if (!read_buf (ThermalFd[i]))
+			continue;
+		parse_ulong (Buf[0] == '-' ? &Buf[1] : Buf, &v);
+		t = Buf[0] == '-' ? -(long)v : (long)v;
+		max = t > max ? t : max;
+	}
+	return max;
+}
+
+//------------------------------------------------------------------------------
+// "cpu  user nice system idle iowait irq softirq steal ..." (-1 : first sample)
+//------------------------------------------------------------------------------
+static int sample_cpu (void)
+{
+	const char *p;
+	ulong_t v, busy = 0, total = 0, d_busy, d_total;
+	bool valid = CpuValid;
+	int i;
+
+	if (!read_buf (StatFd) || strncmp (Buf, "cpu ", 4))
+		return -1;
+	for (p = Buf + 4, i = 0; (i < 8) && (*p != '\n'); i++) {
+		p = parse_ulong (p, &v);
+		total += v;
+		// idle, iowait
+		if ((i != 3) && (i != 4))
+			busy += v;
+	}
+	d_busy    = busy  - CpuBusy;
+	d_total   = total - CpuTotal;
+	CpuBusy   = busy;
+	CpuTotal  = total;
+	CpuValid  = true;
+	if (!valid || !d_total)
+		return -1;
+	return (int)((unsigned long long)d_busy * 100 / d_total);
+}
+
+//------------------------------------------------------------------------------
+// MemTotal, MemAvailable. (the first lines of meminfo)
+//------------------------------------------------------------------------------
+static int sample_mem (void)
+{
+	const char *p;
+	ulong_t total = 0, avail = 0;
+
+	if (!read_buf (MemFd))
+		return -1;
+	for (p = Buf; *p; p++) {
+		if (!strncmp (p, "MemTotal:", 9))
+			p = parse_ulong (p + 9, &total);
+		else if (!strncmp (p, "MemAvailable:", 13)) {
+			parse_ulong (p + 13, &avail);
+			break;
+		}
+		while (*p && (*p != '\n'))
+			p++;
+		if (!*p)
+			break;
+	}
+	if (!total || (avail > total))
+		return -1;
+	return (int)((unsigned long long)(total - avail) * 100 / total);
+}
+
+//------------------------------------------------------------------------------
+// used share of the blocks (root reserve counted as used, same as df).
+//------------------------------------------------------------------------------
+static int sample_disk (void)
+{
+	struct statvfs st;
+	unsigned long long used, size;
+
+	if (statvfs ("/", &st) || !st.f_blocks)
+		return -1;
+	used = st.f_blocks - st.f_bfree;
+	size = used + st.f_bavail;
+	return size ? (int)(used * 100 / size) : -1;
+}
+
+//------------------------------------------------------------------------------
+int health_open (void)
+{
+	char path[64];
+	int i, fd;
+
+	health_close ();
+	for (i = 0; ThermalCount < HEALTH_THERMAL_MAX && i < 16; i++) {
+		snprintf (path, sizeof(path), "/sys/class/thermal/thermal_zone%d/temp", i);
+		if ((fd = open (path, O_RDONLY | O_CLOEXEC)) >= 0)
+			ThermalFd[ThermalCount++] = fd;
+	}
+	StatFd = open ("/proc/stat",    O_RDONLY | O_CLOEXEC);
+	MemFd  = open ("/proc/meminfo", O_RDONLY | O_CLOEXEC);
+	if ((StatFd < 0) || (MemFd < 0))
+		err ("procfs open fail!\n");
+
+	info ("health : %d thermal zones\n", ThermalCount);
+	return (StatFd >= 0) || (MemFd >= 0) || ThermalCount;
+}
+
+//------------------------------------------------------------------------------
+void health_close (void)
+{
+	int i;
+
+	for (i = 0; i < ThermalCount; i++)
+		close (ThermalFd[i]);
+	if (StatFd >= 0)	close (StatFd);
+	if (MemFd  >= 0)	close (MemFd);
+	StatFd = MemFd = -1;
+	ThermalCount = 0;
+	CpuValid = false;
+	Samples  = 0;
+	memset (&Temp, 0, sizeof(ewma_t));	memset (&Cpu,  0, sizeof(ewma_t));
+	memset (&Mem,  0, sizeof(ewma_t));	memset (&Disk, 0, sizeof(ewma_t));
+}
+
+//------------------------------------------------------------------------------
+void health_sample (void)
+{
+	long t;
+	int v;
+
+	if ((t = sample_temp ()) != HEALTH_NO_TEMP)	ewma_add (&Temp, t);
+	if ((v = sample_cpu  ()) >= 0)				ewma_add (&Cpu,  v);
+	// slow sources : not in the same sample. (meminfo costs as much as stat)
+	if ((!Mem.valid || ((Samples % HEALTH_MEM_EVERY) == 1)) &&
+		((v = sample_mem ()) >= 0))
+		ewma_add (&Mem, v);
+	if ((!Disk.valid || ((Samples % HEALTH_DISK_EVERY) == 2)) &&
+		((v = sample_disk ()) >= 0))
+		ewma_add (&Disk, v);
+	Samples++;
+}
+
+//------------------------------------------------------------------------------
+// rounded averages, -1 : no sample yet.
+//------------------------------------------------------------------------------
+void health_get (health_t *h)
+{
+	h->temp    = Temp.valid ? (Temp.q8 + 128) >> 8 : HEALTH_NO_TEMP;
+	h->cpu     = Cpu.valid  ? (int)((Cpu.q8  + 128) >> 8) : -1;
+	h->mem     = Mem.valid  ? (int)((Mem.q8  + 128) >> 8) : -1;
+	h->disk    = Disk.valid ? (int)((Disk.q8 + 128) >> 8) : -1;
+	h->samples = Samples;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,51 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 System health sampler. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __HEALTH_H__
+#define __HEALTH_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	The source files are opened once (health_open) and read again with pread
+	at offset 0 into fixed buffers, parsed in place. (no allocation)
+		/sys/class/thermal/thermal_zone*\/temp : hottest zone
+		/proc/stat    : cpu line, busy share of the jiffies since the last sample
+		/proc/meminfo : MemTotal - MemAvailable
+		statvfs ("/") : used blocks
+	Temperature and cpu are read every sample, memory and disk only every
+	HEALTH_MEM_EVERY / HEALTH_DISK_EVERY samples, on different ticks.
+	(/proc/stat and meminfo cost about the same, 4us each on x86)
+	Every sample goes through an EWMA (1 / 2^HEALTH_EWMA_SHIFT).
+*/
+//------------------------------------------------------------------------------
+#define	HEALTH_THERMAL_MAX	4			// thermal zones
+#define	HEALTH_SAMPLE_MS	250			// health page sample interval
+#define	HEALTH_EWMA_SHIFT	2			// new sample weight 1/4
+#define	HEALTH_MEM_EVERY	4			// samples, meminfo
+#define	HEALTH_DISK_EVERY	16			// samples, statvfs
+#define	HEALTH_NO_TEMP		(-300000)	// no thermal zone
+#define	HEALTH_BUF_SIZE		2048		// /proc/meminfo head
+
+//------------------------------------------------------------------------------
+typedef struct health__t {
+	long		temp;				// milli degree C
+	int			cpu;				// percent, busy
+	int			mem;				// percent, used
+	int			disk;				// percent, root filesystem used
+	ulong_t		samples;
+}	health_t;
+
+//------------------------------------------------------------------------------
+extern int	health_open		(void);
+extern void	health_close	(void);
+extern void	health_sample	(void);
+extern void	health_get		(health_t *h);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __HEALTH_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
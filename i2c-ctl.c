@@ -22,26 +22,202 @@
 #include <sys/mman.h>
 #include <linux/fb.h>
 #include <getopt.h>
+#include <pthread.h>
 
 #include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include "typedefs.h"
+#include "i2c-ctl.h"
+#include "i2c-sched.h"
+
+//------------------------------------------------------------------------------
+// transaction capture
+//------------------------------------------------------------------------------
+static int				TraceFd = -1;
+static __u8				TraceBuf[I2C_TRACE_BUF];
+static int				TraceLen;
+static struct timespec	TraceLast;
+static pthread_mutex_t	TraceLock = PTHREAD_MUTEX_INITIALIZER;
+
+// slave address of the file | 0x80, 0 : not set.
+static __u8				FileAddr[I2C_FILE_MAX];
+// scheduler client of the file + 1, 0 : not scheduled.
+static __u8				FileClient[I2C_FILE_MAX];
+
+//------------------------------------------------------------------------------
+static ulong_t trace_usec (const struct timespec *a, const struct timespec *b)
+{
+	long long d = (b->tv_sec - a->tv_sec) * 1000000LL + (b->tv_nsec - a->tv_nsec) / 1000;
+
+	return d < 0 ? 0 : d > 0xFFFFFFFFLL ? 0xFFFFFFFFUL : (ulong_t)d;
+}
+
+//------------------------------------------------------------------------------
+static void trace_flush (void)
+{
+	if (TraceLen && (write (TraceFd, TraceBuf, TraceLen) != TraceLen))
+		err ("i2c trace write fail!\n");
+	TraceLen = 0;
+}
+
+//------------------------------------------------------------------------------
+// data bytes of the transaction. (write : sent, read : received)
+//------------------------------------------------------------------------------
+static int smbus_data (char read_write, int size, const union i2c_smbus_data *data,
+						__s32 ret, const __u8 **p)
+{
+	*p = NULL;
+	if (!data || ((read_write == I2C_SMBUS_READ) && (ret < 0)))
+		return 0;
+	switch (size) {
+		case	I2C_SMBUS_BYTE:
+		case	I2C_SMBUS_BYTE_DATA:
+			*p = &data->byte;
+			return 1;
+		case	I2C_SMBUS_WORD_DATA:
+		case	I2C_SMBUS_PROC_CALL:
+			*p = (const __u8 *)&data->word;
+			return 2;
+		case	I2C_SMBUS_BLOCK_DATA:
+		case	I2C_SMBUS_I2C_BLOCK_BROKEN:
+		case	I2C_SMBUS_I2C_BLOCK_DATA:
+		case	I2C_SMBUS_BLOCK_PROC_CALL:
+			*p = &data->block[1];
+			return data->block[0] > I2C_SMBUS_BLOCK_MAX ? I2C_SMBUS_BLOCK_MAX : data->block[0];
+		default :
+			return 0;
+	}
+}
+
+//------------------------------------------------------------------------------
+static void trace_record (const struct timespec *t0, const struct timespec *t1,
+							int file, char read_write, __u8 command, int size,
+							const union i2c_smbus_data *data, __s32 ret)
+{
+	i2c_trace_rec_t r;
+	const __u8 *p;
+	ulong_t dur;
+	int len, e = errno;
+
+	len = smbus_data (read_write, size, data, ret, &p);
+
+	pthread_mutex_lock (&TraceLock);
+	if (TraceFd >= 0) {
+		dur       = trace_usec (t0, t1);
+		r.dt_us   = trace_usec (&TraceLast, t0);
+		r.dur_us  = dur > 0xFFFF ? 0xFFFF : dur;
+		r.rw      = read_write;
+		r.size    = size;
+		r.command = command;
+		r.len     = len;
+		r.status  = ret < 0 ? (ret < -128 ? -128 : ret) : 0;
+		r.addr    = ((file >= 0) && (file < I2C_FILE_MAX) && FileAddr[file]) ?
+						FileAddr[file] & 0x7F : I2C_TRACE_NO_ADDR;
+		TraceLast = *t0;
+
+		if (TraceLen + (int)sizeof(r) + len > I2C_TRACE_BUF)
+			trace_flush ();
+		memcpy (&TraceBuf[TraceLen], &r, sizeof(r));	TraceLen += sizeof(r);
+		if (len)
+			memcpy (&TraceBuf[TraceLen], p, len);
+		TraceLen += len;
+	}
+	pthread_mutex_unlock (&TraceLock);
+	errno = e;
+}
+
+//------------------------------------------------------------------------------
+int i2c_capture_start (const char *path)
+{
+	i2c_trace_hdr_t h;
+	struct timespec now;
+
+	if (TraceFd >= 0)
+		return true;
+	if ((TraceFd = open (path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) < 0) {
+		err ("%s : trace open fail! (%s)\n", path, strerror (errno));
+		return false;
+	}
+	clock_gettime (CLOCK_REALTIME, &now);
+	h.magic    = I2C_TRACE_MAGIC;
+	h.version  = I2C_TRACE_VERSION;
+	h.rec_size = sizeof(i2c_trace_rec_t);
+	h.sec      = now.tv_sec;
+	h.usec     = now.tv_nsec / 1000;
+	if (write (TraceFd, &h, sizeof(h)) != sizeof(h)) {
+		close (TraceFd);
+		TraceFd = -1;
+		return false;
+	}
+	clock_gettime (CLOCK_MONOTONIC, &TraceLast);
+	// buffered records at exit.
+	atexit (i2c_capture_stop);
+	info ("i2c capture : %s\n", path);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+void i2c_capture_stop (void)
+{
+	pthread_mutex_lock (&TraceLock);
+	if (TraceFd >= 0) {
+		trace_flush ();
+		close (TraceFd);
+		TraceFd = -1;
+	}
+	pthread_mutex_unlock (&TraceLock);
+}
+
+//------------------------------------------------------------------------------
+// I2C_SLAVE of the file, the address is kept for the trace records.
+//------------------------------------------------------------------------------
+int i2c_set_slave (int file, int addr)
+{
+	if (ioctl (file, I2C_SLAVE, addr) < 0)
+		return -1;
+	if ((file >= 0) && (file < I2C_FILE_MAX)) {
+		FileAddr[file]   = 0x80 | (addr & 0x7F);
+		FileClient[file] = 0;
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// bus scheduler client of the file. (-1 : not scheduled)
+//------------------------------------------------------------------------------
+void i2c_set_client (int file, int client)
+{
+	if ((file >= 0) && (file < I2C_FILE_MAX))
+		FileClient[file] = ((client >= 0) && (client < 0xFF)) ? client + 1 : 0;
+}
 
 //------------------------------------------------------------------------------
 __s32 i2c_smbus_access(int file, char read_write, __u8 command,
 		       int size, union i2c_smbus_data *data)
 {
 	struct i2c_smbus_ioctl_data args;
+	struct timespec t0, t1;
+	const __u8 *p;
 	__s32 err;
+	int client = ((file >= 0) && (file < I2C_FILE_MAX)) ? FileClient[file] - 1 : -1;
 
 	args.read_write = read_write;
 	args.command = command;
 	args.size = size;
 	args.data = data;
 
+	// the bus for this transaction, in the priority of the client.
+	i2c_sched_acquire (client);
+	if (TraceFd >= 0)
+		clock_gettime (CLOCK_MONOTONIC, &t0);
 	err = ioctl(file, I2C_SMBUS, &args);
 	if (err == -1)
 		err = -errno;
+	i2c_sched_release (client, smbus_data (read_write, size, data, err, &p));
+	if (TraceFd >= 0) {
+		clock_gettime (CLOCK_MONOTONIC, &t1);
+		trace_record (&t0, &t1, file, read_write, command, size, data, err);
+	}
 	return err;
 }
 
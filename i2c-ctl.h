@@ -11,6 +11,51 @@
 #include <linux/i2c-dev.h>
 
 //------------------------------------------------------------------------------
+/*
+	Transaction capture : i2c_capture_start (path) writes every
+	i2c_smbus_access of the process to a binary trace. (i2c-trace.c report)
+		i2c_trace_hdr_t, then per transaction i2c_trace_rec_t + len bytes
+		(write data / read result, block : without the count byte).
+	Records are buffered, written every I2C_TRACE_BUF bytes and at exit.
+	The slave address of a record is the one set by i2c_set_slave on the
+	file (fds below I2C_FILE_MAX), I2C_TRACE_NO_ADDR if not known.
+
+	Bus scheduling : i2c_set_client binds an i2c_sched_client id to the
+	file (after i2c_set_slave, which clears it), every transaction of the
+	file acquires the bus with the priority of the client. (i2c-sched.h)
+	e.g. a sensor : i2c_set_client (fd, i2c_sched_client (dev, "aht20",
+	I2C_PRIO_LATENCY))
+*/
+//------------------------------------------------------------------------------
+#define	I2C_TRACE_MAGIC		0x54433249	// "I2CT"
+#define	I2C_TRACE_VERSION	2
+#define	I2C_TRACE_BUF		4096
+#define	I2C_TRACE_NO_ADDR	0xFF
+#define	I2C_FILE_MAX		256			// fds with a known slave address
+
+typedef struct i2c_trace_hdr__t {
+	__u32	magic;
+	__u16	version;
+	__u16	rec_size;					// sizeof(i2c_trace_rec_t)
+	__u32	sec, usec;					// capture start, wall clock
+}	__attribute__((packed)) i2c_trace_hdr_t;
+
+typedef struct i2c_trace_rec__t {
+	__u32	dt_us;						// since the last record start (saturated)
+	__u16	dur_us;						// ioctl time (saturated)
+	__u8	rw;							// I2C_SMBUS_READ / WRITE
+	__u8	size;						// I2C_SMBUS_BYTE ...
+	__u8	command;
+	__u8	len;						// data bytes following
+	__s8	status;						// 0 or -errno
+	__u8	addr;						// 7 bit slave address
+}	__attribute__((packed)) i2c_trace_rec_t;
+
+//------------------------------------------------------------------------------
+extern int   i2c_capture_start          (const char *path);
+extern void  i2c_capture_stop           (void);
+extern int   i2c_set_slave              (int file, int addr);
+extern void  i2c_set_client             (int file, int client);
 extern __s32 i2c_smbus_access           (int file, char read_write, __u8 command,
 		                                    int size, union i2c_smbus_data *data);
 extern __s32 i2c_smbus_write_quick      (int file, __u8 value);
@@ -6,6 +6,7 @@
 //------------------------------------------------------------------------------
 #include <stdio.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
@@ -16,15 +17,19 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <dirent.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <linux/fb.h>
 #include <getopt.h>
+#include <pthread.h>
 
 #include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include "i2c-lcd.h"
 #include "i2c-ctl.h"
+#include "gpio-ctl.h"
+#include "i2c-sched.h"
 #include "typedefs.h"
 //------------------------------------------------------------------------------
 /* ----------------------------------------------------------------------- *
@@ -58,24 +63,146 @@
 	|54|55|56|57|58|59|5A|5B|5C|5D|5E|5F|60|61|62|63|64|65|66|67| <----+
 */
 //------------------------------------------------------------------------------
-static 	int		i2c_send        (int fd, bool d_type, bool bl,
+/*
+	Bus : I2C(PCF8574) or GPIO(16x2 IO Shield) writes the same PCF8574 byte
+	sequence. (two bytes per nibble, EN high / EN low)
+	Shadow : what is on the glass now. lcd_printf / lcd_clear(line) send only
+	the changed characters. (0 = unknown)
+	Screen : what the application wrote. View : Screen with the display
+	server overlay (lcd_overlay) on top, what should be on the glass.
+	lcd_verify reads DDRAM back (PCF8574 RW=1, i2c only) and repairs the
+	cells that differ from View.
+	Snapshot : View is kept in LCD_SNAPSHOT, lcd_init_warm adopts it on
+	restart when the controller still answers in 4-bit mode. (dirty mark :
+	stopped during a bus write, DDRAM is read back and repaired)
+	Pacing : a send sets the time the controller is done (ReadyAt), the
+	next bus access sleeps only what is left after the bytes it puts on
+	the wire first. (measured byte cost) A slow bus covers the execution
+	time by itself, a fast one sleeps the difference.
+	Budget : lcd bus time is summed per window, lcd_budget tells the
+	deferrable work whether its measured cost fits the share. Foreground
+	writes (lcd_write, lcd_clear) cut a running overlay frame between rows,
+	the display server sends the rest with its next frame.
+*/
+//------------------------------------------------------------------------------
+typedef struct lcd_bus__t {
+	int		(*write)(int fd, const byte_t *seq, int n);
+	// read n bytes (RS = d_type), NULL : no readback (RW tied low)
+	int		(*read)	(int fd, bool d_type, byte_t *buf, int n);
+	// usec after each send
+	int		delay;
+}	lcd_bus_t;
+
+typedef struct lcd_snapshot__t {
+	uint_t	magic;
+	byte_t	width, height;
+	byte_t	dispctl;
+	byte_t	bl;
+	// set before the bus write, cleared after it. (killed in between)
+	byte_t	dirty;
+	char	screen[LCD_ROW_MAX][LCD_COL_MAX];
+}	lcd_snapshot_t;
+
+#define	LCD_SNAPSHOT_MAGIC	0x4C434431	// "LCD1"
+
+//------------------------------------------------------------------------------
+static 	int		i2c_bus_write	(int fd, const byte_t *seq, int n);
+static 	int		gpio_bus_write	(int fd, const byte_t *seq, int n);
+static	int		i2c_bus_read	(int fd, bool d_type, byte_t *buf, int n);
+static 	int		lcd_send        (int fd, bool d_type, bool bl,
 									byte_t *sdata, int size, int udelay);
 static int 		i2c_write 		(int fd, bool d_type, bool bl,
 									byte_t *sdata, int size, int udelay);
+static	byte_t	lcd_addr		(int x, int y);
 static 	int		lcd_goto_xy		(int fd, int x, int y);
+static	int		lcd_update		(int fd, int x, int y, const char *s, int len);
+static	int		lcd_resync		(int fd);
+static	void	snapshot_save	(void);
+static	void	snapshot_done	(void);
+static	int		snapshot_load	(lcd_snapshot_t *snap);
+static	int		lcd_probe		(int fd);
+static	int		lcd_echo		(int fd, const char *pat, int n);
+static	int		cache_load		(char *dev, int size, byte_t *addr);
+static	void	cache_save		(const char *dev, byte_t addr);
+static	int		lcd_calibrate	(int fd);
+static	int		lcd_port_echo	(int fd);
+static	int		lcd_scan		(int bus, byte_t addr);
+static	int		lcd_buses		(int *bus, int max);
+static	ulong_t	lcd_msec		(void);
+static	int		lcd_fault		(int e);
+static	int		lcd_recover		(int fd);
+static	void	view_row		(int y);
+static	int		screen_write	(int fd, int x, int y, const char *buf, int len);
+static	int		screen_clear	(int fd, int line);
+static	int		disp_control	(int fd, bool bl, bool disp, bool cursor, bool blink);
+static	int		screen_verify	(int fd);
+static	unsigned long long	lcd_usec	(void);
+static	void	lcd_pace		(void);
+static	void	lcd_busy		(unsigned long long start, unsigned long long end);
+static	void	cost_add		(ulong_t *ns, ulong_t v);
+static	int		lcd_read		(int fd, bool d_type, byte_t *buf, int n);
 		int		lcd_printf      (int fd, int x, int y, char *fmt, ...);
+		int		lcd_write		(int fd, int x, int y, const char *buf, int len);
 		int  	lcd_clear       (int fd, int line);
 		int  	lcd_backlight   (int fd, bool onoff);
 		int  	lcd_disp_control(int fd, bool bl, bool disp, bool cursor, bool blink);
 		void 	lcd_close       (int fd);
 		int  	lcd_init        (int fd, int lcd_width, int lcd_height, bool lcd_bl);
 		int  	lcd_open 		(char *dev, byte_t id);
+		int		lcd_open_gpio	(const char *chip, const char **names);
+		int		lcd_verify		(int fd);
+		int		lcd_init_warm	(int fd, int lcd_width, int lcd_height, bool lcd_bl);
+		int		lcd_discover	(char *dev, int size, byte_t *addr, bool rescan);
+		void	lcd_fault_stats	(lcd_fault_stats_t *s);
+		int		lcd_overlay		(int fd, const char *cells, const byte_t *mask);
+		int		lcd_cost_us		(int cells);
+		int		lcd_verify_cost	(void);
+		int		lcd_budget		(int cost_us);
+		void	lcd_pace_stats	(lcd_pace_stats_t *s);
+		void	lcd_pace_report	(void);
 
 //------------------------------------------------------------------------------
 static int 	LCDWidth 	= DEFAULT_LCD_WIDTH;
 static int 	LCDHeight 	= DEFAULT_LCD_HEIGHT;
 static bool	LCDBL 		= DEFAULT_LCD_BL;
 
+static byte_t	LCDDispCtl	= 0x0C;
+
+static const lcd_bus_t	I2C_BUS  = { i2c_bus_write,  i2c_bus_read, DEFAULT_I2C_DELAY };
+static const lcd_bus_t	GPIO_BUS = { gpio_bus_write, NULL,         0 };
+static const lcd_bus_t	*LCDBus  = &I2C_BUS;
+
+static char	Shadow[LCD_ROW_MAX][LCD_COL_MAX];
+static char	Screen[LCD_ROW_MAX][LCD_COL_MAX];
+// View = Screen with the overlay cells (display server) on top, the glass.
+static char	View[LCD_ROW_MAX][LCD_COL_MAX];
+static char	Overlay[LCD_ROW_MAX][LCD_COL_MAX];
+static byte_t	OverMask[LCD_ROW_MAX][LCD_COL_MAX];
+// main loop / display server thread.
+static pthread_mutex_t	LCDLock = PTHREAD_MUTEX_INITIALIZER;
+static int	SnapFd = -1;
+static int	LCDClient = -1;		// i2c bus scheduler client
+
+// module timing (usec), LCD_CACHE calibration. (-1 : bus default delay)
+static int	LCDDelay      = -1;
+static int	LCDClearDelay = LCD_CLEAR_DELAY;
+
+// bus fault : no bus access until LCDRetryAt, then reopen / init / replay.
+static char		LCDDev[LCD_DEV_MAX];
+static byte_t	LCDAddr;
+static bool		LCDFault;
+static ulong_t	LCDRetryAt, LCDBackoff = LCD_RETRY_MIN_MS;
+static lcd_fault_stats_t	FaultStats;
+static ulong_t	GpioLines;
+
+// pacing / bus budget. (usec, monotonic)
+static unsigned long long	ReadyAt, WinStart, TPaceReport;
+static ulong_t	WinBusy, PrevBusy, VerifyUs;
+static ulong_t	ByteNs = LCD_BYTE_NS_MIN, OpNs = LCD_OP_NS_INIT;
+static lcd_pace_stats_t	PaceStats;
+// foreground writers waiting for LCDLock.
+static volatile int	Waiters;
+
 //------------------------------------------------------------------------------
 // i2c file write
 //------------------------------------------------------------------------------
@@ -113,20 +240,126 @@ static int i2c_write (int fd, bool d_type, bool bl,
 }
 
 //------------------------------------------------------------------------------
-// i2c smbus write
+// i2c smbus write (one bus slice per block, max 32 bytes)
+//------------------------------------------------------------------------------
+static int i2c_bus_write (int fd, const byte_t *seq, int n)
+{
+	int ret = 0, slice = i2c_sched_slice (LCDClient), retry, e = 0;
+
+	if (LCDFault)
+		return false;
+
+	while (n > 0) {
+		int chunk = n > slice ? slice : n;
+
+		// arbitration lost : the other master had the bus, send again.
+		for (retry = 0; retry < LCD_ARB_RETRY; retry++) {
+			unsigned long long t;
+
+			i2c_sched_acquire (LCDClient);
+			t   = lcd_usec ();
+			ret = i2c_smbus_write_block_data(fd, 0, chunk, seq);
+			e   = errno;
+			// wire bytes : address, command, count, data.
+			if (ret >= 0)
+				cost_add (&ByteNs, (lcd_usec () - t) * 1000 / (chunk + 3));
+			i2c_sched_release (LCDClient, chunk);
+			// retried loss counted here, the last one by lcd_fault.
+			if ((ret >= 0) || (e != EAGAIN) || (retry == LCD_ARB_RETRY - 1))
+				break;
+			FaultStats.arb_lost++;
+		}
+		if (ret < 0)
+			return lcd_fault (e);
+		seq += chunk;	n -= chunk;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// PCF8574 read : data lines high (input), RW = 1, one byte read per EN pulse.
+//------------------------------------------------------------------------------
+static int i2c_bus_read (int fd, bool d_type, byte_t *buf, int n)
+{
+	i2clcd_u ldata;
+	int i, nib, v, e = 0;
+
+	if (LCDFault)
+		return false;
+
+	ldata.bits.bl = LCDBL;	ldata.bits.rs = d_type;	ldata.bits.rw = 1;
+	ldata.bits.dat = 0x0F;
+	for (i = 0; i < n; i++) {
+		// one character (6 byte transactions) per bus slice.
+		i2c_sched_acquire (LCDClient);
+		for (nib = 0, buf[i] = 0, v = 0; (nib < 2) && (v >= 0); nib++) {
+			ldata.bits.e = 1;
+			if ((i2c_smbus_write_byte (fd, ldata.byte) < 0) ||
+				((v = i2c_smbus_read_byte (fd)) < 0))
+				break;
+			ldata.bits.e = 0;
+			if (i2c_smbus_write_byte (fd, ldata.byte) < 0)
+				v = -1;
+			buf[i] |= nib ? (v >> 4) & 0x0F : v & 0xF0;
+		}
+		e = errno;
+		i2c_sched_release (LCDClient, 6);
+		if (v < 0)
+			return lcd_fault (e);
+	}
+	// RW stays high with EN low, the next write sets RW = 0.
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// gpio line request write. one line set per PCF8574 byte.
+// (line bit : LCD_GPIO_RS, LCD_GPIO_E, LCD_GPIO_D4 ~ LCD_GPIO_D7)
+//------------------------------------------------------------------------------
+static int gpio_bus_write (int fd, const byte_t *seq, int n)
+{
+	i2clcd_u ldata;
+	ulong_t lines;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		ldata.byte = seq[i];
+		lines = (ldata.bits.rs << LCD_GPIO_RS) | (ldata.bits.e << LCD_GPIO_E) |
+				((ulong_t)ldata.bits.dat << LCD_GPIO_D4);
+
+		// RS setup time before EN rising edge.
+		if (ldata.bits.e && ((lines ^ GpioLines) & (1 << LCD_GPIO_RS))) {
+			if (!gpio_set (fd, lines & ~(1 << LCD_GPIO_E), LCD_GPIO_MASK))
+				return lcd_fault (errno);
+		}
+		if (!gpio_set (fd, lines, LCD_GPIO_MASK))
+			return lcd_fault (errno);
+		GpioLines = lines;
+
+		// EN falling edge of the low nibble : wait for the lcd execution.
+		if ((i & 3) == 3)
+			usleep (LCD_EXEC_DELAY);
+	}
+	return true;
+}
+
 //------------------------------------------------------------------------------
-static int i2c_send (int fd, bool d_type, bool bl,
+// PCF8574 byte sequence write. (size 0 : high nibble only, lcd startup)
+//------------------------------------------------------------------------------
+static int lcd_send (int fd, bool d_type, bool bl,
 							byte_t *sdata, int size, int udelay)
 {
 	i2clcd_u ldata;
-	int s_cnt, i, ret;
+	int s_cnt, i, ret = true, delay;
 	bool iflag = (size == 0) ? true : false;
 	byte_t sbuf[64];
+	unsigned long long t, now;
 
-	memset(sbuf, 0, sizeof(sbuf));
 	// startup command parsing
 	if (iflag)	size = 1;
 
+	t = lcd_usec ();
+	lcd_pace ();
+
 	ldata.bits.bl = bl;	ldata.bits.rs = d_type;	ldata.bits.rw = 0;
 	for (i = 0, s_cnt = 0; i < size; i++) {
 		ldata.bits.dat = (sdata[i] >> 4) & 0x0F;
@@ -138,21 +371,32 @@ static int i2c_send (int fd, bool d_type, bool bl,
 		ldata.bits.dat = (sdata[i]     ) & 0x0F;
 		ldata.bits.e   = 1;	sbuf[s_cnt++] = ldata.byte;
 		ldata.bits.e   = 0;	sbuf[s_cnt++] = ldata.byte;
-	}
-	if (s_cnt > 32) {
-		ret  = i2c_smbus_write_block_data(fd, 0,         32, &sbuf[0]);
-		ret += i2c_smbus_write_block_data(fd, 0, s_cnt - 32, &sbuf[32]);
-	}
-	else
-		ret = i2c_smbus_write_block_data(fd, 0, s_cnt -  0, &sbuf[0]);
 
-	usleep(udelay);		usleep(DEFAULT_I2C_DELAY);
+		if (s_cnt == sizeof(sbuf)) {
+			ret &= LCDBus->write (fd, sbuf, s_cnt);
+			s_cnt = 0;
+		}
+	}
+	if (s_cnt)
+		ret &= LCDBus->write (fd, sbuf, s_cnt);
+	now = lcd_usec ();
+	lcd_busy (t, now);
+	// bus fault : no execution wait.
+	if (!ret)
+		return false;
+	cost_add (&OpNs, (now - t) * 1000 / size);
 
-	return	ret ? false : true;
+	// the next bus access waits for it. (lcd_pace)
+	delay   = udelay + (LCDDelay >= 0 ? LCDDelay : LCDBus->delay);
+	ReadyAt = now + delay;
+	PaceStats.delay_us += delay;
+	return	ret;
 }
 
 //------------------------------------------------------------------------------
-static int lcd_goto_xy (int fd, int x, int y)
+// DDRAM address (set DDRAM address command)
+//------------------------------------------------------------------------------
+static byte_t lcd_addr (int x, int y)
 {
 	byte_t d;
 
@@ -163,42 +407,161 @@ static int lcd_goto_xy (int fd, int x, int y)
 		case	2:	d = 0x80 + LCDWidth;	break;
 		case	3:	d = 0xC0 + LCDWidth;	break;
 	}
-	d += x > LCDWidth ? LCDWidth : x;
+	return d + (x > LCDWidth ? LCDWidth : x);
+}
 
-	return i2c_send (fd, LCD_CMD, LCDBL, &d, 1, 0);
+//------------------------------------------------------------------------------
+static int lcd_goto_xy (int fd, int x, int y)
+{
+	byte_t d = lcd_addr (x, y);
+
+	return lcd_send (fd, LCD_CMD, LCDBL, &d, 1, 0);
+}
+
+//------------------------------------------------------------------------------
+// send the characters that differ from the shadow. (near runs are merged)
+//------------------------------------------------------------------------------
+static int lcd_update (int fd, int x, int y, const char *s, int len)
+{
+	char *glass;
+	int i, start, end, ret = true;
+
+	if ((y < 0) || (y >= LCDHeight) || (x < 0) || (x >= LCDWidth))
+		return false;
+	if (len > LCDWidth - x)
+		len = LCDWidth - x;
+
+	glass = &Shadow[y][x];
+	for (i = 0; i < len; ) {
+		if (glass[i] == s[i]) {
+			i++;
+			continue;
+		}
+		// one equal character costs less than a new cursor move.
+		for (start = i, end = i; i < len; i++) {
+			if (glass[i] != s[i])
+				end = i;
+			else if (i - end > 1)
+				break;
+		}
+		if (lcd_goto_xy (fd, x + start, y) &&
+			lcd_send (fd, LCD_DAT, LCDBL, (byte_t *)&s[start], end - start + 1, 0))
+			memcpy (&glass[start], &s[start], end - start + 1);
+		else {
+			memset (&glass[start], 0, end - start + 1);
+			ret = false;
+		}
+	}
+	return ret;
 }
 
 //------------------------------------------------------------------------------
 int lcd_printf (int fd, int x, int y, char *fmt, ...)
 {
-    char buf[LCDWidth +1], len;
+    char buf[LCD_COL_MAX +1];
+    int len;
     va_list va;
 
-    memset(buf, 0x00, sizeof(buf));
-
     va_start(va, fmt);
-    len = vsprintf(buf, fmt, va);
+    len = vsnprintf(buf, sizeof(buf), fmt, va);
     va_end(va);
 
-	lcd_goto_xy (fd, x, y);
+	return lcd_write (fd, x, y, buf, len < 0 ? 0 : len);
+}
+
+//------------------------------------------------------------------------------
+// text as it is, no formatting. (widget cells)
+//------------------------------------------------------------------------------
+int lcd_write (int fd, int x, int y, const char *buf, int len)
+{
+	int ret;
+
+	__sync_fetch_and_add (&Waiters, 1);
+	pthread_mutex_lock (&LCDLock);
+	__sync_fetch_and_sub (&Waiters, 1);
+	ret = screen_write (fd, x, y, buf, len);
+	pthread_mutex_unlock (&LCDLock);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// glass row = Screen, overlay cells on top.
+//------------------------------------------------------------------------------
+static void view_row (int y)
+{
+	int x;
 
-	return i2c_send (fd, LCD_DAT, LCDBL,
-		&buf[0], len > LCDWidth ? LCDWidth : len, 0);
+	for (x = 0; x < LCD_COL_MAX; x++)
+		View[y][x] = OverMask[y][x] ? Overlay[y][x] : Screen[y][x];
+}
+
+//------------------------------------------------------------------------------
+static int screen_write (int fd, int x, int y, const char *buf, int len)
+{
+	if ((y < 0) || (y >= LCDHeight) || (x < 0) || (x >= LCDWidth))
+		return false;
+	if (len > LCDWidth - x)
+		len = LCDWidth - x;
+
+	if (!memcmp (&Screen[y][x], buf, len))
+		return lcd_recover (fd) && lcd_update (fd, x, y, &View[y][x], len);
+
+	// bus fault : Screen is kept, lcd_recover replays it.
+	memcpy (&Screen[y][x], buf, len);
+	view_row (y);
+	snapshot_save ();
+	if (!lcd_recover (fd) || !lcd_update (fd, x, y, &View[y][x], len))
+		return false;
+	snapshot_done ();
+	return true;
 }
 
 //------------------------------------------------------------------------------
 int lcd_clear (int fd, int line)
+{
+	int ret;
+
+	__sync_fetch_and_add (&Waiters, 1);
+	pthread_mutex_lock (&LCDLock);
+	__sync_fetch_and_sub (&Waiters, 1);
+	ret = screen_clear (fd, line);
+	pthread_mutex_unlock (&LCDLock);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+static int screen_clear (int fd, int line)
 {
 	byte_t d = 0x01;
-    char buf[LCDWidth +1];
+	int y, ret = true;
 
-	/* clear all */
-	if (line < 0)
-		return i2c_send (fd, LCD_CMD, LCDBL, &d, 1, 2000);
+	/* clear all (then the overlay cells again) */
+	if (line < 0) {
+		memset (Screen, 0x20, sizeof(Screen));
+		memset (Shadow, 0x20, sizeof(Shadow));
+		for (y = 0; y < LCD_ROW_MAX; y++)
+			view_row (y);
+		snapshot_save ();
+		if (lcd_recover (fd) &&
+			lcd_send (fd, LCD_CMD, LCDBL, &d, 1, LCDClearDelay)) {
+			for (y = 0; y < LCDHeight; y++)
+				ret &= lcd_update (fd, 0, y, View[y], LCDWidth);
+			if (ret)
+				snapshot_done ();
+			return ret;
+		}
+		memset (Shadow, 0, sizeof(Shadow));
+		return false;
+	}
 
-	memset (buf, 0x20, LCDWidth);
-	lcd_goto_xy (fd, 0, line > LCDHeight ? (LCDHeight - 1) : line);
-	return i2c_send (fd, LCD_DAT, LCDBL, buf, LCDWidth, 0);
+	line = line >= LCDHeight ? (LCDHeight - 1) : line;
+	memset (Screen[line], 0x20, LCDWidth);
+	view_row (line);
+	snapshot_save ();
+	if (!lcd_recover (fd) || !lcd_update (fd, 0, line, View[line], LCDWidth))
+		return false;
+	snapshot_done ();
+	return true;
 }
 
 //------------------------------------------------------------------------------
@@ -206,17 +569,37 @@ int lcd_backlight (int fd, bool onoff)
 {
 	byte_t d = 0x00;
 
+	int ret;
+
+	pthread_mutex_lock (&LCDLock);
 	LCDBL = onoff;
-	return i2c_send (fd, LCD_CMD, LCDBL, &d, 1, 0);
+	ret = lcd_recover (fd) && lcd_send (fd, LCD_CMD, LCDBL, &d, 1, 0);
+	pthread_mutex_unlock (&LCDLock);
+	return ret;
 }
 
 //------------------------------------------------------------------------------
 int lcd_disp_control (int fd, bool bl, bool disp, bool cursor, bool blink)
+{
+	int ret;
+
+	pthread_mutex_lock (&LCDLock);
+	ret = disp_control (fd, bl, disp, cursor, blink);
+	pthread_mutex_unlock (&LCDLock);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+static int disp_control (int fd, bool bl, bool disp, bool cursor, bool blink)
 {
 	byte_t d = 0x08 | (disp << 2) | (cursor << 1) | blink;
 
-	LCDBL = bl;
-	return i2c_send (fd, LCD_CMD, LCDBL, &d, 1, 0);
+	LCDBL = bl;	LCDDispCtl = d;
+	snapshot_save ();
+	if (!lcd_recover (fd) || !lcd_send (fd, LCD_CMD, LCDBL, &d, 1, 0))
+		return false;
+	snapshot_done ();
+	return true;
 }
 
 //------------------------------------------------------------------------------
@@ -224,63 +607,291 @@ int lcd_disp_control (int fd, bool bl, bool disp, bool cursor, bool blink)
 int lcd_init (int fd, int lcd_width, int lcd_height, bool lcd_bl)
 {
 	byte_t d, ret = 0;
+	int y;
 
-	LCDWidth = lcd_width;	LCDHeight = lcd_height;		LCDBL = lcd_bl;
+	LCDWidth  = lcd_width  > LCD_COL_MAX ? LCD_COL_MAX : lcd_width;
+	LCDHeight = lcd_height > LCD_ROW_MAX ? LCD_ROW_MAX : lcd_height;
+	LCDBL     = lcd_bl;
+	LCDFault  = false;
 
 	// wait 15msec, Funcset (lcd startup init.)
 	d = 0x30;
-	ret += i2c_send(fd, LCD_CMD, LCD_BL_OFF, &d, 0, 15000);
+	ret += lcd_send(fd, LCD_CMD, LCD_BL_OFF, &d, 0, 15000);
 
 	// wait 4.1msec, Funcset (lcd startup init.)
 	d = 0x30;
-	ret += i2c_send(fd, LCD_CMD, LCD_BL_OFF, &d, 0, 4100);
+	ret += lcd_send(fd, LCD_CMD, LCD_BL_OFF, &d, 0, 4100);
 
 	// wait 100usec, Funcset (lcd startup init.)
 	d = 0x30;
-	ret += i2c_send(fd, LCD_CMD, LCD_BL_OFF, &d, 0, 100);
+	ret += lcd_send(fd, LCD_CMD, LCD_BL_OFF, &d, 0, 100);
 
 	// wait 4.1msec, Funcset (lcd startup init. change funcset)
 	d = 0x20;
-	ret += i2c_send(fd, LCD_CMD, LCD_BL_OFF, &d, 0, 4100);
+	ret += lcd_send(fd, LCD_CMD, LCD_BL_OFF, &d, 0, 4100);
 
 	/* -------------------------------------------------------------------- *
 	 * 4-bit mode initialization complete. Now configuring the function set *
 	 * -------------------------------------------------------------------- */
 	// Function set : D5 = 1, D3(N) = 1 (2 lune), D2(F) = 0 (5x8 font), 40usec
 	d = 0x28;
-	ret += i2c_send(fd, LCD_CMD, LCD_BL_OFF, &d, 1, 100);
+	ret += lcd_send(fd, LCD_CMD, LCD_BL_OFF, &d, 1, 100);
 
 	/* -------------------------------------------------------------------- *
 	 * Next turn display off                                                *
 	 * -------------------------------------------------------------------- */
 	// Display Control : D3=1, display_on = 0, cursor_on = 0, cursor_blink = 0
 	d = 0x08;
-	ret += i2c_send(fd, LCD_CMD, LCD_BL_OFF, &d, 1, 100);
+	ret += lcd_send(fd, LCD_CMD, LCD_BL_OFF, &d, 1, 100);
 
 	/* -------------------------------------------------------------------- *
 	 * Display clear, cursor home                                           *
 	 * -------------------------------------------------------------------- */
 	d = 0x01;
-	ret += i2c_send(fd, LCD_CMD, LCD_BL_OFF, &d, 1, 100);
+	ret += lcd_send(fd, LCD_CMD, LCD_BL_OFF, &d, 1, LCDClearDelay);
+	memset (Screen, 0x20, sizeof(Screen));
+	memset (Shadow, 0x20, sizeof(Shadow));
+	for (y = 0; y < LCD_ROW_MAX; y++)
+		view_row (y);
+	snapshot_save ();
 
 	/* -------------------------------------------------------------------- *
 	 * Set cursor direction                                                 *
 	 * -------------------------------------------------------------------- */
 	// Entry Mode : D2 = 1, I/D = 1, S = 0
 	d = 0x06;
-	ret += i2c_send(fd, LCD_CMD, LCD_BL_OFF, &d, 1, 100);
+	ret += lcd_send(fd, LCD_CMD, LCD_BL_OFF, &d, 1, 100);
 
 	/* -------------------------------------------------------------------- *
 	 * Turn on the display                                                  *
 	 * -------------------------------------------------------------------- */
 	// Display Control : D3=1, display_on = 1, cursor_on = 0, cursor_blink = 0
-	d = 0x0c;
-	ret += i2c_send(fd, LCD_CMD, LCDBL, &d, 1, 100);
+	d = LCDDispCtl = 0x0c;
+	ret += lcd_send(fd, LCD_CMD, LCDBL, &d, 1, 100);
 
 	/* -------------------------------------------------------------------- *
 	 * LCD Initialize done                                                  *
 	 * -------------------------------------------------------------------- */
-	return ret < 9 ? false : true;
+	if (ret < 9)
+		return false;
+	snapshot_done ();
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// keep View in the snapshot file. (tmpfs, gone at reboot)
+//------------------------------------------------------------------------------
+static void snapshot_save (void)
+{
+	lcd_snapshot_t snap;
+
+	if ((SnapFd < 0) &&
+		((SnapFd = open (LCD_SNAPSHOT, O_RDWR | O_CREAT | O_CLOEXEC, 0644)) < 0))
+		return;
+
+	snap.magic   = LCD_SNAPSHOT_MAGIC;
+	snap.width   = LCDWidth;
+	snap.height  = LCDHeight;
+	snap.dispctl = LCDDispCtl;
+	snap.bl      = LCDBL;
+	snap.dirty   = true;
+	memcpy (snap.screen, View, sizeof(View));
+	if (pwrite (SnapFd, &snap, sizeof(snap), 0) != sizeof(snap)) {
+		close (SnapFd);
+		SnapFd = -1;
+	}
+}
+
+//------------------------------------------------------------------------------
+static void snapshot_done (void)
+{
+	byte_t dirty = false;
+
+	if (SnapFd >= 0)
+		pwrite (SnapFd, &dirty, 1, offsetof(lcd_snapshot_t, dirty));
+}
+
+//------------------------------------------------------------------------------
+static int snapshot_load (lcd_snapshot_t *snap)
+{
+	int fd, ret;
+
+	if ((fd = open (LCD_SNAPSHOT, O_RDONLY)) < 0)
+		return false;
+	ret = read (fd, snap, sizeof(lcd_snapshot_t));
+	close (fd);
+
+	return	(ret == sizeof(lcd_snapshot_t)) &&
+			(snap->magic  == LCD_SNAPSHOT_MAGIC) &&
+			(snap->width  == LCDWidth) &&
+			(snap->height == LCDHeight);
+}
+
+//------------------------------------------------------------------------------
+// controller alive and 4-bit in phase? (busy flag / address counter read,
+// then set address commands must be read back. the test addresses have
+// different nibbles, so an 8-bit mode controller fails it.)
+//------------------------------------------------------------------------------
+static int lcd_probe (int fd)
+{
+	byte_t ac, d;
+	int retry;
+
+	for (retry = 0; retry < 3; retry++) {
+		if (!lcd_read (fd, LCD_CMD, &ac, 1))
+			return false;
+		if (!(ac & 0x80))
+			break;
+		usleep (100);
+	}
+	if (ac & 0x80)
+		return false;
+	if (!((ac < 0x28) || ((ac >= 0x40) && (ac < 0x68))))
+		return false;
+
+	// two addresses, every nibble different. (a phase slip can not match both)
+	for (retry = 0; retry < 2; retry++) {
+		d = retry ? 0x9A : 0xC5;
+		if (!lcd_send (fd, LCD_CMD, LCDBL, &d, 1, 0))
+			return false;
+		if (!lcd_read (fd, LCD_CMD, &ac, 1) || (ac != (d & 0x7F)))
+			return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// restart without the power-on handshake / clear. the screen stays up.
+// return false if the controller needs lcd_init.
+//------------------------------------------------------------------------------
+int lcd_init_warm (int fd, int lcd_width, int lcd_height, bool lcd_bl)
+{
+	lcd_snapshot_t snap;
+	int y;
+
+	if (LCDBus->read == NULL)
+		return false;
+
+	LCDWidth  = lcd_width  > LCD_COL_MAX ? LCD_COL_MAX : lcd_width;
+	LCDHeight = lcd_height > LCD_ROW_MAX ? LCD_ROW_MAX : lcd_height;
+	LCDBL     = lcd_bl;
+
+	if (snapshot_load (&snap)) {
+		memcpy (Screen, snap.screen, sizeof(Screen));
+		memcpy (Shadow, snap.screen, sizeof(Shadow));
+		memcpy (View,   snap.screen, sizeof(View));
+		LCDDispCtl = snap.dispctl;
+		// stopped in the middle of a byte : re-sync the nibble phase and
+		// rewrite the same text. (no clear, no blank)
+		if (!lcd_probe (fd)) {
+			if (!lcd_resync (fd) || !lcd_probe (fd))
+				return false;
+		}
+		// killed during a write : the glass may differ, repair from DDRAM.
+		else if (snap.dirty && (lcd_verify (fd) < 0))
+			return false;
+		snapshot_done ();
+	} else {
+		if (!lcd_probe (fd))
+			return false;
+		// no snapshot : adopt the glass as it is.
+		memset (Shadow, 0x20, sizeof(Shadow));
+		for (y = 0; y < LCDHeight; y++) {
+			if (!lcd_goto_xy (fd, 0, y) ||
+				!lcd_read (fd, LCD_DAT, (byte_t *)Shadow[y], LCDWidth))
+				return false;
+		}
+		memcpy (Screen, Shadow, sizeof(Screen));
+		memcpy (View,   Shadow, sizeof(View));
+		snapshot_save ();
+		snapshot_done ();
+	}
+	info ("lcd warm start, screen adopted.\n");
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// controller out of nibble phase : 8bit/4bit handshake (no clear),
+// then rewrite the whole screen.
+//------------------------------------------------------------------------------
+static int lcd_resync (int fd)
+{
+	byte_t d;
+	int ret = 0, y;
+
+	d = 0x30;	ret += lcd_send(fd, LCD_CMD, LCDBL, &d, 0, 4100);
+	d = 0x30;	ret += lcd_send(fd, LCD_CMD, LCDBL, &d, 0, 100);
+	d = 0x30;	ret += lcd_send(fd, LCD_CMD, LCDBL, &d, 0, 100);
+	d = 0x20;	ret += lcd_send(fd, LCD_CMD, LCDBL, &d, 0, 100);
+	d = 0x28;	ret += lcd_send(fd, LCD_CMD, LCDBL, &d, 1, 100);
+	d = 0x06;	ret += lcd_send(fd, LCD_CMD, LCDBL, &d, 1, 100);
+	d = LCDDispCtl;
+				ret += lcd_send(fd, LCD_CMD, LCDBL, &d, 1, 100);
+
+	memset (Shadow, 0, sizeof(Shadow));
+	for (y = 0; y < LCDHeight; y++)
+		ret += lcd_update (fd, 0, y, View[y], LCDWidth);
+
+	return ret == (7 + LCDHeight) ? true : false;
+}
+
+//------------------------------------------------------------------------------
+// integrity scan. return repaired cells, -1 : controller re-sync.
+//------------------------------------------------------------------------------
+int lcd_verify (int fd)
+{
+	unsigned long long t;
+	int ret;
+
+	pthread_mutex_lock (&LCDLock);
+	t = lcd_usec ();
+	ret = screen_verify (fd);
+	VerifyUs = lcd_usec () - t;
+	pthread_mutex_unlock (&LCDLock);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+static int screen_verify (int fd)
+{
+	byte_t ac, ddram[LCD_COL_MAX];
+	int x, y, bad = 0, retry;
+
+	if ((LCDBus->read == NULL) || !lcd_recover (fd))
+		return 0;
+
+	for (y = 0; y < LCDHeight; y++) {
+		// address counter must follow the set address command.
+		if (!lcd_goto_xy (fd, 0, y))
+			return 0;
+		for (retry = 0; retry < 3; retry++) {
+			if (!lcd_read (fd, LCD_CMD, &ac, 1))
+				return 0;
+			// busy flag
+			if (!(ac & 0x80))
+				break;
+			usleep (100);
+		}
+		if ((ac & 0x7F) != (lcd_addr (0, y) & 0x7F)) {
+			err ("lcd desync (line %d, ac = 0x%02x), re-sync.\n", y, ac);
+			lcd_resync (fd);
+			return -1;
+		}
+		if (!lcd_read (fd, LCD_DAT, ddram, LCDWidth))
+			return 0;
+
+		// shadow = real glass contents, lcd_update sends the difference.
+		for (x = 0; x < LCDWidth; x++) {
+			Shadow[y][x] = ddram[x];
+			if (ddram[x] != (byte_t)View[y][x])
+				bad++;
+		}
+		if (memcmp (Shadow[y], View[y], LCDWidth))
+			lcd_update (fd, 0, y, View[y], LCDWidth);
+	}
+	if (bad)
+		info ("lcd verify : %d cells repaired.\n", bad);
+	return bad;
 }
 
 //------------------------------------------------------------------------------
@@ -288,7 +899,10 @@ void lcd_close(int fd)
 {
 	if (fd) {
 		lcd_backlight (fd, false);
-		close(fd);
+		if (LCDBus == &GPIO_BUS)
+			gpio_close (fd);
+		else
+			close(fd);
 	}
 }
 
@@ -303,13 +917,539 @@ int lcd_open (char *dev, byte_t id)
 		return false;
 	}
 	// set the I2C slave address for all subsequent I2C device transfers
-	if (ioctl(fd, I2C_SLAVE, id) < 0) {
+	if (i2c_set_slave (fd, id) < 0) {
 		err("Error failed to set I2C address [0x%02x].\n", id);
+		close (fd);
 		return false;
 	}
+	// a hung bus must not hold the caller. (adapter default is ~1 sec)
+	ioctl (fd, I2C_TIMEOUT, LCD_I2C_TIMEOUT);
+	LCDBus = &I2C_BUS;
+	strncpy (LCDDev, dev, sizeof(LCDDev) -1);
+	LCDAddr    = id;
+	LCDFault   = false;
+	LCDBackoff = LCD_RETRY_MIN_MS;
+	// calibrated timing of this module. (lcd_discover)
+	{
+		char c_dev[LCD_DEV_MAX];
+		byte_t c_addr;
+
+		if (!cache_load (c_dev, sizeof(c_dev), &c_addr) ||
+			strcmp (c_dev, dev) || (c_addr != id)) {
+			LCDDelay      = -1;
+			LCDClearDelay = LCD_CLEAR_DELAY;
+		}
+	}
+	// bulk client, the redraw is split into bus slices.
+	if (LCDClient < 0)
+		LCDClient = i2c_sched_client (dev, "lcd", I2C_PRIO_BULK);
+	i2c_set_client (fd, LCDClient);
 	return fd ? fd : false;
 }
 
+//------------------------------------------------------------------------------
+// lcd on gpio lines (names : LCD_GPIO_RS ... LCD_GPIO_D7 order)
+//------------------------------------------------------------------------------
+int lcd_open_gpio (const char *chip, const char **names)
+{
+	int fd;
+
+	if ((fd = gpio_open (chip, names, LCD_GPIO_LINES)) == false)
+		return false;
+
+	GpioLines  = 0;
+	LCDBus     = &GPIO_BUS;
+	LCDDelay   = -1;
+	LCDFault   = false;
+	LCDBackoff = LCD_RETRY_MIN_MS;
+	return fd;
+}
+
+//------------------------------------------------------------------------------
+static ulong_t lcd_msec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+// bus error class (Documentation/i2c/fault-codes), always return false.
+//------------------------------------------------------------------------------
+static int lcd_fault (int e)
+{
+	const char *cls;
+
+	switch (e) {
+		case	ENXIO:		// no ack of the address
+		case	EREMOTEIO:	// no ack of the data
+			FaultStats.nack++;		cls = "nack";		break;
+		case	ETIMEDOUT:
+			FaultStats.timeout++;	cls = "timeout";	break;
+		case	EAGAIN:
+			FaultStats.arb_lost++;	cls = "arbitration";break;
+		default:
+			FaultStats.other++;		cls = strerror (e);	break;
+	}
+	if (!LCDFault) {
+		LCDFault   = true;
+		LCDRetryAt = lcd_msec () + LCDBackoff;
+		err ("lcd bus fault (%s), retry in %lu ms.\n", cls, LCDBackoff);
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// after a bus fault : reopen, controller init, replay the screen.
+// backoff doubles on every failed try, calls in between return at once.
+//------------------------------------------------------------------------------
+static int lcd_recover (int fd)
+{
+	char screen[LCD_ROW_MAX][LCD_COL_MAX];
+	byte_t dispctl = LCDDispCtl;
+	int nfd, y, ok = false;
+
+	if (!LCDFault)
+		return true;
+	if (lcd_msec () < LCDRetryAt)
+		return false;
+
+	// wait of the next try if this one fails.
+	LCDFault   = false;
+	LCDBackoff = (LCDBackoff * 2) > LCD_RETRY_MAX_MS ? LCD_RETRY_MAX_MS : LCDBackoff * 2;
+
+	// power cycled backpack, rebound adapter : new file on the same fd number.
+	if ((LCDBus == &I2C_BUS) && LCDDev[0]) {
+		if ((nfd = open (LCDDev, O_RDWR)) < 0) {
+			lcd_fault (errno);
+			goto out;
+		}
+		if ((i2c_set_slave (nfd, LCDAddr) < 0) ||
+			((nfd != fd) && (dup2 (nfd, fd) < 0))) {
+			lcd_fault (errno);
+			close (nfd);
+			goto out;
+		}
+		if (nfd != fd) {
+			close (nfd);
+			i2c_set_slave (fd, LCDAddr);
+		}
+		i2c_set_client (fd, LCDClient);
+		ioctl (fd, I2C_TIMEOUT, LCD_I2C_TIMEOUT);
+	}
+
+	memcpy (screen, Screen, sizeof(screen));
+	ok = lcd_init (fd, LCDWidth, LCDHeight, LCDBL);
+	memcpy (Screen, screen, sizeof(Screen));
+	for (y = 0; y < LCD_ROW_MAX; y++)
+		view_row (y);
+	if (ok && (dispctl != LCDDispCtl))
+		ok = disp_control (fd, LCDBL, (dispctl >> 2) & 1,
+								(dispctl >> 1) & 1, dispctl & 1);
+	for (y = 0; ok && (y < LCDHeight); y++)
+		ok = lcd_update (fd, 0, y, View[y], LCDWidth);
+out:
+	if (ok && !LCDFault) {
+		snapshot_save ();
+		snapshot_done ();
+		FaultStats.recovered++;
+		info ("lcd recovered, screen replayed.\n");
+		LCDBackoff = LCD_RETRY_MIN_MS;
+		return true;
+	}
+	FaultStats.failed++;
+	LCDFault   = true;
+	LCDRetryAt = lcd_msec () + LCDBackoff;
+	return false;
+}
+
+//------------------------------------------------------------------------------
+void lcd_fault_stats (lcd_fault_stats_t *s)
+{
+	memcpy (s, &FaultStats, sizeof(lcd_fault_stats_t));
+	s->fault = LCDFault;
+}
+
+//------------------------------------------------------------------------------
+// display server cells on top of the screen. ([LCD_ROW_MAX][LCD_COL_MAX],
+// mask 0 : the screen cell shows) only the changed cells are sent.
+//------------------------------------------------------------------------------
+int lcd_overlay (int fd, const char *cells, const byte_t *mask)
+{
+	int y, ret = true;
+
+	pthread_mutex_lock (&LCDLock);
+	memcpy (Overlay,  cells, sizeof(Overlay));
+	memcpy (OverMask, mask,  sizeof(OverMask));
+	for (y = 0; y < LCD_ROW_MAX; y++)
+		view_row (y);
+	snapshot_save ();
+	if (lcd_recover (fd)) {
+		for (y = 0; y < LCDHeight; y++) {
+			// clock tick, button feedback waiting : the rest next frame.
+			if (Waiters) {
+				PaceStats.preempted++;
+				ret = false;
+				break;
+			}
+			ret &= lcd_update (fd, 0, y, View[y], LCDWidth);
+		}
+		if (ret)
+			snapshot_done ();
+	} else
+		ret = false;
+	pthread_mutex_unlock (&LCDLock);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+static unsigned long long lcd_usec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+// rest of the last execution time, less the leading bytes of this access.
+//------------------------------------------------------------------------------
+static void lcd_pace (void)
+{
+	unsigned long long now = lcd_usec ();
+	ulong_t lead = (LCDBus == &I2C_BUS) ? LCD_PACE_LEAD * ByteNs / 1000 : 0;
+
+	if (ReadyAt <= now + lead)
+		return;
+	usleep (ReadyAt - now - lead);
+	PaceStats.paced_us += ReadyAt - now - lead;
+}
+
+//------------------------------------------------------------------------------
+// lcd bus time of the window. (LCDLock held)
+//------------------------------------------------------------------------------
+static void lcd_busy (unsigned long long start, unsigned long long end)
+{
+	if (end - WinStart >= LCD_BUDGET_WINDOW_US) {
+		PrevBusy = (end - WinStart < 2 * LCD_BUDGET_WINDOW_US) ? WinBusy : 0;
+		PaceStats.load = PrevBusy / (LCD_BUDGET_WINDOW_US / 1000);
+		WinStart = end;
+		WinBusy  = 0;
+	}
+	WinBusy += end - start;
+}
+
+//------------------------------------------------------------------------------
+static void cost_add (ulong_t *ns, ulong_t v)
+{
+	if (v > LCD_COST_NS_MAX)
+		v = LCD_COST_NS_MAX;
+	*ns = (*ns * ((1 << LCD_COST_SHIFT) - 1) + v) >> LCD_COST_SHIFT;
+}
+
+//------------------------------------------------------------------------------
+// readback after the execution wait. (counted in the bus time)
+//------------------------------------------------------------------------------
+static int lcd_read (int fd, bool d_type, byte_t *buf, int n)
+{
+	unsigned long long t = lcd_usec ();
+	int ret;
+
+	lcd_pace ();
+	ret = LCDBus->read (fd, d_type, buf, n);
+	lcd_busy (t, lcd_usec ());
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// usec to send cells characters of a row. (cursor move + data, measured)
+//------------------------------------------------------------------------------
+int lcd_cost_us (int cells)
+{
+	return cells ? (cells + 1) * OpNs / 1000 : 0;
+}
+
+//------------------------------------------------------------------------------
+// usec of the last lcd_verify. (0 : not run yet)
+//------------------------------------------------------------------------------
+int lcd_verify_cost (void)
+{
+	return VerifyUs;
+}
+
+//------------------------------------------------------------------------------
+// deferrable work of cost_us now? (the last window decays over this one)
+//------------------------------------------------------------------------------
+int lcd_budget (int cost_us)
+{
+	unsigned long long elapsed = lcd_usec () - WinStart;
+	ulong_t used, w = LCD_BUDGET_WINDOW_US;
+
+	if (elapsed >= 2 * w)
+		used = 0;
+	else if (elapsed >= w)
+		used = (unsigned long long)WinBusy * (2 * w - elapsed) / w;
+	else
+		used = (unsigned long long)PrevBusy * (w - elapsed) / w + WinBusy;
+
+	if (used + (ulong_t)cost_us <= w / 1000 * LCD_BUDGET_PERMILLE)
+		return true;
+	PaceStats.deferred++;
+	return false;
+}
+
+//------------------------------------------------------------------------------
+void lcd_pace_stats (lcd_pace_stats_t *s)
+{
+	memcpy (s, &PaceStats, sizeof(lcd_pace_stats_t));
+	s->byte_ns = ByteNs;
+	s->op_ns   = OpNs;
+}
+
+//------------------------------------------------------------------------------
+void lcd_pace_report (void)
+{
+	unsigned long long t = lcd_usec ();
+
+	if (TPaceReport && (t - TPaceReport < LCD_PACE_REPORT_SEC * 1000000ULL))
+		return;
+	TPaceReport = t;
+	info ("lcd pace : byte %lu ns, op %lu us, wait %lu / %lu us, load %d.%d%%, deferred %lu, preempted %lu\n",
+		ByteNs, OpNs / 1000, PaceStats.paced_us, PaceStats.delay_us,
+		PaceStats.load / 10, PaceStats.load % 10, PaceStats.deferred, PaceStats.preempted);
+}
+
+//------------------------------------------------------------------------------
+// write the pattern at (0,0) and read it back.
+//------------------------------------------------------------------------------
+static int lcd_echo (int fd, const char *pat, int n)
+{
+	byte_t buf[LCD_COL_MAX];
+
+	if (!lcd_goto_xy (fd, 0, 0) ||
+		!lcd_send (fd, LCD_DAT, LCDBL, (byte_t *)pat, n, 0) ||
+		!lcd_goto_xy (fd, 0, 0) ||
+		!lcd_read (fd, LCD_DAT, buf, n))
+		return false;
+	return memcmp (buf, pat, n) ? false : true;
+}
+
+//------------------------------------------------------------------------------
+// cache file : "dev addr delay clear_delay"
+//------------------------------------------------------------------------------
+static int cache_load (char *dev, int size, byte_t *addr)
+{
+	char fmt[32];
+	int delay, clear, a;
+	FILE *fp;
+
+	if ((fp = fopen (LCD_CACHE, "r")) == NULL)
+		return false;
+	snprintf (fmt, sizeof(fmt), "%%%ds %%x %%d %%d", size -1);
+	a = fscanf (fp, fmt, dev, &a, &delay, &clear) == 4 ? a : -1;
+	fclose (fp);
+
+	if ((a < 0x03) || (a > 0x77) || (delay < 0) || (clear <= 0))
+		return false;
+	*addr = a;	LCDDelay = delay;	LCDClearDelay = clear;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+static void cache_save (const char *dev, byte_t addr)
+{
+	FILE *fp;
+
+	if ((fp = fopen (LCD_CACHE, "w")) == NULL) {
+		err ("%s : %s\n", LCD_CACHE, strerror (errno));
+		return;
+	}
+	fprintf (fp, "%s %02x %d %d\n", dev, addr, LCDDelay, LCDClearDelay);
+	fclose (fp);
+}
+
+//------------------------------------------------------------------------------
+// smallest delays that still read back correctly, one step of margin.
+//------------------------------------------------------------------------------
+static int lcd_calibrate (int fd)
+{
+	const int delays[] = { 0, 10, 20, 50, 100 };
+	const int clears[] = { 200, 500, 1000, 1600, 2000, 3000 };
+	const int n_delays = sizeof(delays) / sizeof(delays[0]);
+	const int n_clears = sizeof(clears) / sizeof(clears[0]);
+	const char *pat[] = { "0123456789ABCDEF", "Z.z.Z.z.Z.z.Z.z." };
+	char buf[2];
+	byte_t d = 0x01;
+	int i, r;
+
+	// command / data delay : set address right after the data, read back.
+	for (i = 0; i < n_delays; i++) {
+		LCDDelay = delays[i];
+		for (r = 0; r < 4; r++) {
+			if (!lcd_echo (fd, pat[r & 1], DEFAULT_LCD_WIDTH))
+				break;
+		}
+		if (r == 4)
+			break;
+	}
+	if (i == n_delays)
+		return false;
+	LCDDelay = delays[(i + 1) < n_delays ? i + 1 : i];
+
+	// clear delay : clear, write at once. the write is lost while busy.
+	for (i = 0; i < n_clears; i++) {
+		for (r = 0; r < 3; r++) {
+			if (!lcd_echo (fd, "XX", 2) ||
+				!lcd_send (fd, LCD_CMD, LCDBL, &d, 1, clears[i]) ||
+				!lcd_send (fd, LCD_DAT, LCDBL, (byte_t *)"Z", 1, 0) ||
+				!lcd_goto_xy (fd, 0, 0) ||
+				!lcd_read (fd, LCD_DAT, (byte_t *)buf, 2) ||
+				(buf[0] != 'Z') || (buf[1] != ' '))
+				break;
+		}
+		if (r == 3)
+			break;
+		// still busy from the failed try.
+		usleep (LCD_CLEAR_DELAY);
+	}
+	if (i == n_clears)
+		return false;
+	LCDClearDelay = clears[(i + 1) < n_clears ? i + 1 : i];
+
+	info ("lcd timing : delay %d us, clear %d us\n", LCDDelay, LCDClearDelay);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// PCF8574 port readback, EN low : the HD44780 ignores the port. the written
+// low pins read low, RW high (weak pull-up) reads high. a register chip
+// (sensor, oled, MCP23017) takes the byte as a pointer / command and reads
+// back its own data.
+//------------------------------------------------------------------------------
+static int lcd_port_echo (int fd)
+{
+	i2clcd_u port;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		port.byte = 0;
+		port.bits.bl = 1;	port.bits.rw = i;
+		if ((i2c_smbus_write_byte (fd, port.byte) < 0) ||
+			(i2c_smbus_read_byte (fd) != port.byte))
+			return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// PCF8574 at the address with a HD44780 behind it? return fd or false.
+// nothing but the read and the port echo before the controller init.
+//------------------------------------------------------------------------------
+static int lcd_scan (int bus, byte_t addr)
+{
+	char dev[LCD_DEV_MAX];
+	ulong_t funcs;
+	int fd, ack;
+
+	snprintf (dev, sizeof(dev), "/dev/i2c-%d", bus);
+	if ((fd = open (dev, O_RDWR)) < 0)
+		return false;
+
+	// adapter must do block writes (lcd) / byte read, write (readback).
+	if ((ioctl (fd, I2C_FUNCS, &funcs) < 0) ||
+		!(funcs & I2C_FUNC_SMBUS_WRITE_BLOCK_DATA) ||
+		!(funcs & I2C_FUNC_SMBUS_READ_BYTE) ||
+		!(funcs & I2C_FUNC_SMBUS_WRITE_BYTE) ||
+		(i2c_set_slave (fd, addr) < 0)) {	// EBUSY : kernel driver
+		close (fd);
+		return false;
+	}
+	ack = (i2c_smbus_read_byte (fd) >= 0) && lcd_port_echo (fd);
+
+	// other PCF8574 (buttons, relays) : DDRAM does not echo.
+	LCDBus = &I2C_BUS;	LCDDelay = DEFAULT_I2C_DELAY;	LCDClearDelay = LCD_CLEAR_DELAY;
+	LCDDev[0] = 0;
+	if (!ack || !lcd_init (fd, DEFAULT_LCD_WIDTH, DEFAULT_LCD_HEIGHT, true) ||
+		!lcd_echo (fd, "lcd scan", 8)) {
+		close (fd);
+		return false;
+	}
+	return fd;
+}
+
+//------------------------------------------------------------------------------
+// adapter numbers of /dev/i2c-*, ascending. return count.
+//------------------------------------------------------------------------------
+static int lcd_buses (int *bus, int max)
+{
+	struct dirent *de;
+	DIR *dir;
+	int n = 0, i, v;
+
+	if ((dir = opendir ("/dev")) == NULL)
+		return 0;
+	while ((n < max) && ((de = readdir (dir)) != NULL)) {
+		if (strncmp (de->d_name, "i2c-", 4) || !isdigit (de->d_name[4]))
+			continue;
+		v = atoi (&de->d_name[4]);
+		for (i = n; (i > 0) && (bus[i - 1] > v); i--)
+			bus[i] = bus[i - 1];
+		bus[i] = v;
+		n++;
+	}
+	closedir (dir);
+	return n;
+}
+
+//------------------------------------------------------------------------------
+// find the i2c lcd module. (cache, or all /dev/i2c-N at PCF8574 0x20~0x27,
+// PCF8574A 0x38~0x3F) a new module gets the timing calibration.
+//------------------------------------------------------------------------------
+int lcd_discover (char *dev, int size, byte_t *addr, bool rescan)
+{
+	const byte_t addrs[] = {
+		0x27, 0x3F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26,
+		0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E
+	};
+	int buses[LCD_SCAN_BUS_MAX], count, bus, i, fd;
+
+	// cached module still answers : no scan. (timing loaded)
+	if (!rescan && cache_load (dev, size, addr)) {
+		if (((fd = open (dev, O_RDWR)) >= 0) &&
+			(i2c_set_slave (fd, *addr) >= 0) &&
+			(i2c_smbus_read_byte (fd) >= 0)) {
+			close (fd);
+			return true;
+		}
+		if (fd >= 0)
+			close (fd);
+	}
+
+	count = lcd_buses (buses, LCD_SCAN_BUS_MAX);
+	for (bus = 0; bus < count; bus++) {
+		for (i = 0; i < (int)sizeof(addrs); i++) {
+			if ((fd = lcd_scan (buses[bus], addrs[i])) == false)
+				continue;
+
+			snprintf (dev, size, "/dev/i2c-%d", buses[bus]);
+			*addr = addrs[i];
+			info ("lcd found : %s, addr 0x%02x\n", dev, *addr);
+			if (!lcd_calibrate (fd)) {
+				LCDDelay      = DEFAULT_I2C_DELAY;
+				LCDClearDelay = LCD_CLEAR_DELAY;
+			}
+			cache_save (dev, *addr);
+			// glass = snapshot (lcd_init_warm of the caller).
+			lcd_clear (fd, -1);
+			close (fd);
+			return true;
+		}
+	}
+	err ("i2c lcd module not found.\n");
+	return false;
+}
+
 //------------------------------------------------------------------------------
 void lcd_test (void)
 {
@@ -64,14 +64,85 @@ typedef union i2clcd__u {
 #define	LCD_BL_OFF			0
 #define	LCD_BL_ON			1
 
+#define	LCD_COL_MAX			40
+#define	LCD_ROW_MAX			4
+#define	LCD_EXEC_DELAY		50	// usec, instruction execution time (gpio)
+#define	LCD_SNAPSHOT		"/run/netinfo_display.lcd"
+#define	LCD_CACHE			"/var/cache/netinfo_display.lcd"	// lcd_discover
+#define	LCD_CLEAR_DELAY		2000	// usec, clear display (calibrated)
+#define	LCD_SCAN_BUS_MAX	64		// /dev/i2c-* adapters scanned
+#define	LCD_DEV_MAX			32
+#define	LCD_ARB_RETRY		3		// arbitration lost, send again
+#define	LCD_RETRY_MIN_MS	100		// bus fault recovery backoff
+#define	LCD_RETRY_MAX_MS	30000
+#define	LCD_I2C_TIMEOUT		10		// I2C_TIMEOUT ioctl, 10 ms units
+
+// pacing : the execution wait runs from the end of a send, the next send
+// sleeps only the part its own leading bytes do not cover on the wire.
+#define	LCD_PACE_LEAD		2			// wire bytes before the first EN edge
+#define	LCD_BYTE_NS_MIN		22500		// 9 bits at 400 kHz, before a measure
+#define	LCD_OP_NS_INIT		450000		// one instruction at 100 kHz, before a measure
+#define	LCD_COST_SHIFT		3			// EWMA 1/8 of the measured costs
+#define	LCD_COST_NS_MAX		100000000	// a stall (preempted, bus timeout) counts as this
+// bus budget : deferrable work (overlay frames, low priority pages, readback)
+// goes only while the lcd bus time of the window stays under the share.
+#define	LCD_BUDGET_WINDOW_US	1000000
+#define	LCD_BUDGET_PERMILLE	250
+#define	LCD_PACE_REPORT_SEC	60
+
+// gpio line order (lcd_open_gpio names)
+enum {
+	LCD_GPIO_RS = 0,
+	LCD_GPIO_E,
+	LCD_GPIO_D4,
+	LCD_GPIO_D5,
+	LCD_GPIO_D6,
+	LCD_GPIO_D7,
+	LCD_GPIO_LINES
+};
+#define	LCD_GPIO_MASK		((1 << LCD_GPIO_LINES) - 1)
+
+//------------------------------------------------------------------------------
+typedef struct lcd_fault_stats__t {
+	ulong_t		nack;			// ENXIO, EREMOTEIO
+	ulong_t		timeout;		// ETIMEDOUT
+	ulong_t		arb_lost;		// EAGAIN
+	ulong_t		other;
+	ulong_t		recovered;
+	ulong_t		failed;			// recovery tries failed
+	bool		fault;			// in fault now
+}	lcd_fault_stats_t;
+
+typedef struct lcd_pace_stats__t {
+	ulong_t		byte_ns;		// measured wire byte (i2c)
+	ulong_t		op_ns;			// measured instruction / character send
+	ulong_t		delay_us;		// execution waits asked
+	ulong_t		paced_us;		// slept of them (the rest : bus time)
+	int			load;			// lcd bus time of the last window (permille)
+	ulong_t		deferred;		// lcd_budget refused
+	ulong_t		preempted;		// overlay frames cut by a foreground write
+}	lcd_pace_stats_t;
+
 //------------------------------------------------------------------------------
 extern int  lcd_printf          (int fd, int x, int y, char *fmt, ...);
+extern int  lcd_write           (int fd, int x, int y, const char *buf, int len);
 extern int  lcd_clear           (int fd, int line);
 extern int  lcd_backlight       (int fd, bool onoff);
 extern int  lcd_disp_control    (int fd, bool bl, bool disp, bool cursor, bool blink);
 extern void lcd_close           (int fd);
 extern int  lcd_init            (int fd, int lcd_width, int lcd_height, bool lcd_bl);
 extern int  lcd_open 		    (char *dev, byte_t id);
+extern int  lcd_open_gpio       (const char *chip, const char **names);
+extern int  lcd_verify          (int fd);
+extern int  lcd_init_warm       (int fd, int lcd_width, int lcd_height, bool lcd_bl);
+extern int  lcd_discover        (char *dev, int size, byte_t *addr, bool rescan);
+extern void lcd_fault_stats     (lcd_fault_stats_t *s);
+extern int  lcd_overlay         (int fd, const char *cells, const byte_t *mask);
+extern int  lcd_cost_us         (int cells);
+extern int  lcd_verify_cost     (void);
+extern int  lcd_budget          (int cost_us);
+extern void lcd_pace_stats      (lcd_pace_stats_t *s);
+extern void lcd_pace_report     (void);
 
 //------------------------------------------------------------------------------
 
@@ -0,0 +1,277 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 I2C bus arbitration scheduler. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "typedefs.h"
+#include "i2c-sched.h"
+
+//------------------------------------------------------------------------------
+typedef struct i2c_bus__t {
+	char			dev[32];
+	int				slice;			// bytes per bulk transaction
+	pthread_mutex_t	lock;
+	pthread_cond_t	cond;
+	int				owner;			// client id, -1 : bus free
+	pthread_t		thread;			// of the owner
+	// tickets per priority (next - serve = waiting clients)
+	ulong_t			next[I2C_PRIO_LEVELS];
+	ulong_t			serve[I2C_PRIO_LEVELS];
+}	i2c_bus_t;
+
+typedef struct i2c_client__t {
+	i2c_bus_t		*bus;
+	ulong_t			t_start;		// registered
+	ulong_t			t_acquire;		// bus held since
+	int				depth;			// nested acquire of the owner
+	i2c_sched_stats_t	stats;
+}	i2c_client_t;
+
+//------------------------------------------------------------------------------
+static	pthread_mutex_t	Lock = PTHREAD_MUTEX_INITIALIZER;
+static	i2c_bus_t		Buses[I2C_SCHED_BUS_MAX];
+static	int				BusCount;
+static	i2c_client_t	Clients[I2C_SCHED_CLIENT_MAX];
+static	int				ClientCount;
+static	ulong_t			TReport;
+
+//------------------------------------------------------------------------------
+static	ulong_t	sched_usec		(void);
+static	int		bus_clock		(const char *dev);
+static	i2c_bus_t	*bus_get	(const char *dev);
+static	bool	bus_turn		(i2c_bus_t *bus, int prio, ulong_t ticket);
+		int		i2c_sched_client	(const char *dev, const char *name, int prio);
+		int		i2c_sched_acquire	(int id);
+		void	i2c_sched_release	(int id, int bytes);
+		int		i2c_sched_slice		(int id);
+		int		i2c_sched_stats		(int id, i2c_sched_stats_t *s);
+		void	i2c_sched_report	(void);
+
+//------------------------------------------------------------------------------
+static ulong_t sched_usec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+// bus clock of the adapter. (device tree clock-frequency, big endian u32)
+//------------------------------------------------------------------------------
+static int bus_clock (const char *dev)
+{
+	const char *fmt[] = {
+		"/sys/bus/i2c/devices/%s/of_node/clock-frequency",
+		"/sys/bus/i2c/devices/%s/device/of_node/clock-frequency",
+	};
+	const char *name = strrchr (dev, '/') ? strrchr (dev, '/') + 1 : dev;
+	char path[128];
+	byte_t v[4];
+	int fd, i, ret;
+
+	for (i = 0; i < (int)(sizeof(fmt) / sizeof(fmt[0])); i++) {
+		snprintf (path, sizeof(path), fmt[i], name);
+		if ((fd = open (path, O_RDONLY)) < 0)
+			continue;
+		ret = read (fd, v, sizeof(v));
+		close (fd);
+		if (ret == sizeof(v))
+			return (v[0] << 24) | (v[1] << 16) | (v[2] << 8) | v[3];
+	}
+	return I2C_DEFAULT_CLOCK;
+}
+
+//------------------------------------------------------------------------------
+// find or add the bus. (Lock held)
+//------------------------------------------------------------------------------
+static i2c_bus_t *bus_get (const char *dev)
+{
+	i2c_bus_t *bus;
+	int i, clock;
+
+	for (i = 0; i < BusCount; i++) {
+		if (!strcmp (Buses[i].dev, dev))
+			return &Buses[i];
+	}
+	if (BusCount >= I2C_SCHED_BUS_MAX)
+		return NULL;
+
+	bus = &Buses[BusCount++];
+	memset (bus, 0, sizeof(i2c_bus_t));
+	strncpy (bus->dev, dev, sizeof(bus->dev) -1);
+	pthread_mutex_init (&bus->lock, NULL);
+	pthread_cond_init  (&bus->cond, NULL);
+	bus->owner = -1;
+
+	// block write = (addr + command + count + data) * 9 bit.
+	clock = bus_clock (dev);
+	bus->slice = (int)(((ulong_t)clock * I2C_SCHED_SLICE_US / 1000000) / 9) - 3;
+	bus->slice = bus->slice > 32 ? 32 : bus->slice & ~3;
+	if (bus->slice < 4)
+		bus->slice = 4;
+
+	info ("i2c sched : %s %d Hz, slice %d bytes\n", dev, clock, bus->slice);
+	return bus;
+}
+
+//------------------------------------------------------------------------------
+// free bus, no higher priority waiting, our ticket is served. (bus lock held)
+//------------------------------------------------------------------------------
+static bool bus_turn (i2c_bus_t *bus, int prio, ulong_t ticket)
+{
+	int p;
+
+	if (bus->owner >= 0)
+		return false;
+	for (p = prio + 1; p < I2C_PRIO_LEVELS; p++) {
+		if (bus->next[p] != bus->serve[p])
+			return false;
+	}
+	return bus->serve[prio] == ticket;
+}
+
+//------------------------------------------------------------------------------
+// return client id, -1 : not scheduled. (acquire / release do nothing)
+//------------------------------------------------------------------------------
+int i2c_sched_client (const char *dev, const char *name, int prio)
+{
+	i2c_client_t *c;
+	i2c_bus_t *bus;
+	int id = -1;
+
+	pthread_mutex_lock (&Lock);
+	if ((ClientCount < I2C_SCHED_CLIENT_MAX) && ((bus = bus_get (dev)) != NULL)) {
+		id = ClientCount++;
+		c  = &Clients[id];
+		memset (c, 0, sizeof(i2c_client_t));
+		c->bus         = bus;
+		c->t_start     = sched_usec ();
+		c->stats.name  = name;
+		c->stats.prio  = prio < 0 ? 0 :
+						 prio >= I2C_PRIO_LEVELS ? I2C_PRIO_LEVELS -1 : prio;
+	}
+	pthread_mutex_unlock (&Lock);
+	return id;
+}
+
+//------------------------------------------------------------------------------
+int i2c_sched_acquire (int id)
+{
+	i2c_client_t *c;
+	i2c_bus_t *bus;
+	ulong_t ticket, t, wait;
+	int prio;
+
+	if ((id < 0) || (id >= ClientCount))
+		return true;
+
+	c = &Clients[id];	bus = c->bus;	prio = c->stats.prio;
+	t = sched_usec ();
+
+	pthread_mutex_lock (&bus->lock);
+	if ((bus->owner == id) && pthread_equal (bus->thread, pthread_self ())) {
+		c->depth++;
+		pthread_mutex_unlock (&bus->lock);
+		return true;
+	}
+	ticket = bus->next[prio]++;
+	while (!bus_turn (bus, prio, ticket))
+		pthread_cond_wait (&bus->cond, &bus->lock);
+	bus->serve[prio]++;
+	bus->owner  = id;
+	bus->thread = pthread_self ();
+	pthread_mutex_unlock (&bus->lock);
+
+	c->t_acquire = sched_usec ();
+	wait = c->t_acquire - t;
+	c->stats.wait_us += wait;
+	if (wait > c->stats.wait_max_us)
+		c->stats.wait_max_us = wait;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+void i2c_sched_release (int id, int bytes)
+{
+	i2c_client_t *c;
+	i2c_bus_t *bus;
+
+	if ((id < 0) || (id >= ClientCount))
+		return;
+
+	c = &Clients[id];	bus = c->bus;
+	// inner release : the outer one counts.
+	if (c->depth) {
+		c->depth--;
+		return;
+	}
+	c->stats.busy_us += sched_usec () - c->t_acquire;
+	c->stats.bytes   += bytes;
+	c->stats.xfers++;
+
+	pthread_mutex_lock (&bus->lock);
+	bus->owner = -1;
+	pthread_cond_broadcast (&bus->cond);
+	pthread_mutex_unlock (&bus->lock);
+}
+
+//------------------------------------------------------------------------------
+// max bytes of one bulk transaction. (smbus block max 32)
+//------------------------------------------------------------------------------
+int i2c_sched_slice (int id)
+{
+	if ((id < 0) || (id >= ClientCount))
+		return 32;
+	return Clients[id].bus->slice;
+}
+
+//------------------------------------------------------------------------------
+int i2c_sched_stats (int id, i2c_sched_stats_t *s)
+{
+	i2c_client_t *c;
+	ulong_t elapsed;
+
+	if ((id < 0) || (id >= ClientCount))
+		return false;
+
+	c = &Clients[id];
+	memcpy (s, &c->stats, sizeof(i2c_sched_stats_t));
+	elapsed = sched_usec () - c->t_start;
+	s->occupancy = elapsed ? (int)(s->busy_us * 1000 / elapsed) : 0;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// bus occupancy of every client. (once per I2C_SCHED_REPORT_SEC)
+//------------------------------------------------------------------------------
+void i2c_sched_report (void)
+{
+	i2c_sched_stats_t s;
+	ulong_t t = sched_usec ();
+	int id;
+
+	if (!ClientCount || (TReport && (t - TReport < I2C_SCHED_REPORT_SEC * 1000000UL)))
+		return;
+	TReport = t;
+
+	for (id = 0; id < ClientCount; id++) {
+		if (!i2c_sched_stats (id, &s))
+			continue;
+		info ("i2c sched : %-8s %s prio %d, busy %d.%d%%, xfers %lu, bytes %lu, wait max %lu us\n",
+			s.name, Clients[id].bus->dev, s.prio,
+			s.occupancy / 10, s.occupancy % 10, s.xfers, s.bytes, s.wait_max_us);
+	}
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
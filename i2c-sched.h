@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 I2C bus arbitration scheduler. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __I2C_SCHED_H__
+#define __I2C_SCHED_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	Clients of the same bus (/dev/i2c-N) hold the bus one transaction at a
+	time. A waiting client of higher priority goes first, the same priority
+	is served in arrival order. Bulk clients (lcd) split their writes into
+	i2c_sched_slice() bytes, so a latency client waits at most one slice.
+	The kernel adapter lock is per transfer, sensor drivers of the kernel
+	(hwmon) also see the shorter transfers.
+	i2c_smbus_access (i2c-ctl.c) holds the bus for each transaction of a
+	file bound by i2c_set_client, a client gets its priority on every
+	transaction. Acquire of the owner thread nests : a group of transactions
+	(lcd readback) is held by an outer acquire / release.
+*/
+//------------------------------------------------------------------------------
+#define	I2C_SCHED_BUS_MAX		4
+#define	I2C_SCHED_CLIENT_MAX	8
+#define	I2C_SCHED_SLICE_US		1000	// max bus time of one bulk transaction
+#define	I2C_SCHED_REPORT_SEC	60		// i2c_sched_report interval
+#define	I2C_DEFAULT_CLOCK		100000	// Hz, of_node clock-frequency not found
+
+enum {
+	I2C_PRIO_BULK = 0,		// display redraw
+	I2C_PRIO_NORMAL,
+	I2C_PRIO_LATENCY,		// sensor reads
+	I2C_PRIO_LEVELS
+};
+
+//------------------------------------------------------------------------------
+typedef struct i2c_sched_stats__t {
+	const char	*name;
+	int			prio;
+	ulong_t		xfers;
+	ulong_t		bytes;
+	ulong_t		busy_us;		// bus held
+	ulong_t		wait_us;		// total wait for the bus
+	ulong_t		wait_max_us;	// worst case wait
+	// busy_us / elapsed time since i2c_sched_client (permille)
+	int			occupancy;
+}	i2c_sched_stats_t;
+
+//------------------------------------------------------------------------------
+extern int	i2c_sched_client	(const char *dev, const char *name, int prio);
+extern int	i2c_sched_acquire	(int id);
+extern void	i2c_sched_release	(int id, int bytes);
+extern int	i2c_sched_slice		(int id);
+extern int	i2c_sched_stats		(int id, i2c_sched_stats_t *s);
+extern void	i2c_sched_report	(void);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __I2C_SCHED_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,411 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 I2C capture trace analyzer. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "typedefs.h"
+#include "i2c-ctl.h"
+#include "i2c-lcd.h"
+#include "i2c-sched.h"
+#include "i2c-trace.h"
+
+//------------------------------------------------------------------------------
+// HD44780 model
+//------------------------------------------------------------------------------
+typedef struct hd_model__t {
+	byte_t		port;					// last PCF8574 output
+	int			phase;					// 0 : high nibble next
+	byte_t		hi;
+	byte_t		ddram[HD44780_DDRAM_SIZE];
+	bool		known[HD44780_DDRAM_SIZE];
+	byte_t		start[HD44780_DDRAM_SIZE];	// frame start
+	bool		start_known[HD44780_DDRAM_SIZE];
+	int			addr;					// -1 : unknown
+	bool		cgram;
+	int			entry, display, function;	// -1 : unknown
+}	hd_model_t;
+
+typedef struct trace_total__t {
+	ulong_t		records, writes, reads, failed;
+	ulong_t		other, other_wire;		// not the lcd address
+	ulong_t		wire, stray, readback;
+	ulong_t		cmds, datas;
+	ulong_t		same_data, same_move, blank_clear, same_mode;
+	ulong_t		moves, clears;
+	ulong_t		bl_glitch;
+	ulong_t		frames, min_wire, frame_ops;
+}	trace_total_t;
+
+//------------------------------------------------------------------------------
+static	hd_model_t			Hd;
+static	trace_total_t		Total;
+static	i2c_trace_frame_t	Frame;
+static	ulong_t				FrameExec;			// clear / home execution
+static	int					FrameOther;			// mode, shift, cgram ops
+
+//------------------------------------------------------------------------------
+static	int		wire_bytes		(const i2c_trace_rec_t *r, int *stray);
+static	void	hd_op			(byte_t v, bool rs);
+static	void	port_write		(byte_t v, bool stray);
+static	int		frame_cells		(bool blank);
+static	int		frame_min_ops	(void);
+static	void	frame_begin		(unsigned long long t);
+static	void	frame_end		(void);
+static	void	trace_rec		(const i2c_trace_rec_t *r, const byte_t *data);
+static	int		trace_lcd_addr	(FILE *fp);
+		int		i2c_trace_report(const char *path);
+
+//------------------------------------------------------------------------------
+// bytes on the bus with the address bytes. stray : command / count bytes.
+//------------------------------------------------------------------------------
+static int wire_bytes (const i2c_trace_rec_t *r, int *stray)
+{
+	bool rd = (r->rw == I2C_SMBUS_READ);
+
+	*stray = 0;
+	switch (r->size) {
+		case	I2C_SMBUS_QUICK:
+			return 1;
+		case	I2C_SMBUS_BYTE:
+			return 2;
+		case	I2C_SMBUS_BYTE_DATA:
+			*stray = rd ? 0 : 1;
+			return rd ? 4 : 3;
+		case	I2C_SMBUS_WORD_DATA:
+		case	I2C_SMBUS_PROC_CALL:
+			*stray = rd ? 0 : 1;
+			return rd ? 5 : 4;
+		case	I2C_SMBUS_BLOCK_DATA:
+			*stray = rd ? 0 : 2;
+			return rd ? 4 + r->len : 3 + r->len;
+		default :
+			*stray = rd ? 0 : 1;
+			return rd ? 3 + r->len : 2 + r->len;
+	}
+}
+
+//------------------------------------------------------------------------------
+// one instruction / data byte against the model.
+//------------------------------------------------------------------------------
+static void hd_op (byte_t v, bool rs)
+{
+	int i;
+
+	Frame.ops++;
+	if (rs) {
+		Total.datas++;
+		if (Hd.cgram || (Hd.addr < 0)) {
+			FrameOther++;
+			return;
+		}
+		if (Hd.known[Hd.addr] && (Hd.ddram[Hd.addr] == v)) {
+			Total.same_data++;
+			Frame.redundant++;
+		}
+		Hd.ddram[Hd.addr] = v;
+		Hd.known[Hd.addr] = true;
+		Hd.addr = (Hd.addr + 1) & (HD44780_DDRAM_SIZE -1);
+		return;
+	}
+
+	Total.cmds++;
+	if (v & 0x80) {
+		Total.moves++;
+		if (!Hd.cgram && (Hd.addr == (v & 0x7F))) {
+			Total.same_move++;
+			Frame.redundant++;
+		}
+		Hd.addr  = v & 0x7F;
+		Hd.cgram = false;
+	} else if (v & 0x40) {
+		Hd.cgram = true;
+		FrameOther++;
+	} else if (v & 0x20) {
+		// 0x33, 0x32 : 4 bit mode init (nibbles 3, 3, 3, 2)
+		if ((v == 0x33) || (v == 0x32)) {
+			Hd.phase = 0;
+			return;
+		}
+		if (Hd.function == v)	{ Total.same_mode++;	Frame.redundant++; }
+		else					FrameOther++;
+		Hd.function = v;
+	} else if (v & 0x10) {
+		Hd.addr = -1;		// cursor / display shift
+		FrameOther++;
+	} else if (v & 0x08) {
+		if (Hd.display == v)	{ Total.same_mode++;	Frame.redundant++; }
+		else					FrameOther++;
+		Hd.display = v;
+	} else if (v & 0x04) {
+		if (Hd.entry == v)		{ Total.same_mode++;	Frame.redundant++; }
+		else					FrameOther++;
+		Hd.entry = v;
+	} else if (v & 0x02) {
+		if (!Hd.cgram && (Hd.addr == 0))	{ Total.same_move++;	Frame.redundant++; }
+		Hd.addr  = 0;
+		Hd.cgram = false;
+		FrameExec += HD44780_CLEAR_US;
+	} else if (v & 0x01) {
+		Total.clears++;
+		for (i = 0; i < HD44780_DDRAM_SIZE; i++) {
+			if (!Hd.known[i] || (Hd.ddram[i] != ' '))
+				break;
+		}
+		if (i == HD44780_DDRAM_SIZE)	{ Total.blank_clear++;	Frame.redundant++; }
+		memset (Hd.ddram, ' ', sizeof(Hd.ddram));
+		memset (Hd.known, true, sizeof(Hd.known));
+		Hd.addr  = 0;
+		Hd.cgram = false;
+		FrameExec += HD44780_CLEAR_US;
+	}
+}
+
+//------------------------------------------------------------------------------
+// EN falling edge : nibble of the byte before. (RW = 1 : read cycle)
+//------------------------------------------------------------------------------
+static void port_write (byte_t v, bool stray)
+{
+	i2clcd_u last, now;
+
+	last.byte = Hd.port;
+	now.byte  = v;
+	if (stray && (now.bits.bl != last.bits.bl))
+		Total.bl_glitch++;
+
+	if (last.bits.e && !now.bits.e && !last.bits.rw) {
+		if (Hd.phase == 0) {
+			Hd.hi    = last.bits.dat;
+			Hd.phase = 1;
+		} else {
+			Hd.phase = 0;
+			hd_op ((Hd.hi << 4) | last.bits.dat, last.bits.rs);
+		}
+	}
+	Hd.port = v;
+}
+
+//------------------------------------------------------------------------------
+// cells to write, a cursor move (1 op) or a rewrite of the gap cells between.
+// blank : after a clear, only the non space cells.
+//------------------------------------------------------------------------------
+static int frame_cells (bool blank)
+{
+	int line, i, n = 0, gap = -1;
+	bool same;
+
+	for (line = 0; line < 2; line++) {
+		for (i = line * 0x40; i < line * 0x40 + 40; i++) {
+			if (!Hd.known[i])
+				continue;
+			same = blank ? (Hd.ddram[i] == ' ') :
+					(Hd.start_known[i] && (Hd.start[i] == Hd.ddram[i]));
+			if (same) {
+				if (gap >= 0)
+					gap++;
+				continue;
+			}
+			n += ((gap < 0) || (gap > 1)) ? 2 : gap + 1;
+			gap = 0;
+		}
+		gap = -1;
+	}
+	return n;
+}
+
+//------------------------------------------------------------------------------
+// changed cells, or a clear and the text if cheaper. (+ other instructions)
+//------------------------------------------------------------------------------
+static int frame_min_ops (void)
+{
+	int cells = frame_cells (false), clear = 1 + frame_cells (true);
+
+	return (cells < clear ? cells : clear) + FrameOther;
+}
+
+//------------------------------------------------------------------------------
+static void frame_begin (unsigned long long t)
+{
+	memset (&Frame, 0, sizeof(Frame));
+	Frame.start_us = t;
+	FrameExec = FrameOther = 0;
+	memcpy (Hd.start, Hd.ddram, sizeof(Hd.start));
+	memcpy (Hd.start_known, Hd.known, sizeof(Hd.start_known));
+}
+
+//------------------------------------------------------------------------------
+static void frame_end (void)
+{
+	int ops, bytes, need;
+
+	if (!Frame.xfers)
+		return;
+	ops   = frame_min_ops ();
+	bytes = ops * 4;
+	Frame.min_wire = bytes + (bytes + I2C_SMBUS_BLOCK_MAX -1) / I2C_SMBUS_BLOCK_MAX;
+	// 9 clocks per byte + start / stop
+	need = (int)((Frame.wire * 9 + Frame.xfers * 2) * 1000000ULL / I2C_DEFAULT_CLOCK);
+	Frame.need_us = need + FrameExec;
+
+	Total.frames++;
+	Total.min_wire  += Frame.min_wire;
+	Total.frame_ops += ops;
+	printf ("%6lu %10llu %5lu %6lu %6lu %5lu %5lu %8lu %8lu %8lu %8ld\n",
+		Total.frames, Frame.start_us / 1000, Frame.xfers, Frame.wire, Frame.min_wire,
+		Frame.ops, Frame.redundant, Frame.bus_us, Frame.need_us, Frame.elapsed_us,
+		(long)Frame.elapsed_us - (long)Frame.need_us);
+}
+
+//------------------------------------------------------------------------------
+static void trace_rec (const i2c_trace_rec_t *r, const byte_t *data)
+{
+	int wire, stray, i;
+
+	wire = wire_bytes (r, &stray);
+	Total.records++;
+	Total.wire  += wire;
+	Frame.xfers++;
+	Frame.wire  += wire;
+	Frame.bus_us += r->dur_us;
+
+	if (r->status < 0) {
+		Total.failed++;
+		return;
+	}
+	if (r->rw == I2C_SMBUS_READ) {
+		Total.reads++;
+		Total.readback += r->len;
+		return;
+	}
+	Total.writes++;
+	Total.stray += stray;
+
+	// port bytes in bus order
+	switch (r->size) {
+		case	I2C_SMBUS_QUICK:
+			break;
+		case	I2C_SMBUS_BYTE:
+			port_write (r->command, false);
+			break;
+		case	I2C_SMBUS_BLOCK_DATA:
+			port_write (r->command, true);
+			port_write (r->len, true);
+			for (i = 0; i < r->len; i++)
+				port_write (data[i], false);
+			break;
+		default :
+			port_write (r->command, true);
+			for (i = 0; i < r->len; i++)
+				port_write (data[i], false);
+			break;
+	}
+}
+
+//------------------------------------------------------------------------------
+// slave address with the most block writes. (the file is left at the records)
+//------------------------------------------------------------------------------
+static int trace_lcd_addr (FILE *fp)
+{
+	static ulong_t blocks[256];
+	i2c_trace_rec_t r;
+	long pos = ftell (fp);
+	int i, addr = I2C_TRACE_NO_ADDR;
+
+	memset (blocks, 0, sizeof(blocks));
+	while (fread (&r, sizeof(r), 1, fp) == 1) {
+		if (r.len && fseek (fp, r.len, SEEK_CUR))
+			break;
+		if ((r.rw == I2C_SMBUS_WRITE) && (r.size == I2C_SMBUS_BLOCK_DATA))
+			blocks[r.addr]++;
+	}
+	for (i = 0; i < 256; i++) {
+		if (blocks[i] && ((addr == I2C_TRACE_NO_ADDR) || (blocks[i] > blocks[addr])))
+			addr = i;
+	}
+	fseek (fp, pos, SEEK_SET);
+	return addr;
+}
+
+//------------------------------------------------------------------------------
+int i2c_trace_report (const char *path)
+{
+	i2c_trace_hdr_t h;
+	i2c_trace_rec_t r;
+	byte_t data[256];
+	unsigned long long t = 0, end = 0;
+	time_t start;
+	FILE *fp;
+	ulong_t ops;
+	int lcd, stray;
+
+	if ((fp = fopen (path, "rb")) == NULL) {
+		err ("%s : open fail!\n", path);
+		return false;
+	}
+	if ((fread (&h, sizeof(h), 1, fp) != 1) || (h.magic != I2C_TRACE_MAGIC) ||
+		(h.version != I2C_TRACE_VERSION) || (h.rec_size != sizeof(r))) {
+		err ("%s : not an i2c trace.\n", path);
+		fclose (fp);
+		return false;
+	}
+
+	lcd = trace_lcd_addr (fp);
+	memset (&Hd, 0, sizeof(Hd));
+	memset (&Total, 0, sizeof(Total));
+	Hd.addr  = -1;
+	Hd.entry = Hd.display = Hd.function = -1;
+	frame_begin (0);
+
+	printf (" frame   start_ms xfers   wire    min   ops redun   bus_us  need_us  elap_us slack_us\n");
+	while (fread (&r, sizeof(r), 1, fp) == 1) {
+		if (r.len && (fread (data, r.len, 1, fp) != 1))
+			break;
+		t += r.dt_us;
+		if (r.addr != lcd) {
+			Total.other++;
+			Total.other_wire += wire_bytes (&r, &stray);
+			continue;
+		}
+		// bus idle longer than the frame gap : next frame.
+		if (Frame.xfers && (t > end + I2C_TRACE_FRAME_GAP_US)) {
+			frame_end ();
+			frame_begin (t);
+		}
+		trace_rec (&r, data);
+		end = t + r.dur_us;
+		Frame.elapsed_us = end - Frame.start_us;
+	}
+	frame_end ();
+	fclose (fp);
+
+	start = h.sec;
+	ops   = Total.cmds + Total.datas;
+	printf ("\n%s : capture %s", path, ctime (&start));
+	if (lcd != I2C_TRACE_NO_ADDR)
+		printf ("  lcd address   : 0x%02x\n", lcd);
+	printf ("  transactions  : %lu (write %lu, read %lu, failed %lu), %llu.%03llu sec\n",
+		Total.records, Total.writes, Total.reads, Total.failed, end / 1000000, (end / 1000) % 1000);
+	printf ("  other devices : %lu transactions, %lu wire bytes\n",
+		Total.other, Total.other_wire);
+	printf ("  wire bytes    : %lu, smbus command / count (stray port writes) %lu (%lu%%)\n",
+		Total.wire, Total.stray, Total.wire ? Total.stray * 100 / Total.wire : 0);
+	printf ("  readback      : %lu bytes\n", Total.readback);
+	printf ("  lcd ops       : %lu (instruction %lu, data %lu), clears %lu, cursor moves %lu\n",
+		ops, Total.cmds, Total.datas, Total.clears, Total.moves);
+	printf ("  redundant     : same data %lu, cursor moves %lu, blank clears %lu, mode %lu (%lu%%)\n",
+		Total.same_data, Total.same_move, Total.blank_clear, Total.same_mode,
+		ops ? (Total.same_data + Total.same_move + Total.blank_clear + Total.same_mode) * 100 / ops : 0);
+	printf ("  backlight     : %lu glitches (stray bytes)\n", Total.bl_glitch);
+	printf ("  frames        : %lu, minimum %lu lcd ops, %lu wire bytes (%lu%% of the traffic)\n",
+		Total.frames, Total.frame_ops, Total.min_wire,
+		Total.wire ? Total.min_wire * 100 / Total.wire : 0);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
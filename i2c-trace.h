@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 I2C capture trace analyzer. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __I2C_TRACE_H__
+#define __I2C_TRACE_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	Offline report of an i2c_capture_start trace. (i2c-ctl.h)
+	The lcd is the slave address with the most block writes, the records of
+	other addresses (sensors, scan probes) are counted only.
+	The written bytes are PCF8574 port writes, the smbus command / count
+	bytes too (stray). An EN falling edge latches a nibble into the HD44780
+	model (4 bit mode, DDRAM 2 x 40), the decoded operations are checked
+	against the model state :
+		data of the same character, cursor move to the cursor address,
+		clear of a blank screen, mode command of the current mode : redundant
+	Transactions closer than I2C_TRACE_FRAME_GAP_US are one frame. The
+	minimum of a frame : changed cells only (cursor moves where cheaper),
+	2 port bytes per nibble, one address byte per I2C_SMBUS_BLOCK_MAX.
+	need_us : bus bits of the frame at I2C_DEFAULT_CLOCK + clear / home
+	execution, slack = elapsed - need.
+*/
+//------------------------------------------------------------------------------
+#define	I2C_TRACE_FRAME_GAP_US	20000
+#define	HD44780_EXEC_US			37
+#define	HD44780_CLEAR_US		1520
+#define	HD44780_DDRAM_SIZE		0x80
+
+//------------------------------------------------------------------------------
+typedef struct i2c_trace_frame__t {
+	unsigned long long	start_us;		// since the capture start
+	ulong_t		xfers;
+	ulong_t		wire;					// bytes on the bus
+	ulong_t		min_wire;
+	ulong_t		ops;					// HD44780 instructions + data
+	ulong_t		redundant;
+	ulong_t		bus_us;					// transaction time (ioctl)
+	ulong_t		need_us;
+	ulong_t		elapsed_us;
+}	i2c_trace_frame_t;
+
+//------------------------------------------------------------------------------
+extern int	i2c_trace_report	(const char *path);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __I2C_TRACE_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,278 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Tickless idle policy. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include "typedefs.h"
+#include "gpio-ctl.h"
+#include "idle.h"
+
+//------------------------------------------------------------------------------
+static	int				NlFd = -1, UeFd = -1, BtnFd = -1;
+static	ulong_t			TActivity, TState, TReport;
+static	idle_stats_t	Stats;
+static	uint_t			LinkFlags[IDLE_LINK_MAX];
+static	int				WatchFd[IDLE_WATCH_MAX], WatchCount;
+static	int				(*WatchDrain[IDLE_WATCH_MAX])(void);
+
+//------------------------------------------------------------------------------
+static	ulong_t	idle_msec		(void);
+static	int		nl_open			(int proto, uint_t groups);
+static	int		nl_route		(void);
+static	int		nl_uevent		(void);
+		int		idle_open		(const char *chip, const char **buttons, int n);
+		int		idle_watch		(int fd, int (*drain)(void));
+		void	idle_activity	(void);
+		int		idle_expired	(int minutes);
+		void	idle_state		(int state);
+		int		idle_wait		(int msec);
+		int		idle_wait_fd	(int msec, int fd);
+		void	idle_wakeup		(void);
+		void	idle_stats		(idle_stats_t *s);
+		void	idle_report		(bool force);
+
+//------------------------------------------------------------------------------
+static ulong_t idle_msec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+static int nl_open (int proto, uint_t groups)
+{
+	struct sockaddr_nl sa;
+	int fd;
+
+	if ((fd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, proto)) < 0)
+		return -1;
+	memset (&sa, 0, sizeof(sa));
+	sa.nl_family = AF_NETLINK;
+	sa.nl_groups = groups;
+	if (bind (fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+		close (fd);
+		return -1;
+	}
+	return fd;
+}
+
+//------------------------------------------------------------------------------
+// link up / down (flags changed) or ipv4 address. (stats only NEWLINK : no)
+//------------------------------------------------------------------------------
+static int nl_route (void)
+{
+	char buf[8192];
+	struct nlmsghdr *nh;
+	struct ifinfomsg *ifi;
+	uint_t flags;
+	int len, ev = 0;
+
+	while ((len = recv (NlFd, buf, sizeof(buf), 0)) > 0) {
+		for (nh = (struct nlmsghdr *)buf; NLMSG_OK (nh, (uint_t)len); nh = NLMSG_NEXT (nh, len)) {
+			switch (nh->nlmsg_type) {
+				case	RTM_NEWADDR:
+				case	RTM_DELADDR:
+				case	RTM_DELLINK:
+					ev = IDLE_EV_NET;
+					break;
+				case	RTM_NEWLINK:
+					ifi   = NLMSG_DATA (nh);
+					flags = ifi->ifi_flags & (IFF_UP | IFF_RUNNING);
+					if ((ifi->ifi_index < 0) || (ifi->ifi_index >= IDLE_LINK_MAX)) {
+						ev = IDLE_EV_NET;
+						break;
+					}
+					if (LinkFlags[ifi->ifi_index] != (flags | 0x80000000))
+						ev = IDLE_EV_NET;
+					LinkFlags[ifi->ifi_index] = flags | 0x80000000;
+					break;
+				default :
+					break;
+			}
+		}
+	}
+	return ev;
+}
+
+//------------------------------------------------------------------------------
+// "ACTION=add\0SUBSYSTEM=usb\0DEVTYPE=usb_device\0 ..." (usb device, usblp)
+//------------------------------------------------------------------------------
+static int nl_uevent (void)
+{
+	char buf[4096], *p;
+	bool action, usb;
+	int len, ev = 0;
+
+	while ((len = recv (UeFd, buf, sizeof(buf) -1, 0)) > 0) {
+		buf[len] = 0;
+		action = usb = false;
+		for (p = buf; p < buf + len; p += strlen (p) + 1) {
+			if (!strcmp (p, "ACTION=add") || !strcmp (p, "ACTION=remove"))
+				action = true;
+			if (!strcmp (p, "SUBSYSTEM=usbmisc") || !strcmp (p, "DEVTYPE=usb_device"))
+				usb = true;
+		}
+		if (action && usb)
+			ev = IDLE_EV_HOTPLUG;
+	}
+	return ev;
+}
+
+//------------------------------------------------------------------------------
+// buttons : gpio line names, NULL : no button.
+//------------------------------------------------------------------------------
+int idle_open (const char *chip, const char **buttons, int n)
+{
+	NlFd = nl_open (NETLINK_ROUTE, RTMGRP_LINK | RTMGRP_IPV4_IFADDR);
+	UeFd = nl_open (NETLINK_KOBJECT_UEVENT, 1);
+	if (buttons && ((BtnFd = gpio_open_events (chip, buttons, n)) == false))
+		BtnFd = -1;
+	if ((NlFd < 0) || (UeFd < 0))
+		err ("netlink open fail! (%s)\n", strerror (errno));
+
+	TActivity = TState = TReport = idle_msec ();
+	info ("idle : netlink %s, uevent %s, buttons %s\n",
+		NlFd < 0 ? "no" : "yes", UeFd < 0 ? "no" : "yes", BtnFd < 0 ? "no" : "yes");
+	return true;
+}
+
+//------------------------------------------------------------------------------
+int idle_watch (int fd, int (*drain)(void))
+{
+	if ((fd < 0) || (WatchCount >= IDLE_WATCH_MAX))
+		return false;
+	WatchFd   [WatchCount] = fd;
+	WatchDrain[WatchCount] = drain;
+	WatchCount++;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// button / state change.
+//------------------------------------------------------------------------------
+void idle_activity (void)
+{
+	TActivity = idle_msec ();
+}
+
+//------------------------------------------------------------------------------
+int idle_expired (int minutes)
+{
+	return minutes && (idle_msec () - TActivity >= minutes * 60000UL);
+}
+
+//------------------------------------------------------------------------------
+void idle_state (int state)
+{
+	ulong_t now = idle_msec ();
+
+	if (state == Stats.state)
+		return;
+	Stats.msec[Stats.state] += now - TState;
+	TState = now;
+	Stats.state = state;
+	idle_report (true);
+}
+
+//------------------------------------------------------------------------------
+// sleep until msec passed or an event. return events. (0 : timeout)
+//------------------------------------------------------------------------------
+int idle_wait (int msec)
+{
+	return idle_wait_fd (msec, -1);
+}
+
+//------------------------------------------------------------------------------
+// idle_wait, also ends when fd is readable. (IDLE_EV_FD, fd < 0 : none)
+//------------------------------------------------------------------------------
+int idle_wait_fd (int msec, int fd)
+{
+	struct pollfd pfd[4 + IDLE_WATCH_MAX];
+	ulong_t end = idle_msec () + msec, now;
+	int n = 0, i, w, ev = 0;
+
+	if (NlFd  >= 0)	{ pfd[n].fd = NlFd;		pfd[n++].events = POLLIN; }
+	if (UeFd  >= 0)	{ pfd[n].fd = UeFd;		pfd[n++].events = POLLIN; }
+	if (BtnFd >= 0)	{ pfd[n].fd = BtnFd;	pfd[n++].events = POLLIN; }
+	if (fd    >= 0)	{ pfd[n].fd = fd;		pfd[n++].events = POLLIN; }
+	for (w = 0; w < WatchCount; w++)
+		{ pfd[n].fd = WatchFd[w];	pfd[n++].events = POLLIN; }
+
+	while (!ev && ((now = idle_msec ()) < end)) {
+		if (poll (pfd, n, end - now) < 0)
+			continue;
+		idle_wakeup ();
+		for (i = 0; i < n; i++) {
+			if (!(pfd[i].revents & POLLIN))
+				continue;
+			if (pfd[i].fd == NlFd)	ev |= nl_route ();
+			if (pfd[i].fd == UeFd)	ev |= nl_uevent ();
+			if ((pfd[i].fd == BtnFd) && gpio_read_events (BtnFd))
+				ev |= IDLE_EV_BUTTON;
+			if (pfd[i].fd == fd)
+				ev |= IDLE_EV_FD;
+			for (w = 0; w < WatchCount; w++) {
+				if ((pfd[i].fd == WatchFd[w]) && WatchDrain[w] ())
+					ev |= IDLE_EV_NET;
+			}
+		}
+	}
+	idle_report (false);
+	return ev;
+}
+
+//------------------------------------------------------------------------------
+// wakeup of another timer of the loop (clock page tick) or of a thread.
+//------------------------------------------------------------------------------
+void idle_wakeup (void)
+{
+	__sync_fetch_and_add (&Stats.wakeups[Stats.state], 1);
+}
+
+//------------------------------------------------------------------------------
+void idle_stats (idle_stats_t *s)
+{
+	*s = Stats;
+	s->msec[Stats.state] += idle_msec () - TState;
+}
+
+//------------------------------------------------------------------------------
+// wakeups per second of each state. (state change, IDLE_REPORT_SEC)
+//------------------------------------------------------------------------------
+void idle_report (bool force)
+{
+	idle_stats_t s;
+	ulong_t now = idle_msec ();
+	int i, rate[IDLE_STATES];
+
+	if (!force && (now - TReport < IDLE_REPORT_SEC * 1000UL))
+		return;
+	TReport = now;
+
+	idle_stats (&s);
+	// wakeups per 1000 sec
+	for (i = 0; i < IDLE_STATES; i++)
+		rate[i] = s.msec[i] ? (int)((unsigned long long)s.wakeups[i] * 1000000 / s.msec[i]) : 0;
+	info ("idle : %s, active %d.%03d wakeups/s (%lu s), idle %d.%03d wakeups/s (%lu s)\n",
+		s.state == IDLE_IDLE ? "idle" : "active",
+		rate[IDLE_ACTIVE] / 1000, rate[IDLE_ACTIVE] % 1000, s.msec[IDLE_ACTIVE] / 1000,
+		rate[IDLE_IDLE]   / 1000, rate[IDLE_IDLE]   % 1000, s.msec[IDLE_IDLE]   / 1000);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Tickless idle policy. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __IDLE_H__
+#define __IDLE_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	The main loop sleeps in idle_wait. The wait ends early on an event :
+		rtnetlink : link up / down, ipv4 address added / removed
+		uevent    : usb device / usblp added or removed (printer hotplug)
+		buttons   : gpio line falling edge
+		idle_watch: fd of another event source (nl80211), drained by its
+		            callback, an event if the callback returns true (NET)
+		idle_wait_fd: one more fd of the caller (clock page timerfd), not
+		            read here (IDLE_EV_FD)
+	No button press or state change (idle_activity) for the idle minutes :
+	backlight off, no page rotation, no ping. The loop only wakes for the
+	events and a network probe every IDLE_PROBE_SEC.
+	Every wakeup is counted in the current state, the main loop ones and
+	those of the threads (idle_wakeup : display server, logger, fleet
+	collector, ledbar, printer workers). (idle_report)
+*/
+//------------------------------------------------------------------------------
+#define	IDLE_PROBE_SEC		300			// network probe while idle
+#define	IDLE_REPORT_SEC		600
+#define	IDLE_LINK_MAX		16			// link flags cache (ifindex)
+#define	IDLE_WATCH_MAX		2
+
+enum {
+	IDLE_ACTIVE = 0,
+	IDLE_IDLE,
+	IDLE_STATES,
+};
+
+#define	IDLE_EV_NET			0x01
+#define	IDLE_EV_BUTTON		0x02
+#define	IDLE_EV_HOTPLUG		0x04
+#define	IDLE_EV_FD			0x08		// idle_wait_fd : the fd is readable
+
+//------------------------------------------------------------------------------
+typedef struct idle_stats__t {
+	int			state;
+	ulong_t		wakeups[IDLE_STATES];
+	ulong_t		msec[IDLE_STATES];		// time in the state
+}	idle_stats_t;
+
+//------------------------------------------------------------------------------
+extern int	idle_open		(const char *chip, const char **buttons, int n);
+extern int	idle_watch		(int fd, int (*drain)(void));
+extern void	idle_activity	(void);
+extern int	idle_expired	(int minutes);
+extern void	idle_state		(int state);
+extern int	idle_wait		(int msec);
+extern int	idle_wait_fd	(int msec, int fd);
+extern void	idle_wakeup		(void);
+extern void	idle_stats		(idle_stats_t *s);
+extern void	idle_report		(bool force);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __IDLE_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -22,6 +22,12 @@
 #define PORT_LCD_D5     3
 #define PORT_LCD_D6     1
 #define PORT_LCD_D7     4
+
+//------------------------------------------------------------------------------
+// GPIO character device line names of the same pins. (header pin number)
+// order : RS, E, D4, D5, D6, D7 (i2c-lcd.h LCD_GPIO_xx)
+//------------------------------------------------------------------------------
+#define GPIO_LCD_NAMES  { "PIN_7", "PIN_11", "PIN_13", "PIN_15", "PIN_12", "PIN_16" }
  
 //------------------------------------------------------------------------------
 //
@@ -31,6 +37,9 @@
 #define PORT_BUTTON1	5
 #define PORT_BUTTON2	6
 
+// gpio chardev line names of the same pins. (edge events, idle wakeup)
+#define GPIO_BUTTON_NAMES	{ "PIN_18", "PIN_22" }
+
 //------------------------------------------------------------------------------
 //
 // LED:
@@ -47,6 +56,12 @@
 #define PORT_LED6       26
 #define PORT_LED5       27
 
+// bar order (left to right) and the gpio chardev line names of the same pins.
+#define PORT_LED_BAR    { PORT_LED1, PORT_LED2, PORT_LED3, PORT_LED4, \
+                          PORT_LED7, PORT_LED6, PORT_LED5 }
+#define GPIO_LED_NAMES  { "PIN_29", "PIN_31", "PIN_33", "PIN_35", \
+                          "PIN_26", "PIN_32", "PIN_36" }
+
 //------------------------------------------------------------------------------
 //
 // SPI:
@@ -0,0 +1,386 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 IO Shield LED bar meter. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "typedefs.h"
+#include "idle.h"
+#include "ledbar.h"
+
+//------------------------------------------------------------------------------
+// on time of each level in the period (permille, perceived brightness steps)
+//------------------------------------------------------------------------------
+static const int LEDBAR_DUTY[LEDBAR_LEVELS] = {
+	0, 20, 50, 100, 180, 320, 560, 1000
+};
+
+#define	LEDBAR_MASK		((1UL << LEDBAR_COUNT) - 1)
+
+//------------------------------------------------------------------------------
+static	pthread_t		Thread;
+static	pthread_mutex_t	Lock = PTHREAD_MUTEX_INITIALIZER;
+static	pthread_cond_t	Cond;
+static	bool			Run = false;
+
+static	int				LedFd;
+static	int				(*LedSet)(int fd, ulong_t bits, ulong_t mask);
+static	int				Mode;
+static	byte_t			Levels[LEDBAR_COUNT];
+static	bool			Changed;
+static	bool			Idle;			// all off, no sample
+static	ledbar_stats_t	Stats;
+
+// link meter source
+static	int				RxFd = -1, TxFd = -1;
+static	ulong_t			LinkBits;		// link speed (bps)
+static	ulong_t			RxLast, TxLast, TSample;
+// probe history (bit 0 : newest probe ok)
+static	uint_t			Health, HealthCount;
+
+//------------------------------------------------------------------------------
+static	ulong_t	ledbar_usec		(void);
+static	void	ledbar_sleep	(ulong_t usec);
+static	int		log2_q8			(ulong_t v);
+static	void	meter_levels	(int permille, byte_t *levels);
+static	int		read_counter	(int fd, ulong_t *v);
+static	void	ledbar_sample	(void);
+static	void	*ledbar_thread	(void *arg);
+		int		ledbar_start	(int fd, int (*set)(int fd, ulong_t bits, ulong_t mask),
+									int mode, const char *ifname);
+		void	ledbar_stop		(void);
+		void	ledbar_set		(const byte_t *levels);
+		void	ledbar_meter	(int permille);
+		void	ledbar_link_speed(int mbps);
+		void	ledbar_health	(bool ok);
+		void	ledbar_idle		(bool idle);
+		void	ledbar_stats	(ledbar_stats_t *s);
+
+//------------------------------------------------------------------------------
+static ulong_t ledbar_usec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+// absolute monotonic sleep (no drift over the periods)
+//------------------------------------------------------------------------------
+static void ledbar_sleep (ulong_t usec)
+{
+	struct timespec ts;
+
+	ts.tv_sec  = usec / 1000000;
+	ts.tv_nsec = (usec % 1000000) * 1000;
+	while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+	Stats.wakeups++;
+	idle_wakeup ();
+}
+
+//------------------------------------------------------------------------------
+// log2(v) * 256 (linear between the powers of two)
+//------------------------------------------------------------------------------
+static int log2_q8 (ulong_t v)
+{
+	int msb = 0;
+
+	if (!v)
+		return 0;
+	while (v >> (msb + 1))
+		msb++;
+	if (msb >= 8)
+		return msb * 256 + ((v >> (msb - 8)) & 0xFF);
+	return msb * 256 + ((v << (8 - msb)) & 0xFF);
+}
+
+//------------------------------------------------------------------------------
+// bar graph, the top LED shows the remainder as brightness.
+//------------------------------------------------------------------------------
+static void meter_levels (int permille, byte_t *levels)
+{
+	int full = LEDBAR_LEVELS - 1, units, i;
+
+	if (permille < 0)		permille = 0;
+	if (permille > 1000)	permille = 1000;
+
+	units = (permille * LEDBAR_COUNT * full + 500) / 1000;
+	for (i = 0; i < LEDBAR_COUNT; i++, units -= full)
+		levels[i] = units >= full ? full : (units > 0 ? units : 0);
+}
+
+//------------------------------------------------------------------------------
+static int read_counter (int fd, ulong_t *v)
+{
+	char buf[32];
+	int len;
+
+	if ((fd < 0) || ((len = pread (fd, buf, sizeof(buf) - 1, 0)) <= 0))
+		return 0;
+	buf[len] = 0;
+	*v = strtoul (buf, NULL, 10);
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// (Lock held) meter source -> Levels
+//------------------------------------------------------------------------------
+static void ledbar_sample (void)
+{
+	byte_t levels[LEDBAR_COUNT];
+	ulong_t rx, tx, now = ledbar_usec (), bps;
+	int permille, i;
+
+	switch (Mode) {
+	case	LEDBAR_LINK:
+		if (!read_counter (RxFd, &rx) || !read_counter (TxFd, &tx))
+			return;
+		if (TSample && (now > TSample) && (LinkBits > LEDBAR_LINK_MIN)) {
+			// busier direction, bytes -> bits per second
+			bps = (rx - RxLast) > (tx - TxLast) ? (rx - RxLast) : (tx - TxLast);
+			bps = bps * 8 * 1000000 / (now - TSample);
+			permille = bps <= LEDBAR_LINK_MIN ? 0 :
+				(log2_q8 (bps) - log2_q8 (LEDBAR_LINK_MIN)) * 1000 /
+				(log2_q8 (LinkBits) - log2_q8 (LEDBAR_LINK_MIN));
+			if (permille > 1000)
+				permille = 1000;
+			// meter ballistics : fast attack, slow release
+			if (permille > Stats.meter)
+				Stats.meter = permille;
+			else
+				Stats.meter -= (Stats.meter - permille + 3) / 4;
+			meter_levels (Stats.meter, levels);
+			if (memcmp (levels, Levels, sizeof(Levels))) {
+				memcpy (Levels, levels, sizeof(Levels));
+				Changed = true;
+			}
+		}
+		RxLast = rx;	TxLast = tx;	TSample = now;
+		break;
+	case	LEDBAR_HEALTH:
+		// newest probe left, older ones dimmer. failed probe : off
+		for (i = 0; i < LEDBAR_COUNT; i++)
+			levels[i] = ((uint_t)i < HealthCount) && (Health & (1 << i)) ?
+						(LEDBAR_LEVELS - 1 - i) : 0;
+		if (memcmp (levels, Levels, sizeof(Levels))) {
+			memcpy (Levels, levels, sizeof(Levels));
+			Changed = true;
+		}
+		break;
+	default :
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------
+static void *ledbar_thread (void *arg)
+{
+	byte_t levels[LEDBAR_COUNT];
+	ulong_t t_period, t_sample, on, off[LEDBAR_LEVELS], lit = 0, now;
+	struct timespec ts;
+	int i;
+	(void)arg;
+
+	t_period = t_sample = ledbar_usec ();
+	pthread_mutex_lock (&Lock);
+	while (Run) {
+		now = ledbar_usec ();
+		if (!Idle && (now >= t_sample)) {
+			ledbar_sample ();
+			t_sample = now + LEDBAR_SAMPLE_MS * 1000;
+		}
+		if (Idle)
+			memset (levels, 0, sizeof(levels));
+		else
+			memcpy (levels, Levels, sizeof(levels));
+		Changed = false;
+
+		// group the LEDs by level : one line set per group.
+		for (i = 0, on = 0; i < LEDBAR_LEVELS; i++)
+			off[i] = 0;
+		for (i = 0; i < LEDBAR_COUNT; i++) {
+			if (levels[i])
+				on |= 1UL << i;
+			off[levels[i]] |= 1UL << i;
+		}
+
+		// all on or off : no edges, wait for a change or the next sample.
+		if (!(on & ~off[LEDBAR_LEVELS - 1])) {
+			if (lit != on) {
+				LedSet (LedFd, on, LEDBAR_MASK);
+				Stats.sets++;
+				lit = on;
+			}
+			if ((Mode == LEDBAR_OFF) || Idle)
+				t_sample = now + 3600 * 1000000UL;
+			ts.tv_sec  = t_sample / 1000000;
+			ts.tv_nsec = (t_sample % 1000000) * 1000;
+			while (Run && !Changed &&
+				(pthread_cond_timedwait (&Cond, &Lock, &ts) != ETIMEDOUT))
+				;
+			Stats.wakeups++;
+			idle_wakeup ();
+			t_period = ledbar_usec ();
+			continue;
+		}
+		pthread_mutex_unlock (&Lock);
+
+		// one period : on edge, then the off edge of each dimmed group.
+		if (t_period + LEDBAR_PERIOD_US < now)
+			t_period = now;
+		LedSet (LedFd, on, LEDBAR_MASK);
+		Stats.sets++;
+		lit = on;
+		for (i = 1; i < LEDBAR_LEVELS - 1; i++) {
+			if (!off[i])
+				continue;
+			ledbar_sleep (t_period + LEDBAR_PERIOD_US * LEDBAR_DUTY[i] / 1000);
+			lit &= ~off[i];
+			LedSet (LedFd, lit, off[i]);
+			Stats.sets++;
+		}
+		t_period += LEDBAR_PERIOD_US;
+		ledbar_sleep (t_period);
+		Stats.periods++;
+
+		pthread_mutex_lock (&Lock);
+	}
+	pthread_mutex_unlock (&Lock);
+
+	LedSet (LedFd, 0, LEDBAR_MASK);
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// set : line writer (gpio_set or a wiringPi writer), ifname : LEDBAR_LINK source
+//------------------------------------------------------------------------------
+int ledbar_start (int fd, int (*set)(int fd, ulong_t bits, ulong_t mask),
+					int mode, const char *ifname)
+{
+	pthread_condattr_t attr;
+	char path[128];
+
+	if (Run || (set == NULL))
+		return 0;
+
+	LedFd  = fd;
+	LedSet = set;
+	Mode   = mode;
+	memset (Levels, 0, sizeof(Levels));
+	memset (&Stats, 0, sizeof(Stats));
+
+	if ((mode == LEDBAR_LINK) && ifname) {
+		snprintf (path, sizeof(path), "/sys/class/net/%s/statistics/rx_bytes", ifname);
+		RxFd = open (path, O_RDONLY);
+		snprintf (path, sizeof(path), "/sys/class/net/%s/statistics/tx_bytes", ifname);
+		TxFd = open (path, O_RDONLY);
+		if ((RxFd < 0) || (TxFd < 0))
+			err ("%s : interface statistics open fail!\n", ifname);
+	}
+
+	pthread_condattr_init (&attr);
+	pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+	pthread_cond_init (&Cond, &attr);
+	pthread_condattr_destroy (&attr);
+
+	Run = true;
+	if (pthread_create (&Thread, NULL, ledbar_thread, NULL)) {
+		err ("ledbar thread create fail!\n");
+		Run = false;
+		return 0;
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+void ledbar_stop (void)
+{
+	if (!Run)
+		return;
+
+	pthread_mutex_lock (&Lock);
+	Run = false;
+	pthread_cond_signal (&Cond);
+	pthread_mutex_unlock (&Lock);
+	pthread_join (Thread, NULL);
+
+	if (RxFd >= 0)	close (RxFd);
+	if (TxFd >= 0)	close (TxFd);
+	RxFd = TxFd = -1;
+}
+
+//------------------------------------------------------------------------------
+// direct levels (LEDBAR_OFF mode)
+//------------------------------------------------------------------------------
+void ledbar_set (const byte_t *levels)
+{
+	int i;
+
+	pthread_mutex_lock (&Lock);
+	for (i = 0; i < LEDBAR_COUNT; i++)
+		Levels[i] = levels[i] < LEDBAR_LEVELS ? levels[i] : LEDBAR_LEVELS - 1;
+	Changed = true;
+	pthread_cond_signal (&Cond);
+	pthread_mutex_unlock (&Lock);
+}
+
+//------------------------------------------------------------------------------
+void ledbar_meter (int permille)
+{
+	byte_t levels[LEDBAR_COUNT];
+
+	meter_levels (permille, levels);
+	ledbar_set (levels);
+}
+
+//------------------------------------------------------------------------------
+void ledbar_link_speed (int mbps)
+{
+	pthread_mutex_lock (&Lock);
+	LinkBits = mbps > 0 ? (ulong_t)mbps * 1000000 : 0;
+	pthread_mutex_unlock (&Lock);
+}
+
+//------------------------------------------------------------------------------
+void ledbar_health (bool ok)
+{
+	pthread_mutex_lock (&Lock);
+	Health = (Health << 1) | (ok ? 1 : 0);
+	if (HealthCount < LEDBAR_COUNT)
+		HealthCount++;
+	pthread_mutex_unlock (&Lock);
+}
+
+//------------------------------------------------------------------------------
+// idle : LEDs off, the thread sleeps until ledbar_idle (false).
+//------------------------------------------------------------------------------
+void ledbar_idle (bool idle)
+{
+	pthread_mutex_lock (&Lock);
+	Idle    = idle;
+	Changed = true;
+	pthread_cond_signal (&Cond);
+	pthread_mutex_unlock (&Lock);
+}
+
+//------------------------------------------------------------------------------
+void ledbar_stats (ledbar_stats_t *s)
+{
+	pthread_mutex_lock (&Lock);
+	*s = Stats;
+	pthread_mutex_unlock (&Lock);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
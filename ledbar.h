@@ -0,0 +1,56 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 IO Shield LED bar meter. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __LEDBAR_H__
+#define __LEDBAR_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	Software PWM : every period all lit LEDs turn on with one line set and
+	each brightness group turns off with one more line set. The thread
+	sleeps on absolute timers between the edges. When no LED is dimmed
+	there is no edge at all, the thread only wakes for the meter sample.
+
+	line bit n = LED n of the bar. (left to right)
+*/
+//------------------------------------------------------------------------------
+#define	LEDBAR_COUNT		7
+#define	LEDBAR_LEVELS		8		// 0(off) ~ 7(full on)
+#define	LEDBAR_PERIOD_US	10000	// 100Hz
+#define	LEDBAR_SAMPLE_MS	200		// meter source sample interval
+#define	LEDBAR_LINK_MIN		10000	// bps, meter bottom (log scale)
+
+enum {
+	LEDBAR_OFF = 0,
+	LEDBAR_LINK,		// link utilization (rx / tx of the interface)
+	LEDBAR_HEALTH,		// last LEDBAR_COUNT network probe results
+};
+
+//------------------------------------------------------------------------------
+typedef struct ledbar_stats__t {
+	ulong_t		periods;
+	ulong_t		wakeups;
+	ulong_t		sets;
+	// meter value (permille)
+	int			meter;
+}	ledbar_stats_t;
+
+//------------------------------------------------------------------------------
+extern int	ledbar_start		(int fd, int (*set)(int fd, ulong_t bits, ulong_t mask),
+									int mode, const char *ifname);
+extern void	ledbar_stop			(void);
+extern void	ledbar_set			(const byte_t *levels);
+extern void	ledbar_meter		(int permille);
+extern void	ledbar_link_speed	(int mbps);
+extern void	ledbar_health		(bool ok);
+extern void	ledbar_idle			(bool idle);
+extern void	ledbar_stats		(ledbar_stats_t *s);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __LEDBAR_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,332 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Passive LLDP / CDP neighbor. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+#include "typedefs.h"
+#include "lldp.h"
+
+#ifndef ETH_P_LLDP
+#define	ETH_P_LLDP			0x88cc
+#endif
+
+//------------------------------------------------------------------------------
+// LLDP TLV types, CDP TLV types.
+enum {
+	LLDP_TLV_END = 0,
+	LLDP_TLV_CHASSIS_ID,
+	LLDP_TLV_PORT_ID,
+	LLDP_TLV_TTL,
+	LLDP_TLV_PORT_DESC,
+	LLDP_TLV_SYSTEM_NAME,
+};
+#define	LLDP_SUB_MAC		3			// port id subtype, chassis : 4
+#define	CDP_TLV_DEVICE_ID	0x0001
+#define	CDP_TLV_PORT_ID		0x0003
+#define	CDP_SNAP_OFFSET		14			// 802.3 length frame, LLC/SNAP
+#define	CDP_HDR_OFFSET		22
+
+//------------------------------------------------------------------------------
+static	int			Fd = -1;
+static	byte_t		*Ring = NULL;
+static	int			Block;				// next block to check
+static	lldp_t		Cur;
+
+static const byte_t	LldpMcast[ETH_ALEN] = { 0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e };
+static const byte_t	CdpMcast [ETH_ALEN] = { 0x01, 0x00, 0x0c, 0xcc, 0xcc, 0xcc };
+
+//------------------------------------------------------------------------------
+// ethertype 0x88cc, or length frame AA AA 03 00-00-0C 20-00. (accept LLDP_SNAPLEN)
+// own frames out (lldpd of the board) : not a neighbor.
+//------------------------------------------------------------------------------
+static struct sock_filter Filter[] = {
+	BPF_STMT (BPF_LD  | BPF_W | BPF_ABS, SKF_AD_OFF + SKF_AD_PKTTYPE),
+	BPF_JUMP (BPF_JMP | BPF_JEQ | BPF_K, PACKET_OUTGOING, 8, 0),
+	BPF_STMT (BPF_LD  | BPF_H | BPF_ABS, 12),
+	BPF_JUMP (BPF_JMP | BPF_JEQ | BPF_K, ETH_P_LLDP, 5, 0),
+	BPF_JUMP (BPF_JMP | BPF_JGT | BPF_K, ETH_DATA_LEN, 5, 0),
+	BPF_STMT (BPF_LD  | BPF_W | BPF_ABS, CDP_SNAP_OFFSET),
+	BPF_JUMP (BPF_JMP | BPF_JEQ | BPF_K, 0xaaaa0300, 0, 3),
+	BPF_STMT (BPF_LD  | BPF_W | BPF_ABS, CDP_SNAP_OFFSET + 4),
+	BPF_JUMP (BPF_JMP | BPF_JEQ | BPF_K, 0x000c2000, 0, 1),
+	BPF_STMT (BPF_RET | BPF_K, LLDP_SNAPLEN),
+	BPF_STMT (BPF_RET | BPF_K, 0),
+};
+
+//------------------------------------------------------------------------------
+static	int		set_name		(char *dst, const byte_t *src, int len, bool mac);
+static	int		parse_lldp		(const byte_t *p, int len);
+static	int		parse_cdp		(const byte_t *p, int len);
+static	int		parse_frame		(const byte_t *p, int len);
+static	int		join_mcast		(int ifindex, const byte_t *addr);
+		int		lldp_open		(const char *ifname);
+		void	lldp_close		(void);
+		int		lldp_event_fd	(void);
+		int		lldp_events		(void);
+		int		lldp_neighbor	(lldp_t *n);
+
+//------------------------------------------------------------------------------
+// text (or mac) of the frame into the neighbor, only if different. (return changed)
+//------------------------------------------------------------------------------
+static int set_name (char *dst, const byte_t *src, int len, bool mac)
+{
+	char buf[LLDP_NAME_MAX +1];
+
+	if (mac && (len == ETH_ALEN)) {
+		snprintf (buf, sizeof(buf), "%02x%02x.%02x%02x.%02x%02x",
+			src[0], src[1], src[2], src[3], src[4], src[5]);
+		src = (const byte_t *)buf;
+		len = strlen (buf);
+	}
+	if (len > LLDP_NAME_MAX)
+		len = LLDP_NAME_MAX;
+	if (!strncmp (dst, (const char *)src, len) && (dst[len] == 0))
+		return false;
+	memmove (dst, src, len);
+	dst[len] = 0;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// TLV : 7 bit type, 9 bit length. (p : after the ethernet header)
+//------------------------------------------------------------------------------
+static int parse_lldp (const byte_t *p, int len)
+{
+	const byte_t *chassis = NULL, *port = NULL, *desc = NULL, *name = NULL;
+	int clen = 0, plen = 0, dlen = 0, nlen = 0, type, tlen, ttl = 0, changed;
+
+	while (len >= 2) {
+		type = p[0] >> 1;
+		tlen = ((p[0] & 1) << 8) | p[1];
+		p += 2;	len -= 2;
+		if ((type == LLDP_TLV_END) || (tlen > len))
+			break;
+		switch (type) {
+			case	LLDP_TLV_CHASSIS_ID:	chassis = p;	clen = tlen;	break;
+			case	LLDP_TLV_PORT_ID:		port    = p;	plen = tlen;	break;
+			case	LLDP_TLV_PORT_DESC:		desc    = p;	dlen = tlen;	break;
+			case	LLDP_TLV_SYSTEM_NAME:	name    = p;	nlen = tlen;	break;
+			case	LLDP_TLV_TTL:
+				if (tlen >= 2)
+					ttl = (p[0] << 8) | p[1];
+				break;
+		}
+		p += tlen;	len -= tlen;
+	}
+	// chassis, port id, ttl are mandatory. (first byte : subtype)
+	if (!chassis || (clen < 2) || !port || (plen < 2))
+		return false;
+
+	changed = (Cur.proto != 'L');
+	Cur.proto = 'L';
+	if (name)
+		changed |= set_name (Cur.system, name, nlen, false);
+	else
+		changed |= set_name (Cur.system, chassis + 1, clen - 1, chassis[0] == 4);
+	// mac port id : the description reads better.
+	if ((port[0] == LLDP_SUB_MAC) && desc)
+		changed |= set_name (Cur.port, desc, dlen, false);
+	else
+		changed |= set_name (Cur.port, port + 1, plen - 1, port[0] == LLDP_SUB_MAC);
+	Cur.expire = time (NULL) + ttl;
+	return changed;
+}
+
+//------------------------------------------------------------------------------
+// header : version, ttl, checksum. TLV : 16 bit type, 16 bit length. (with header)
+//------------------------------------------------------------------------------
+static int parse_cdp (const byte_t *p, int len)
+{
+	const byte_t *dev = NULL, *port = NULL;
+	int dlen = 0, plen = 0, type, tlen, ttl, changed;
+
+	if (len < 4)
+		return false;
+	ttl = p[1];
+	p += 4;	len -= 4;
+	while (len >= 4) {
+		type = (p[0] << 8) | p[1];
+		tlen = (p[2] << 8) | p[3];
+		if ((tlen < 4) || (tlen > len))
+			break;
+		if (type == CDP_TLV_DEVICE_ID)	{ dev  = p + 4;	dlen = tlen - 4; }
+		if (type == CDP_TLV_PORT_ID)	{ port = p + 4;	plen = tlen - 4; }
+		p += tlen;	len -= tlen;
+	}
+	if (!dev || !port)
+		return false;
+
+	changed = (Cur.proto != 'C');
+	Cur.proto = 'C';
+	changed |= set_name (Cur.system, dev,  dlen, false);
+	changed |= set_name (Cur.port,   port, plen, false);
+	Cur.expire = time (NULL) + ttl;
+	return changed;
+}
+
+//------------------------------------------------------------------------------
+// ethernet frame of the ring. (the filter passed LLDP / CDP only)
+//------------------------------------------------------------------------------
+static int parse_frame (const byte_t *p, int len)
+{
+	int changed;
+
+	if (len < ETH_HLEN)
+		return false;
+	Cur.frames++;
+	if (((p[12] << 8) | p[13]) == ETH_P_LLDP)
+		changed = parse_lldp (p + ETH_HLEN, len - ETH_HLEN);
+	else if (len > CDP_HDR_OFFSET)
+		changed = parse_cdp (p + CDP_HDR_OFFSET, len - CDP_HDR_OFFSET);
+	else
+		changed = false;
+
+	if (changed) {
+		Cur.changes++;
+		info ("neighbor %s, port %s (%s)\n", Cur.system, Cur.port,
+				Cur.proto == 'L' ? "lldp" : "cdp");
+	}
+	return changed;
+}
+
+//------------------------------------------------------------------------------
+static int join_mcast (int ifindex, const byte_t *addr)
+{
+	struct packet_mreq mr;
+
+	memset (&mr, 0, sizeof(mr));
+	mr.mr_ifindex = ifindex;
+	mr.mr_type    = PACKET_MR_MULTICAST;
+	mr.mr_alen    = ETH_ALEN;
+	memcpy (mr.mr_address, addr, ETH_ALEN);
+	return !setsockopt (Fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mr, sizeof(mr));
+}
+
+//------------------------------------------------------------------------------
+// filter before bind : no unfiltered frame gets in the ring.
+//------------------------------------------------------------------------------
+int lldp_open (const char *ifname)
+{
+	struct sock_fprog prog = { sizeof(Filter) / sizeof(Filter[0]), Filter };
+	struct tpacket_req3 req;
+	struct sockaddr_ll sa;
+	int ver = TPACKET_V3, ifindex;
+
+	lldp_close ();
+	if ((ifindex = if_nametoindex (ifname)) == 0)
+		return false;
+	// protocol 0 : nothing received until bind.
+	if ((Fd = socket (AF_PACKET, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, 0)) < 0) {
+		err ("%s : packet socket fail!\n", ifname);
+		return false;
+	}
+	memset (&req, 0, sizeof(req));
+	req.tp_block_size       = LLDP_BLOCK_SIZE;
+	req.tp_block_nr         = LLDP_BLOCK_NR;
+	req.tp_frame_size       = LLDP_FRAME_SIZE;
+	req.tp_frame_nr         = LLDP_BLOCK_SIZE / LLDP_FRAME_SIZE * LLDP_BLOCK_NR;
+	req.tp_retire_blk_tov   = LLDP_BLOCK_TOV_MS;
+
+	if (setsockopt (Fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) ||
+		setsockopt (Fd, SOL_PACKET, PACKET_VERSION, &ver, sizeof(ver)) ||
+		setsockopt (Fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)))
+		goto out;
+	Ring = mmap (NULL, LLDP_BLOCK_SIZE * LLDP_BLOCK_NR, PROT_READ | PROT_WRITE,
+				MAP_SHARED, Fd, 0);
+	if (Ring == MAP_FAILED) {
+		Ring = NULL;
+		goto out;
+	}
+
+	memset (&sa, 0, sizeof(sa));
+	sa.sll_family   = AF_PACKET;
+	sa.sll_protocol = htons (ETH_P_ALL);
+	sa.sll_ifindex  = ifindex;
+	if (bind (Fd, (struct sockaddr *)&sa, sizeof(sa)))
+		goto out;
+	if (!join_mcast (ifindex, LldpMcast) || !join_mcast (ifindex, CdpMcast))
+		warn ("%s : lldp / cdp multicast join fail!\n", ifname);
+
+	info ("%s : lldp / cdp listener, ring %d x %d\n", ifname, LLDP_BLOCK_NR, LLDP_BLOCK_SIZE);
+	return true;
+out:
+	err ("%s : lldp ring setup fail!\n", ifname);
+	lldp_close ();
+	return false;
+}
+
+//------------------------------------------------------------------------------
+void lldp_close (void)
+{
+	if (Ring)
+		munmap (Ring, LLDP_BLOCK_SIZE * LLDP_BLOCK_NR);
+	if (Fd >= 0)
+		close (Fd);
+	Ring  = NULL;
+	Fd    = -1;
+	Block = 0;
+	memset (&Cur, 0, sizeof(Cur));
+}
+
+//------------------------------------------------------------------------------
+int lldp_event_fd (void)
+{
+	return Fd;
+}
+
+//------------------------------------------------------------------------------
+// the ready blocks back to the kernel. return true if the neighbor changed.
+//------------------------------------------------------------------------------
+int lldp_events (void)
+{
+	struct tpacket_block_desc *bd;
+	struct tpacket3_hdr *h;
+	uint_t i;
+	int changed = false;
+
+	if (!Ring)
+		return false;
+	while (true) {
+		bd = (struct tpacket_block_desc *)(Ring + Block * LLDP_BLOCK_SIZE);
+		if (!(bd->hdr.bh1.block_status & TP_STATUS_USER))
+			break;
+		__sync_synchronize ();
+		h = (struct tpacket3_hdr *)((byte_t *)bd + bd->hdr.bh1.offset_to_first_pkt);
+		for (i = 0; i < bd->hdr.bh1.num_pkts; i++) {
+			changed |= parse_frame ((byte_t *)h + h->tp_mac, h->tp_snaplen);
+			h = (struct tpacket3_hdr *)((byte_t *)h + h->tp_next_offset);
+		}
+		__sync_synchronize ();
+		bd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+		Block = (Block + 1) % LLDP_BLOCK_NR;
+	}
+	return changed;
+}
+
+//------------------------------------------------------------------------------
+// current neighbor. (false : none, TTL expired)
+//------------------------------------------------------------------------------
+int lldp_neighbor (lldp_t *n)
+{
+	if (Ring)
+		lldp_events ();
+	*n = Cur;
+	return Cur.proto && (time (NULL) < Cur.expire);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
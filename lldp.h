@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Passive LLDP / CDP neighbor. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __LLDP_H__
+#define __LLDP_H__
+
+#include <time.h>
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	Packet socket of the interface with a TPACKET_V3 receive ring (mmap) and
+	a classic BPF filter : ethertype 0x88cc (LLDP) and 802.3 LLC/SNAP of
+	OUI 00:00:0c PID 0x2000 (CDP). Other frames are dropped in the kernel,
+	nothing is queued or woken for them. The LLDP / CDP multicast addresses
+	are joined so the NIC does not filter them out.
+	A block is handed over on retire (LLDP_BLOCK_TOV_MS), lldp_events walks
+	the ready blocks and parses the TLVs in the ring. Names are copied out
+	only if they differ from the current neighbor.
+	The neighbor expires after its TTL. (LLDP TTL TLV, CDP header)
+*/
+//------------------------------------------------------------------------------
+#define	LLDP_NAME_MAX		32
+#define	LLDP_BLOCK_SIZE		4096		// page size multiple
+#define	LLDP_BLOCK_NR		4
+#define	LLDP_FRAME_SIZE		2048
+#define	LLDP_BLOCK_TOV_MS	50
+#define	LLDP_SNAPLEN		1518
+
+//------------------------------------------------------------------------------
+typedef struct lldp__t {
+	char		proto;					// 'L' : LLDP, 'C' : CDP
+	char		system[LLDP_NAME_MAX +1];	// system name, chassis id
+	char		port[LLDP_NAME_MAX +1];		// port id, description
+	time_t		expire;
+	// frames parsed / neighbor changes
+	ulong_t		frames;
+	ulong_t		changes;
+}	lldp_t;
+
+//------------------------------------------------------------------------------
+extern int	lldp_open		(const char *ifname);
+extern void	lldp_close		(void);
+extern int	lldp_event_fd	(void);
+extern int	lldp_events		(void);
+extern int	lldp_neighbor	(lldp_t *n);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __LLDP_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
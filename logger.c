@@ -0,0 +1,335 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Asynchronous logger. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <syslog.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "typedefs.h"
+#include "idle.h"
+#include "logger.h"
+
+//------------------------------------------------------------------------------
+typedef struct log_rec__t {
+	volatile uint_t		seq;			// Vyukov bounded queue
+	const log_site_t	*site;
+	time_t				sec;
+	int					msec;
+	char				text[LOG_TEXT_MAX];
+}	log_rec_t;
+
+enum {
+	LOG_OUT_STDOUT = 0,
+	LOG_OUT_FILE,
+	LOG_OUT_SYSLOG,
+};
+
+//------------------------------------------------------------------------------
+int		LogLevel = LV_INFO;
+
+static	log_rec_t		Ring[LOG_RING];
+static	volatile uint_t	Head;			// producers
+static	uint_t			Tail;			// flush (Lock)
+static	volatile ulong_t	Dropped;
+static	volatile uint_t	Kick;			// futex, records pushed
+static	volatile bool	Waiting;		// flush thread sleeps on Kick
+static	pthread_mutex_t	Lock = PTHREAD_MUTEX_INITIALIZER;
+static	pthread_t		Thread;
+static	bool			Started = false;
+static	int				Output = LOG_OUT_STDOUT;
+static	FILE			*Out;
+
+//------------------------------------------------------------------------------
+static	ulong_t	log_msec		(void);
+static	void	log_emit		(const log_site_t *site, time_t sec, int msec, const char *text);
+static	void	log_push		(const log_site_t *site, const char *text);
+static	int		log_drain		(void);
+static	void	*log_thread		(void *arg);
+		void	logger_write	(log_site_t *site, const char *fmt, ...);
+		int		logger_start	(const char *output);
+		void	logger_flush	(void);
+		int		logger_level	(const char *name);
+
+//------------------------------------------------------------------------------
+static ulong_t log_msec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+// one record to the output. (flush thread, or the caller before logger_start)
+//------------------------------------------------------------------------------
+static void log_emit (const log_site_t *site, time_t sec, int msec, const char *text)
+{
+	const int prio[] = { LOG_ERR, LOG_WARNING, LOG_INFO, LOG_DEBUG };
+	FILE *fp = Out ? Out : stdout;
+	struct tm tm;
+	char ts[32];
+
+	if (Output == LOG_OUT_SYSLOG) {
+		syslog (prio[site->level], "%s", text);
+		return;
+	}
+	if (Output == LOG_OUT_FILE) {
+		localtime_r (&sec, &tm);
+		strftime (ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", &tm);
+		fprintf (fp, "%s.%03d ", ts, msec);
+	} else if (site->level <= LV_WARN)
+		fp = stderr;
+
+	switch (site->level) {
+		case	LV_ERR:
+			fprintf (fp, "[ERR] %s (%s - %d)] : %s", site->file, site->func, site->line, text);
+			break;
+		case	LV_WARN:
+			fprintf (fp, "[WARN] %s(%d) : %s", site->func, site->line, text);
+			break;
+		case	LV_DBG:
+			fprintf (fp, "[DBG] %s(%d) : %s", site->func, site->line, text);
+			break;
+		default :
+			fprintf (fp, "[INFO] : %s", text);
+			break;
+	}
+	if (!*text || (text[strlen (text) -1] != '\n'))
+		fputc ('\n', fp);
+}
+
+//------------------------------------------------------------------------------
+// reserve a slot (CAS on Head), fill, publish. (full : dropped)
+//------------------------------------------------------------------------------
+static void log_push (const log_site_t *site, const char *text)
+{
+	struct timespec ts;
+	log_rec_t *r;
+	uint_t pos;
+	int diff;
+
+	clock_gettime (CLOCK_REALTIME, &ts);
+	if (!Started) {
+		log_emit (site, ts.tv_sec, ts.tv_nsec / 1000000, text);
+		fflush (Out ? Out : stdout);
+		return;
+	}
+
+	pos = Head;
+	while (true) {
+		r = &Ring[pos & (LOG_RING -1)];
+		diff = (int)(r->seq - pos);
+		if (diff == 0) {
+			if (__sync_bool_compare_and_swap (&Head, pos, pos + 1))
+				break;
+			pos = Head;
+		} else if (diff < 0) {
+			__sync_fetch_and_add (&Dropped, 1);
+			return;
+		} else
+			pos = Head;
+	}
+	r->site = site;
+	r->sec  = ts.tv_sec;
+	r->msec = ts.tv_nsec / 1000000;
+	strncpy (r->text, text, LOG_TEXT_MAX -1);
+	r->text[LOG_TEXT_MAX -1] = 0;
+	__sync_synchronize ();
+	r->seq = pos + 1;
+
+	__sync_fetch_and_add (&Kick, 1);
+	if (Waiting)
+		syscall (SYS_futex, &Kick, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+//------------------------------------------------------------------------------
+// records : one batch per LOG_FLUSH_MS. empty ring : sleep until a push.
+// (Kick read before the drain, a push after it ends the wait)
+//------------------------------------------------------------------------------
+static void *log_thread (void *arg)
+{
+	struct timespec ts = { LOG_FLUSH_MS / 1000, (LOG_FLUSH_MS % 1000) * 1000000L };
+	uint_t kick;
+	(void)arg;
+
+	while (true) {
+		nanosleep (&ts, NULL);
+		idle_wakeup ();
+		kick = Kick;
+		__sync_synchronize ();
+		if (log_drain ())
+			continue;
+		Waiting = true;
+		__sync_synchronize ();
+		syscall (SYS_futex, &Kick, FUTEX_WAIT_PRIVATE, kick, NULL, NULL, 0);
+		Waiting = false;
+		idle_wakeup ();
+	}
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+void logger_write (log_site_t *site, const char *fmt, ...)
+{
+	char buf[LOG_TEXT_MAX];
+	uint_t h = 2166136261u, n;
+	ulong_t now = log_msec (), add, t;
+	va_list va;
+	int i, tokens;
+
+	va_start (va, fmt);
+	vsnprintf (buf, sizeof(buf), fmt, va);
+	va_end (va);
+
+	// a site is shared by the threads calling it : counters are atomic,
+	// a race on the last hash only misses one de-duplication.
+	// same as the last message of the site : counted only.
+	for (i = 0; buf[i]; i++)
+		h = (h ^ (byte_t)buf[i]) * 16777619u;
+	if (site->seen && (site->hash == h)) {
+		__sync_fetch_and_add (&site->repeat, 1);
+		t = site->t_repeat;
+		if ((now - t >= LOG_REPEAT_SEC * 1000UL) &&
+			__sync_bool_compare_and_swap (&site->t_repeat, t, now)) {
+			n = __sync_fetch_and_and (&site->repeat, 0);
+			snprintf (buf, sizeof(buf), "last message repeated %u times\n", n);
+			log_push (site, buf);
+		}
+		return;
+	}
+	if ((n = __sync_fetch_and_and (&site->repeat, 0)) != 0) {
+		char msg[64];
+		snprintf (msg, sizeof(msg), "last message repeated %u times\n", n);
+		log_push (site, msg);
+	}
+	site->seen     = true;
+	site->hash     = h;
+	site->t_repeat = now;
+
+	// token bucket. (the refill time is claimed once)
+	__sync_bool_compare_and_swap (&site->t_token, 0, now);
+	t = site->t_token;
+	if (((add = (now - t) / LOG_RATE_MS) > 0) &&
+		__sync_bool_compare_and_swap (&site->t_token, t, t + add * LOG_RATE_MS)) {
+		do {
+			tokens = site->tokens;
+		} while (!__sync_bool_compare_and_swap (&site->tokens, tokens,
+					tokens + add > LOG_BURST ? LOG_BURST : tokens + (int)add));
+	}
+	do {
+		if ((tokens = site->tokens) <= 0) {
+			__sync_fetch_and_add (&site->suppressed, 1);
+			return;
+		}
+	} while (!__sync_bool_compare_and_swap (&site->tokens, tokens, tokens - 1));
+
+	if ((add = __sync_fetch_and_and (&site->suppressed, 0)) != 0) {
+		char msg[64];
+		snprintf (msg, sizeof(msg), "%lu messages suppressed\n", add);
+		log_push (site, msg);
+	}
+	log_push (site, buf);
+}
+
+//------------------------------------------------------------------------------
+// output : NULL / "stdout", "syslog", file path.
+//------------------------------------------------------------------------------
+int logger_start (const char *output)
+{
+	int i;
+
+	if (Started)
+		return true;
+	if (output && !strcmp (output, "syslog")) {
+		openlog ("netinfo_display", LOG_PID, LOG_DAEMON);
+		Output = LOG_OUT_SYSLOG;
+	} else if (output && strcmp (output, "stdout")) {
+		if ((Out = fopen (output, "a")) == NULL) {
+			fprintf (stderr, "log output %s open fail!\n", output);
+			return false;
+		}
+		Output = LOG_OUT_FILE;
+	}
+
+	for (i = 0; i < LOG_RING; i++)
+		Ring[i].seq = i;
+	Head = Tail = 0;
+	Started = true;
+	if (pthread_create (&Thread, NULL, log_thread, NULL)) {
+		Started = false;
+		return false;
+	}
+	// records of the ring at exit. (init fail messages)
+	atexit (logger_flush);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// records written.
+//------------------------------------------------------------------------------
+static int log_drain (void)
+{
+	static ulong_t reported;
+	static const log_site_t site = { "logger.c", "logger_flush", 0, LV_WARN, 0, 0, 0, 0, 0, 0, 0 };
+	log_rec_t *r;
+	char msg[64];
+	int n = 0;
+
+	pthread_mutex_lock (&Lock);
+	while (true) {
+		r = &Ring[Tail & (LOG_RING -1)];
+		if ((int)(r->seq - (Tail + 1)) < 0)
+			break;
+		log_emit (r->site, r->sec, r->msec, r->text);
+		__sync_synchronize ();
+		r->seq = Tail + LOG_RING;
+		Tail++;
+		n++;
+	}
+	if (Dropped != reported) {
+		snprintf (msg, sizeof(msg), "log ring full, %lu records dropped\n", Dropped - reported);
+		log_emit (&site, time (NULL), 0, msg);
+		reported = Dropped;
+		n++;
+	}
+	if (n && (Output != LOG_OUT_SYSLOG)) {
+		fflush (Out ? Out : stdout);
+		fflush (stderr);
+	}
+	pthread_mutex_unlock (&Lock);
+	return n;
+}
+
+//------------------------------------------------------------------------------
+void logger_flush (void)
+{
+	log_drain ();
+}
+
+//------------------------------------------------------------------------------
+int logger_level (const char *name)
+{
+	const char *names[] = { "err", "warn", "info", "dbg" };
+	int i;
+
+	for (i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+		if (!strcmp (name, names[i])) {
+			LogLevel = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Asynchronous logger. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __LOGGER_H__
+#define __LOGGER_H__
+
+//------------------------------------------------------------------------------
+/*
+	dbg / err / info (typedefs.h) keep a log_site_t per call site.
+	The site drops a message equal to its last one (counted, reported as
+	"last message repeated N times") and limits itself to LOG_BURST messages,
+	one more per LOG_RATE_MS. A message that passes is copied into a lock free
+	ring (bounded, per slot sequence), the flush thread writes the ring in
+	batches to stdout, a file or syslog. A full ring drops, the caller never
+	waits for the log output. An empty ring : the flush thread sleeps on a
+	futex until the next message. (the writer makes the syscall only if
+	the thread waits)
+*/
+//------------------------------------------------------------------------------
+#define	LOG_RING			256			// records, power of 2
+#define	LOG_TEXT_MAX		160
+#define	LOG_BURST			5			// messages per site
+#define	LOG_RATE_MS			1000		// one more message per site
+#define	LOG_REPEAT_SEC		600			// repeat count report period
+#define	LOG_FLUSH_MS		500			// batch period
+
+enum {
+	LV_ERR = 0,
+	LV_WARN,
+	LV_INFO,
+	LV_DBG,
+};
+
+//------------------------------------------------------------------------------
+// rate limit / de-duplication state. (static in the call site)
+// t_token, tokens, repeat, t_repeat, suppressed : __sync atomics.
+typedef struct log_site__t {
+	const char				*file, *func;
+	int						line, level;
+	volatile unsigned long	t_token;			// msec, last refill
+	volatile int			tokens;
+	volatile unsigned int	hash;				// last message
+	volatile int			seen;
+	volatile unsigned int	repeat;
+	volatile unsigned long	t_repeat;
+	volatile unsigned long	suppressed;			// rate limited
+}	log_site_t;
+
+#define	LOGGER(lv, fmt, args...)	do {								\
+	static log_site_t __site = { __FILE__, __func__, __LINE__, lv,		\
+									0, LOG_BURST, 0, 0, 0, 0, 0 };		\
+	if ((lv) <= LogLevel)												\
+		logger_write (&__site, fmt, ##args);							\
+} while (0)
+
+//------------------------------------------------------------------------------
+extern int	LogLevel;
+
+extern void	logger_write	(log_site_t *site, const char *fmt, ...)
+								__attribute__((format(printf, 2, 3)));
+extern int	logger_start	(const char *output);
+extern void	logger_flush	(void);
+extern int	logger_level	(const char *name);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __LOGGER_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
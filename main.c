@@ -25,6 +25,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/timerfd.h>
 
 //------------------------------------------------------------------------------
 // for my i2c lib
@@ -32,6 +33,21 @@
 #include "typedefs.h"
 #include "i2c-lcd.h"
 #include "usblp.h"
+#include "usblp-status.h"
+#include "gpio-ctl.h"
+#include "ledbar.h"
+#include "i2c-sched.h"
+#include "i2c-ctl.h"
+#include "i2c-trace.h"
+#include "widget.h"
+#include "dispsrv.h"
+#include "fleet.h"
+#include "rfb.h"
+#include "idle.h"
+#include "health.h"
+#include "wifi.h"
+#include "evlog.h"
+#include "lldp.h"
 
 //------------------------------------------------------------------------------
 // for WiringPi
@@ -64,41 +80,126 @@ struct ethtool_cmd {
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-static int is_net_alive		(void);
+static int is_net_alive		(int *rtt);
 
 static void tolowerstr 		(char *p);
 static void toupperstr 		(char *p);
 static void print_usage		(const char *prog);
 static void parse_opts 		(int argc, char *argv[]);
 
-static int get_net_info 	(const unsigned char *eth_name,
-								char *my_ip, int *speed, char *link);
-static int system_init		(void);
+static int get_net_info 	(const char *eth_name,
+								uint_t *my_ip, int *speed, int *duplex);
+static int get_wifi_info	(const char *if_name, uint_t *my_ip, wifi_t *w);
+static int system_init		(bool lcd);
 static int lcd_clear_line 	(int fd, int line);
 static int lcd_put_line 	(int fd, int x, int y, char *fmt, ...);
-static void time_display 	(int fd, int toffset);
+static int lcd_write_line	(int fd, int x, int y, const char *s, int len);
+static void mirror_cells	(int x, int y, const char *s, int len);
+static int mirror_clear		(int fd, int line);
+static int mirror_puts		(int fd, int x, int y, char *fmt, ...);
+static int mirror_write		(int fd, int x, int y, const char *s, int len);
+static int mirror_start		(const char *addr, int width, int height);
+static int led_write		(int fd, ulong_t bits, ulong_t mask);
+static void led_init		(void);
+static void time_zone		(void);
+static int clock_arm		(int tfd);
+static void clock_draw		(int fd);
+static void clock_page		(int fd, int seconds);
+static void health_page		(int fd, int seconds);
+static int history_page		(int fd);
+static int lcd_i2c_start	(char *dev, byte_t addr);
+static int post_message	(const char *arg);
+static int page_event		(int ev);
+static int page_wait		(void);
+static void idle_mode		(int fd, bool idle);
 
 //------------------------------------------------------------------------------
 int (*lcd_puts)(int fd, int x, int y, char *fmt, ...);
 int (*lcd_clr) (int fd, int line);
+int (*lcd_wr)  (int fd, int x, int y, const char *s, int len);
+
+// lcd_* driver (i2c, gpio chardev), not wiringPi lcd.
+static bool LcdDriver = false;
+
+// -R : the lcd backend behind the mirror, cells sent to the agent.
+static rfb_host_t Mirror;
+static char Cells[RFB_CELLS];
+static int (*MirrorPuts)(int fd, int x, int y, char *fmt, ...);
+static int (*MirrorClr) (int fd, int line);
+static int (*MirrorWr)  (int fd, int x, int y, const char *s, int len);
+
+//------------------------------------------------------------------------------
+// display pages. (widgets bound to the source values)
+//------------------------------------------------------------------------------
+static widget_t NetPage[] = {
+	WIDGET ( 0, 0, 16, W_LEFT,  W_IPV4,   NULL),
+	WIDGET ( 0, 1,  5, W_RIGHT, W_INT,    "%ldM"),	// link speed
+	WIDGET ( 6, 1,  4, W_LEFT,  W_DUPLEX, NULL),
+	WIDGET (11, 1,  5, W_RIGHT, W_RTT,    NULL),	// ping round trip
+};
+static widget_t WifiPage[] = {
+	WIDGET ( 0, 0, 16, W_LEFT,  W_IPV4,   NULL),
+	WIDGET ( 0, 1,  7, W_LEFT,  W_TEXT,   NULL),	// ssid
+	WIDGET ( 7, 1,  4, W_RIGHT, W_INT,    NULL),	// signal dBm
+	WIDGET (11, 1,  5, W_RIGHT, W_INT,    "%ldM"),	// tx bitrate
+};
+static widget_t ErrPage[] = {
+	WIDGET ( 0, 0, 16, W_LEFT,  W_TEXT,   NULL),
+	WIDGET ( 0, 1, 16, W_LEFT,  W_TEXT,   NULL),
+};
+static widget_t FaultPage[] = {
+	WIDGET ( 0, 0, 16, W_LEFT,  W_TEXT,   NULL),
+	WIDGET ( 0, 1, 16, W_LEFT,  W_TEXT,   NULL),	// usblp_status_fault
+};
+static widget_t FleetPage[] = {
+	WIDGET ( 0, 0,  6, W_LEFT,  W_INT,    "U%ld"),	// nodes up
+	WIDGET ( 6, 0,  5, W_LEFT,  W_INT,    "D%ld"),	// down / stale
+	WIDGET (11, 0,  5, W_RIGHT, W_INT,    "C%ld"),	// changed recently
+	WIDGET ( 0, 1, 10, W_LEFT,  W_TEXT,   NULL),	// worst rtt node
+	WIDGET (10, 1,  6, W_RIGHT, W_RTT,    NULL),
+};
+static widget_t HealthPage[] = {
+	WIDGET ( 0, 0,  8, W_LEFT,  W_PERCENT, "CPU "),
+	WIDGET ( 8, 0,  8, W_RIGHT, W_TEMP,    NULL),	// hottest thermal zone
+	WIDGET ( 0, 1,  8, W_LEFT,  W_PERCENT, "MEM "),
+	WIDGET ( 8, 1,  8, W_RIGHT, W_PERCENT, "DSK "),	// root filesystem
+};
+static widget_t LldpPage[] = {
+	WIDGET ( 0, 0, 16, W_LEFT,  W_TEXT,   NULL),	// switch system name
+	WIDGET ( 0, 1, 16, W_LEFT,  W_TEXT,   NULL),	// switch port id
+};
+static widget_t HistPage[] = {
+	WIDGET ( 0, 0, 16, W_LEFT,  W_TEXT,   NULL),	// 24h flaps, downtime
+	WIDGET ( 0, 1, 16, W_LEFT,  W_TEXT,   NULL),	// one of the last flaps
+};
+static widget_t ClockPage[] = {
+	WIDGET ( 0, 0, 16, W_LEFT,  W_CLOCK,  "%Y-%m-%d %a"),	// local midnight
+	WIDGET ( 0, 1, 16, W_LEFT,  W_CLOCK,  "%H:%M:%S %Z"),
+};
 
 //------------------------------------------------------------------------------
-static int is_net_alive(void)
+// rtt : usec of the ping reply, -1 if no reply.
+//------------------------------------------------------------------------------
+static int is_net_alive(int *rtt)
 {
-	char buf[2048];
+	char buf[2048], *p;
 	FILE *fp;
 
+	*rtt = -1;
 	if ((fp = popen("ping 8.8.8.8  -c 1 -w 1 2<&1", "r")) != NULL) {
 		while (fgets(buf, 2048, fp)) {
+			// 64 bytes from 8.8.8.8: icmp_seq=1 ttl=117 time=2.31 ms
+			if ((p = strstr(buf, "time=")) != NULL)
+				*rtt = (int)(strtod (p + 5, NULL) * 1000);
 			if (NULL != strstr(buf, "1 received")) {
 				pclose(fp);
-				fprintf(stdout, "%s = true\n", __func__);
+				dbg ("true\n");
 				return 1;
 			}
 		}
 		pclose(fp);
 	}
-	fprintf(stdout, "%s = false\n", __func__);
+	dbg ("false\n");
 	return 0;
 }
 
@@ -123,13 +224,32 @@ static void toupperstr (char *p)
 //------------------------------------------------------------------------------
 static void print_usage(const char *prog)
 {
-	printf("Usage: %s [-DawhItd]\n", prog);
+	printf("Usage: %s [-DaAwhItzdGLpbcrRloHiTYeEN]\n", prog);
 	puts("  -D --device        device name. (default /dev/i2c-0).\n"
-		 "  -a --i2c_addr      i2c chip address. (default 0x3f).\n"
+		 "  -a --i2c_addr      i2c chip address. (default 0x3f, auto : search)\n"
+		 "  -A --rescan        i2c lcd search & timing calibration again.\n"
 		 "  -w --width         lcd width.(default w = 16)\n"
 		 "  -h --height        lcd height.(default h = 2)\n"
 		 "  -t --time_offset   Display current time & time offset.(default false)\n"
+		 "  -z --time_zone     Display current time of the zone. (Asia/Seoul ...)\n"
 		 "  -d --delay         Display Switching delay (time & net info, default = 1)\n"
+		 "  -G --gpio_chip     LCD Shield gpio chip. (default search all, mock)\n"
+		 "  -L --led_bar       LCD Shield LED bar. (link(default), health, off)\n"
+		 "  -p --post          Show \"line:text\" on the running display. (10 sec)\n"
+		 "  -b --beacon        Send node beacons to the group. (auto : 239.255.77.77:7777)\n"
+		 "  -c --collector     Collect node beacons of the group, fleet summary page.\n"
+		 "  -r --remote        Remote framebuffer agent. (auto : udp port 7779)\n"
+		 "  -R --mirror        Mirror the display to a remote agent. (addr:port)\n"
+		 "  -l --log_level     err, warn, info(default), dbg\n"
+		 "  -o --log_output    stdout(default), syslog, file path\n"
+		 "  -H --health        Display SoC temperature, cpu, memory, disk usage.\n"
+		 "  -i --interface     Network interface. (default eth0, wlan : nl80211 status)\n"
+		 "  -I --idle          Idle after minutes without change, backlight off. (default 0 : off)\n"
+		 "  -T --i2c_trace     Capture the i2c transactions to the trace file.\n"
+		 "  -Y --trace_report  Report of a trace file (redundant lcd traffic), exit.\n"
+		 "  -e --event_file    Network event ring file. (default " EVLOG_FILE ", off)\n"
+		 "  -E --events        Dump the network event ring, exit.\n"
+		 "  -N --lldp          Display the switch name / port of LLDP, CDP frames.\n"
 	);
 	exit(1);
 }
@@ -140,6 +260,24 @@ static char		OPT_WIDTH = 16, OPT_HEIGHT = 2;
 static uchar_t	OPT_DEVICE_ADDR = 0x3f;
 static bool		OPT_LCD_SHIELD = true, OPT_TIME_DISPLAY = false;;
 static int 		OPT_TIME_OFFSET = 0, OPT_DISPLAY_DELAY = 1;
+static char		*OPT_GPIO_CHIP = NULL;
+static int		OPT_LED_BAR = LEDBAR_LINK;
+static bool		OPT_LCD_RESCAN = false;
+static char		*OPT_TIME_ZONE = NULL;
+static char		*OPT_POST = NULL;
+static char		*OPT_BEACON = NULL, *OPT_COLLECTOR = NULL;
+static char		*OPT_REMOTE = NULL, *OPT_MIRROR = NULL;
+static char		*OPT_LOG_OUTPUT = NULL;
+static int		OPT_IDLE = 0;
+static bool		OPT_HEALTH = false;
+static char		*OPT_IFNAME = "eth0";
+static char		*OPT_TRACE = NULL, *OPT_TRACE_REPORT = NULL;
+static char		*OPT_EVENT_FILE = EVLOG_FILE;
+static bool		OPT_EVENT_DUMP = false;
+static bool		OPT_LLDP = false;
+
+// idle_wait events of the page delays. (button, hotplug)
+static int		Events = 0;
 
 //------------------------------------------------------------------------------
 static void parse_opts (int argc, char *argv[])
@@ -148,15 +286,34 @@ static void parse_opts (int argc, char *argv[])
 		static const struct option lopts[] = {
 			{ "device_name",	1, 0, 'D' },
 			{ "device_addr",	1, 0, 'a' },
+			{ "rescan",			0, 0, 'A' },
 			{ "width",			1, 0, 'w' },
 			{ "height",			1, 0, 'h' },
 			{ "time_offset",	1, 0, 't' },
+			{ "time_zone",		1, 0, 'z' },
 			{ "delay",			1, 0, 'd' },
+			{ "gpio_chip",		1, 0, 'G' },
+			{ "led_bar",		1, 0, 'L' },
+			{ "post",			1, 0, 'p' },
+			{ "beacon",			1, 0, 'b' },
+			{ "collector",		1, 0, 'c' },
+			{ "remote",			1, 0, 'r' },
+			{ "mirror",			1, 0, 'R' },
+			{ "log_level",		1, 0, 'l' },
+			{ "log_output",		1, 0, 'o' },
+			{ "idle",			1, 0, 'I' },
+			{ "health",			0, 0, 'H' },
+			{ "interface",		1, 0, 'i' },
+			{ "i2c_trace",		1, 0, 'T' },
+			{ "trace_report",	1, 0, 'Y' },
+			{ "event_file",		1, 0, 'e' },
+			{ "events",			0, 0, 'E' },
+			{ "lldp",			0, 0, 'N' },
 			{ NULL, 0, 0, 0 },
 		};
 		int c;
 
-		c = getopt_long(argc, argv, "D:a:w:h:t:d:", lopts, NULL);
+		c = getopt_long(argc, argv, "D:a:Aw:h:t:z:d:G:L:p:b:c:r:R:l:o:I:Hi:T:Y:e:EN", lopts, NULL);
 
 		if (c == -1)
 			break;
@@ -168,7 +325,14 @@ static void parse_opts (int argc, char *argv[])
 			break;
 		case 'a':
 			OPT_LCD_SHIELD = false;
-			OPT_DEVICE_ADDR = strtol(optarg, NULL, 16) & 0xFF;
+			tolowerstr (optarg);
+			// 0 : auto discovery
+			OPT_DEVICE_ADDR = strcmp (optarg, "auto") ?
+								strtol(optarg, NULL, 16) & 0xFF : 0;
+			break;
+		case 'A':
+			OPT_LCD_SHIELD = false;
+			OPT_LCD_RESCAN = true;
 			break;
 		case 'w':
 			OPT_WIDTH = atoi(optarg);
@@ -180,9 +344,71 @@ static void parse_opts (int argc, char *argv[])
 			OPT_TIME_DISPLAY = true;
 			OPT_TIME_OFFSET = atoi(optarg);
 			break;
+		case 'z':
+			OPT_TIME_DISPLAY = true;
+			OPT_TIME_ZONE = optarg;
+			break;
 		case 'd':
 			OPT_DISPLAY_DELAY = atoi(optarg);
 			break;
+		case 'G':
+			OPT_GPIO_CHIP = optarg;
+			break;
+		case 'L':
+			tolowerstr (optarg);
+			if		(!strcmp (optarg, "link"))		OPT_LED_BAR = LEDBAR_LINK;
+			else if (!strcmp (optarg, "health"))	OPT_LED_BAR = LEDBAR_HEALTH;
+			else if (!strcmp (optarg, "off"))		OPT_LED_BAR = LEDBAR_OFF;
+			else
+				print_usage(argv[0]);
+			break;
+		case 'p':
+			OPT_POST = optarg;
+			break;
+		case 'b':
+			OPT_BEACON = optarg;
+			break;
+		case 'c':
+			OPT_COLLECTOR = optarg;
+			break;
+		case 'r':
+			OPT_REMOTE = optarg;
+			break;
+		case 'R':
+			OPT_MIRROR = optarg;
+			break;
+		case 'l':
+			tolowerstr (optarg);
+			if (!logger_level (optarg))
+				print_usage(argv[0]);
+			break;
+		case 'o':
+			OPT_LOG_OUTPUT = optarg;
+			break;
+		case 'I':
+			OPT_IDLE = atoi(optarg);
+			break;
+		case 'H':
+			OPT_HEALTH = true;
+			break;
+		case 'i':
+			OPT_IFNAME = optarg;
+			break;
+		case 'T':
+			OPT_TRACE = optarg;
+			break;
+		case 'Y':
+			OPT_TRACE_REPORT = optarg;
+			break;
+		case 'e':
+			OPT_EVENT_FILE = strcmp (optarg, "off") ? optarg : NULL;
+			break;
+		case 'E':
+			OPT_EVENT_DUMP = true;
+			break;
+		case 'N':
+			OPT_LLDP = true;
+			break;
 		default:
 			print_usage(argv[0]);
 			break;
@@ -192,8 +418,8 @@ static void parse_opts (int argc, char *argv[])
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-static int get_net_info (const unsigned char *eth_name,
-							char *my_ip, int *speed, char *link)
+static int get_net_info (const char *eth_name,
+							uint_t *my_ip, int *speed, int *duplex)
 {
 	int fd;
 	struct ifreq ifr;
@@ -204,16 +430,17 @@ static int get_net_info (const unsigned char *eth_name,
 	fd = socket(AF_INET, SOCK_DGRAM, 0);
 	if (fd < 0)
 	{
-		fprintf(stdout,"Cannot get control socket");
+		err ("Cannot get control socket\n");
 		return 0;
 	}
 	strncpy(ifr.ifr_name, eth_name, IFNAMSIZ); 
 	if (ioctl(fd, SIOCGIFADDR, &ifr) < 0) { 
-		fprintf(stdout, "SIOCGIFADDR ioctl Error!!\n"); 
+		err ("%s : SIOCGIFADDR ioctl Error!!\n", eth_name);
 		goto out;
 	} else { 
-		inet_ntop(AF_INET, ifr.ifr_addr.sa_data+2, my_ip, sizeof(struct sockaddr)); 
-		fprintf(stdout, "myOwn IP Address is %s\n", my_ip); 
+		*my_ip = ((struct sockaddr_in *)&ifr.ifr_addr)->sin_addr.s_addr;
+		info ("myOwn IP Address is %s\n",
+				inet_ntoa (((struct sockaddr_in *)&ifr.ifr_addr)->sin_addr));
 	}
 
 	/* Pass the "get info" command to eth tool driver */
@@ -223,48 +450,68 @@ static int get_net_info (const unsigned char *eth_name,
 	/* ioctl failed: */
 	if (ioctl(fd, SIOCETHTOOL, &ifr))
 	{
-		fprintf(stdout,"Cannot get device settings");
+		err ("%s : Cannot get device settings\n", eth_name);
 		close(fd);
 		goto out;
 	}
 	close(fd);
 
-	fprintf(stdout, "LinkSpeed = %d MB/s", ecmd.speed);
 	*speed = ecmd.speed;
 
-	switch (ecmd.duplex)
-	{
-		case DUPLEX_FULL:
-			strncpy(link, "FULL", 4);
-			fprintf(stdout," Full Duplex\n");
-		break;
-		case DUPLEX_HALF:
-			strncpy(link, "FULL", 4);
-			fprintf(stdout," Half Duplex\n");
-		break;
-		default:
-			strncpy(link, "????", 4);
-			fprintf(stdout," Duplex reading faulty\n");
-		break;
-	}
+	// widget W_DUPLEX : 0 half, 1 full, other unknown.
+	*duplex = ecmd.duplex;
+	info ("LinkSpeed = %d MB/s %s\n", ecmd.speed,
+			ecmd.duplex == DUPLEX_FULL ? "Full Duplex" :
+			ecmd.duplex == DUPLEX_HALF ? "Half Duplex" : "Duplex reading faulty");
 	return 1;
 out:
 	return 0;
 }
 
 //------------------------------------------------------------------------------
-static int system_init(void)
+// wlan : address by ioctl, link by nl80211. (no ethtool settings)
+//------------------------------------------------------------------------------
+static int get_wifi_info (const char *if_name, uint_t *my_ip, wifi_t *w)
 {
+	struct ifreq ifr;
 	int fd;
+
+	if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+		err ("Cannot get control socket\n");
+		return 0;
+	}
+	strncpy(ifr.ifr_name, if_name, IFNAMSIZ);
+	if (ioctl(fd, SIOCGIFADDR, &ifr) < 0) {
+		err ("%s : SIOCGIFADDR ioctl Error!!\n", if_name);
+		close(fd);
+		return 0;
+	}
+	close(fd);
+	*my_ip = ((struct sockaddr_in *)&ifr.ifr_addr)->sin_addr.s_addr;
+
+	if (!wifi_status (w)) {
+		err ("%s : not connected\n", if_name);
+		return 0;
+	}
+	info ("%s : %s, channel %d (%d MHz), %d dBm, %d Mbps\n", if_name,
+			w->ssid, w->channel, w->freq, w->signal, w->bitrate);
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+static int system_init(bool lcd)
+{
+	int fd = 0;
  
-	// LCD Init   
-	fd = lcdInit(BOARD_LCD_ROW, BOARD_LCD_COL, BOARD_LCD_BUS,
-				PORT_LCD_RS, PORT_LCD_E,
-				PORT_LCD_D4, PORT_LCD_D5,
-				PORT_LCD_D6, PORT_LCD_D7, 0, 0, 0, 0);
+	// LCD Init (wiringPi lcd, gpio chardev lines not found)
+	if (lcd)
+		fd = lcdInit(BOARD_LCD_ROW, BOARD_LCD_COL, BOARD_LCD_BUS,
+					PORT_LCD_RS, PORT_LCD_E,
+					PORT_LCD_D4, PORT_LCD_D5,
+					PORT_LCD_D6, PORT_LCD_D7, 0, 0, 0, 0);
  
 	if(fd < 0) {
-		fprintf(stderr, "%s : lcdInit failed!\n", __func__);
+		err ("lcdInit failed!\n");
 		return -1;
 	}
 
@@ -292,6 +539,7 @@ static int lcd_clear_line (int fd, int line)
 		int i;
 		for (i = 0; i < OPT_HEIGHT; i++)
 			lcd_puts (fd, 0, i, "                ");
+		return 1;
 	}
 	lcd_puts (fd, 0, line, "                ");
 	return 1;
@@ -300,109 +548,646 @@ static int lcd_clear_line (int fd, int line)
 //------------------------------------------------------------------------------
 static int lcd_put_line (int fd, int x, int y, char *fmt, ...)
 {
-	char buf[OPT_WIDTH +1], len, i;
+	char buf[LCD_COL_MAX +1];
+	int len;
 	va_list va;
 
-	memset(buf, 0x00, sizeof(buf));
+	va_start(va, fmt);
+	len = vsnprintf(buf, sizeof(buf), fmt, va);
+	va_end(va);
+
+	return lcd_write_line (fd, x, y, buf, len);
+}
+
+//------------------------------------------------------------------------------
+// mirror cells, cut at the mirror width.
+//------------------------------------------------------------------------------
+static void mirror_cells (int x, int y, const char *s, int len)
+{
+	if ((x < 0) || (x >= Mirror.width) || (y < 0) || (y >= Mirror.height))
+		return;
+	if (len > Mirror.width - x)
+		len = Mirror.width - x;
+	if (len > 0)
+		memcpy (&Cells[y * Mirror.width + x], s, len);
+}
+
+//------------------------------------------------------------------------------
+// mirror : backend first, then the frame. (unchanged : nothing sent)
+//------------------------------------------------------------------------------
+static int mirror_clear (int fd, int line)
+{
+	int ret = MirrorClr (fd, line);
+
+	if (line < 0)
+		memset (Cells, ' ', sizeof(Cells));
+	else if (line < Mirror.height)
+		memset (&Cells[line * Mirror.width], ' ', Mirror.width);
+	rfb_host_frame (&Mirror, Cells);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+static int mirror_puts (int fd, int x, int y, char *fmt, ...)
+{
+	char buf[LCD_COL_MAX +1];
+	int len, ret;
+	va_list va;
 
 	va_start(va, fmt);
-	len = vsprintf(buf, fmt, va);
+	len = vsnprintf(buf, sizeof(buf), fmt, va);
 	va_end(va);
+	if (len > LCD_COL_MAX)
+		len = LCD_COL_MAX;
 
-	lcdPosition (fd, x, y);
+	ret = MirrorPuts (fd, x, y, "%s", buf);
+	mirror_cells (x, y, buf, len);
+	rfb_host_frame (&Mirror, Cells);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+static int mirror_write (int fd, int x, int y, const char *s, int len)
+{
+	int ret = MirrorWr (fd, x, y, s, len);
 
+	mirror_cells (x, y, s, len);
+	rfb_host_frame (&Mirror, Cells);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// rfb host of the -R agent, the lcd_* pointers go through the mirror.
+//------------------------------------------------------------------------------
+static int mirror_start (const char *addr, int width, int height)
+{
+	if (!rfb_host_open (&Mirror, addr, width, height))
+		return false;
+	memset (Cells, ' ', sizeof(Cells));
+	MirrorPuts = lcd_puts;	lcd_puts = mirror_puts;
+	MirrorClr  = lcd_clr;	lcd_clr  = mirror_clear;
+	MirrorWr   = lcd_wr;	lcd_wr   = mirror_write;
+	info ("rfb mirror : %s (%dx%d)\n", addr, Mirror.width, Mirror.height);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// wiringPi lcd : text as it is. (cut at the lcd width)
+//------------------------------------------------------------------------------
+static int lcd_write_line (int fd, int x, int y, const char *s, int len)
+{
+	int i;
+
+	if ((x < 0) || (x >= OPT_WIDTH) || (y < 0) || (y >= OPT_HEIGHT))
+		return 0;
+	if (len > OPT_WIDTH - x)
+		len = OPT_WIDTH - x;
+
+	lcdPosition (fd, x, y);
 	for (i = 0; i < len; i++)
-		lcdPutchar(fd, buf[i]);
+		lcdPutchar(fd, s[i]);
 
 	return 1;
 }
 
 //------------------------------------------------------------------------------
-static void time_display (int fd, int toffset)
+// wiringPi LED writer (gpio chardev lines not found)
+//------------------------------------------------------------------------------
+static int led_write (int fd, ulong_t bits, ulong_t mask)
+{
+	const int ports[LEDBAR_COUNT] = PORT_LED_BAR;
+	int i;
+	(void)fd;
+
+	for (i = 0; i < LEDBAR_COUNT; i++) {
+		if (mask & (1UL << i))
+			digitalWrite (ports[i], (bits >> i) & 1);
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+static void led_init (void)
+{
+	const char *names[LEDBAR_COUNT] = GPIO_LED_NAMES;
+	int fd;
+
+	if (OPT_LED_BAR == LEDBAR_OFF)
+		return;
+
+	// all seven LEDs in one line request. (one line set per PWM edge)
+	if ((fd = gpio_open (OPT_GPIO_CHIP, names, LEDBAR_COUNT)) != false)
+		ledbar_start (fd, gpio_set, OPT_LED_BAR, OPT_IFNAME);
+	else
+		ledbar_start (0, led_write, OPT_LED_BAR, OPT_IFNAME);
+}
+
+//------------------------------------------------------------------------------
+static int lcd_i2c_start (char *dev, byte_t addr)
+{
+	int fd;
+
+	if ((fd = lcd_open (dev, addr)) == false)
+		return false;
+
+	// service restart : keep the screen, no power-on handshake.
+	if (!lcd_init_warm (fd, OPT_WIDTH, OPT_HEIGHT, true) &&
+		!lcd_init (fd, OPT_WIDTH, OPT_HEIGHT, true)) {
+		close (fd);
+		return false;
+	}
+	return fd;
+}
+
+//------------------------------------------------------------------------------
+// -p "line:text" : slot of the running display, shown DISP_POST_TIMEOUT.
+//------------------------------------------------------------------------------
+static int post_message (const char *arg)
+{
+	disp_shm_t *shm;
+	disp_slot_t *slot;
+	char *text;
+	int line = strtol (arg, &text, 10);
+
+	if ((*text != ':') || (line < 0)) {
+		err ("post : \"line:text\" (%s)\n", arg);
+		return false;
+	}
+	if ((shm = disp_attach ()) == NULL) {
+		err ("post : display server not running. (%s)\n", DISP_SHM);
+		return false;
+	}
+	if (line >= shm->height)
+		line = shm->height -1;
+	if ((slot = disp_claim (shm, DISP_POST_PRIO, 0, line, shm->width, 1,
+							DISP_POST_TIMEOUT)) == NULL) {
+		err ("post : no free slot.\n");
+		return false;
+	}
+	disp_post (slot, 0, text + 1);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// idle_wait events of a page. (button : the loop goes to the reconfigure)
+//------------------------------------------------------------------------------
+static int page_event (int ev)
+{
+	if (ev & (IDLE_EV_BUTTON | IDLE_EV_HOTPLUG))
+		idle_activity ();
+	Events |= ev & ~IDLE_EV_FD;
+	return ev;
+}
+
+//------------------------------------------------------------------------------
+// page delay, ends early on an event.
+//------------------------------------------------------------------------------
+static int page_wait (void)
+{
+	return page_event (idle_wait (OPT_DISPLAY_DELAY * 1000));
+}
+
+//------------------------------------------------------------------------------
+// idle : backlight (i2c lcd) and led bar off, wakeups counted per state.
+//------------------------------------------------------------------------------
+static void idle_mode (int fd, bool idle)
+{
+	info ("%s\n", idle ? "idle, backlight off" : "active");
+	if (LcdDriver)
+		lcd_backlight (fd, !idle);
+	ledbar_idle (idle);
+	idle_state (idle ? IDLE_IDLE : IDLE_ACTIVE);
+}
+
+//------------------------------------------------------------------------------
+// -z : tzdata zone (dst rules), -t only : fixed offset zone. (POSIX TZ sign)
+//------------------------------------------------------------------------------
+static void time_zone (void)
+{
+	char tz[32];
+
+	if (OPT_TIME_ZONE)
+		setenv ("TZ", OPT_TIME_ZONE, 1);
+	else if (OPT_TIME_OFFSET) {
+		snprintf (tz, sizeof(tz), "<%+03d>%d", OPT_TIME_OFFSET, -OPT_TIME_OFFSET);
+		setenv ("TZ", tz, 1);
+	}
+	tzset ();
+}
+
+//------------------------------------------------------------------------------
+// next second boundary of the wall clock, canceled when the clock is set.
+//------------------------------------------------------------------------------
+static int clock_arm (int tfd)
+{
+	struct itimerspec its;
+	struct timespec now;
+
+	clock_gettime (CLOCK_REALTIME, &now);
+	memset (&its, 0, sizeof(its));
+	its.it_value.tv_sec    = now.tv_sec + 1;
+	its.it_interval.tv_sec = 1;
+	return timerfd_settime (tfd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET,
+							&its, NULL) == 0;
+}
+
+//------------------------------------------------------------------------------
+// date widget is bound to the local midnight, formatted once a day.
+//------------------------------------------------------------------------------
+static void clock_draw (int fd)
+{
+	struct tm tm, day;
+	struct timespec now;
+
+	// not time() : the coarse clock is still in the last second at the tick.
+	clock_gettime (CLOCK_REALTIME, &now);
+	widget_localtime (now.tv_sec, &tm);
+
+	// mktime : a DST change day is not 24h.
+	day = tm;
+	day.tm_hour = day.tm_min = day.tm_sec = 0;
+	day.tm_isdst = -1;
+	widget_value (&ClockPage[0], mktime (&day));
+	widget_value (&ClockPage[1], now.tv_sec);
+	widget_page (fd, ClockPage, WIDGET_COUNT(ClockPage));
+}
+
+//------------------------------------------------------------------------------
+// the tick polled with the idle events. (a button press ends the page)
+//------------------------------------------------------------------------------
+static void clock_page (int fd, int seconds)
+{
+	unsigned long long expired;
+	int tfd, ticks = 0, ev;
+
+	clock_draw (fd);
+
+	if ((tfd = timerfd_create (CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK)) < 0) {
+		page_event (idle_wait (seconds * 1000));
+		return;
+	}
+	if (!clock_arm (tfd)) {
+		close (tfd);
+		page_event (idle_wait (seconds * 1000));
+		return;
+	}
+	while (ticks < seconds) {
+		ev = page_event (idle_wait_fd ((seconds - ticks + 1) * 1000, tfd));
+		if (!ev || (ev & IDLE_EV_BUTTON))
+			break;
+		if (!(ev & IDLE_EV_FD))
+			continue;
+		if (read (tfd, &expired, sizeof(expired)) != sizeof(expired)) {
+			if ((errno == EINTR) || (errno == EAGAIN))
+				continue;
+			if (errno != ECANCELED)
+				break;
+			// clock set (ntp step, date) : zone may be new, align again.
+			widget_tz_reset ();
+			if (!clock_arm (tfd))
+				break;
+		} else
+			ticks += expired;
+		clock_draw (fd);
+	}
+	close (tfd);
+}
+
+//------------------------------------------------------------------------------
+// sampled every HEALTH_SAMPLE_MS while shown. (only changed cells are sent)
+// low priority : a refresh over the lcd bus budget waits, values coalesce.
+//------------------------------------------------------------------------------
+static void health_page (int fd, int seconds)
+{
+	health_t h;
+	int i, n = seconds * 1000 / HEALTH_SAMPLE_MS;
+
+	for (i = 0; i < n; i++) {
+		health_sample ();
+		health_get (&h);
+		widget_value (&HealthPage[0], h.cpu);
+		widget_value (&HealthPage[1], h.temp);
+		widget_value (&HealthPage[2], h.mem);
+		widget_value (&HealthPage[3], h.disk);
+		if (!i || lcd_budget (lcd_cost_us (widget_dirty (HealthPage, WIDGET_COUNT(HealthPage)))))
+			widget_page (fd, HealthPage, WIDGET_COUNT(HealthPage));
+		if (page_event (idle_wait (HEALTH_SAMPLE_MS)) & IDLE_EV_BUTTON)
+			break;
+	}
+}
+
+//------------------------------------------------------------------------------
+// 24h flaps / downtime, one of the last EVLOG_PAGE_FLAPS per call.
+// (return false : no flap in 24h, no page)
+//------------------------------------------------------------------------------
+static int history_page (int fd)
 {
-	time_t t;
-	char buf[40], len;
+	static int next = 0;
+	evlog_flap_t f[EVLOG_PAGE_FLAPS];
+	ulong_t down, s;
+	char buf[48];
+	struct tm tm;
+	int flaps, count;
 
-	time(&t);
-	// time offset
-	t += (toffset * 60 * 60);
+	if (!(flaps = evlog_summary (time (NULL) - EVLOG_HISTORY_SEC, &down)))
+		return false;
+	if ((count = evlog_flaps (f, EVLOG_PAGE_FLAPS)) == 0)
+		return false;
 
-	memset(buf, 0, sizeof(buf));
-	len = sprintf (buf, "Time %s", ctime(&t));
+	// 16 columns. (flaps <= EVLOG_FLAP_MAX, down <= 24h)
+	if (down < 3600)
+		snprintf (buf, sizeof(buf), "Flap%3d Dn%3lum%02lus", flaps, down / 60, down % 60);
+	else
+		snprintf (buf, sizeof(buf), "Flap%3d Dn%3luh%02lum", flaps, down / 3600, down / 60 % 60);
+	buf[DEFAULT_LCD_WIDTH] = '\0';
+	widget_text (&HistPage[0], buf);
 
-	buf[len-1] = ' ';
-	lcd_clr (fd, -1);
-	lcd_puts (fd, 0, 0, "%s", &buf[0]);
-	lcd_puts (fd, 0, 1, "%s", &buf[16]);
-	fprintf(stdout, "Time = %s\n", buf);
+	// date time of the down, length. (* : still down)
+	next = (next + 1) % count;
+	localtime_r (&f[next].down, &tm);
+	s = f[next].secs;
+	snprintf (buf, sizeof(buf), "%02d/%02d %02d:%02d %lu%c%s",
+		tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min,
+		s < 60 ? s : s < 3600 ? s / 60 : s < 86400 ? s / 3600 : s / 86400,
+		s < 60 ? 's' : s < 3600 ? 'm' : s < 86400 ? 'h' : 'd',
+		f[next].ongoing ? "*" : "");
+	buf[DEFAULT_LCD_WIDTH] = '\0';
+	widget_text (&HistPage[1], buf);
+	widget_page (fd, HistPage, WIDGET_COUNT(HistPage));
+	return true;
 }
 
 //------------------------------------------------------------------------------
 int main(int argc, char **argv)
 {
-	int fd, speed = 0, net_alive = 0;
-	char my_net_ip[17], net_link[5];
+	int fd, speed = 0, duplex = -1, rtt = -1, net_alive = 0;
+	int link = -1;
+	uint_t my_net_ip = 0, last_ip = 0;
+	char lp_fault[17];
+	fleet_summary_t fleet;
+	bool idle = false, wireless;
+	wifi_t wlan;
+	lldp_t nb;
+	int changed, fault = false, was_alive = -1;
+	time_t t_probe = 0;
 
 	parse_opts(argc, argv);
+	if (OPT_POST)
+		return post_message (OPT_POST) ? 0 : 1;
+	if (OPT_TRACE_REPORT)
+		return i2c_trace_report (OPT_TRACE_REPORT) ? 0 : 1;
+	if (OPT_EVENT_DUMP)
+		return evlog_dump (OPT_EVENT_FILE ? OPT_EVENT_FILE : EVLOG_FILE) ? 0 : 1;
+	// the loop never waits for the log output.
+	if (!logger_start (OPT_LOG_OUTPUT))
+		return 0;
+	time_zone ();
+	if (OPT_TRACE)
+		i2c_capture_start (OPT_TRACE);
 
 	// 16x2 IO Shield Used
 	if (OPT_LCD_SHIELD) {
+		const char *names[LCD_GPIO_LINES] = GPIO_LCD_NAMES;
 
 		wiringPiSetup();
 
-		if ((fd = system_init() < 0)) {
-			fprintf (stderr, "%s: System Init failed\n", __func__);
-			return 0;
+		// lcd lines by gpio chardev (bulk line set), wiringPi lcd if not found.
+		if (((fd = lcd_open_gpio (OPT_GPIO_CHIP, names)) != false) &&
+			lcd_init (fd, BOARD_LCD_COL, BOARD_LCD_ROW, true)) {
+			if (system_init(false) < 0) {
+				err ("System Init failed\n");
+				return 0;
+			}
+			lcd_puts = lcd_printf;
+			lcd_clr  = lcd_clear;
+			lcd_wr   = lcd_write;
+			LcdDriver = true;
+			disp_server_start (fd, BOARD_LCD_COL, BOARD_LCD_ROW);
+		} else {
+			if (fd != false)
+				lcd_close (fd);
+			if ((fd = system_init(true)) < 0) {
+				err ("System Init failed\n");
+				return 0;
+			}
+			lcd_puts = lcd_put_line;
+			lcd_clr  = lcd_clear_line;
+			lcd_wr   = lcd_write_line;
 		}
-		lcd_puts = lcd_put_line;
-		lcd_clr  = lcd_clear_line;
+		led_init ();
 
 	} else {
 
-		if ((fd = lcd_open(OPT_DEVICE_NAME,	OPT_DEVICE_ADDR)) == false) {
+		char dev[LCD_DEV_MAX];
+		byte_t addr;
+
+		fd = (OPT_DEVICE_ADDR && !OPT_LCD_RESCAN) ?
+				lcd_i2c_start (OPT_DEVICE_NAME, OPT_DEVICE_ADDR) : false;
+
+		// wrong or no address : cached module, or adapter scan + calibration.
+		if ((fd == false) &&
+			lcd_discover (dev, sizeof(dev), &addr, OPT_LCD_RESCAN))
+			fd = lcd_i2c_start (dev, addr);
+
+		if (fd == false) {
 			err ("i2c-lcd init fail!\n");
 			err ("Device Name = %s, Device Addr = 0x%02x\n",
 						OPT_DEVICE_NAME, OPT_DEVICE_ADDR);
-			return 0;
-		}
-		if (!lcd_init (fd, OPT_WIDTH, OPT_HEIGHT, true)) {
-			err ("LCD Init Error!\n");
 			err ("LCD Width = %d, Height = %d\n", OPT_WIDTH, OPT_HEIGHT);
 			return 0;
 		}
 		lcd_puts = lcd_printf;
 		lcd_clr  = lcd_clear;
+		lcd_wr   = lcd_write;
+		LcdDriver = true;
+		disp_server_start (fd, OPT_WIDTH, OPT_HEIGHT);
 	}
+	// this display on a remote agent too. (lcd_* pointers : mirror first)
+	if (OPT_MIRROR && !OPT_REMOTE)
+		mirror_start (OPT_MIRROR,
+			OPT_LCD_SHIELD ? BOARD_LCD_COL : OPT_WIDTH,
+			OPT_LCD_SHIELD ? BOARD_LCD_ROW : OPT_HEIGHT);
+	// thin display agent of a remote host.
+	if (OPT_REMOTE)
+		return rfb_agent (fd, OPT_REMOTE, lcd_wr, lcd_clr) ? 0 : 1;
+
+	widget_init (lcd_wr, lcd_clr);
+	widget_text (&ErrPage[0],   "Network Error!");
+	widget_text (&ErrPage[1],   "Check ETH Cable");
+	widget_text (&FaultPage[0], "Printer Fault");
 
 	// usb label printer search & setup
 	usblp_reconfig ();
 
+	if (OPT_BEACON)
+		fleet_beacon_open (OPT_BEACON);
+	if (OPT_COLLECTOR)
+		fleet_collector_start (OPT_COLLECTOR);
+	if (OPT_HEALTH)
+		OPT_HEALTH = health_open ();
+	// network history survives restarts. (no file : no history page)
+	if (OPT_EVENT_FILE && evlog_open (OPT_EVENT_FILE, true))
+		evlog_add (EVLOG_START, true, 0);
+
+	// link / address / usb hotplug events, shield buttons.
+	if (OPT_LCD_SHIELD) {
+		const char *buttons[] = GPIO_BUTTON_NAMES;
+		idle_open (OPT_GPIO_CHIP, buttons, sizeof(buttons) / sizeof(buttons[0]));
+	} else
+		idle_open (NULL, NULL, 0);
+
+	// wlan : nl80211 status, (dis)connect events wake the idle wait.
+	memset (&wlan, 0, sizeof(wlan));
+	if ((wireless = wifi_open (OPT_IFNAME)) != false) {
+		idle_watch (wifi_event_fd (), wifi_events);
+		widget_text (&ErrPage[1], "Check Wi-Fi");
+	}
+	// switch neighbor : kernel filtered frames, the ring wakes the idle wait.
+	if (OPT_LLDP && (OPT_LLDP = lldp_open (OPT_IFNAME)) != false)
+		idle_watch (lldp_event_fd (), lldp_events);
+
 	while (true) {
+		// idle : wake on an event, the probe (beacons : stale time / 3).
+		if (idle) {
+			int ev = idle_wait ((OPT_BEACON ? FLEET_STALE_SEC / 3 : IDLE_PROBE_SEC) * 1000);
+
+			if (ev & (IDLE_EV_BUTTON | IDLE_EV_HOTPLUG))
+				idle_activity ();
+			else if (!ev && (time (NULL) - t_probe < IDLE_PROBE_SEC)) {
+				fleet_beacon_send (net_alive, rtt);
+				continue;
+			}
+		}
+		t_probe = time (NULL);
+
 		if (net_alive)
-			net_alive = is_net_alive();
+			net_alive = is_net_alive(&rtt);
 		else {
-			speed = 0;
-			memset (my_net_ip, 0, sizeof(my_net_ip));
-			memset (net_link,  0, sizeof(net_link));
-			net_alive = get_net_info ("eth0", my_net_ip, &speed, net_link);
+			speed = 0;	duplex = -1;	rtt = -1;	my_net_ip = 0;
+			net_alive = wireless ?
+				get_wifi_info (OPT_IFNAME, &my_net_ip, &wlan) :
+				get_net_info  (OPT_IFNAME, &my_net_ip, &speed, &duplex);
 		}
+		// wlan : signal / bitrate (rate limited), disconnect.
+		if (wireless && net_alive && !wifi_status (&wlan))
+			net_alive = 0;
+		if (wireless)
+			speed = net_alive ? wlan.bitrate : 0;
+		ledbar_link_speed (net_alive ? speed : 0);
+		ledbar_health (net_alive);
+		fleet_beacon_send (net_alive, rtt);
 
-		lcd_clr(fd, -1);
-		if (net_alive) {
-			lcd_puts (fd, 0, 0, "%s", my_net_ip);
-			lcd_puts (fd, 0, 1, "Speed=%d, %s", speed, net_link);
-		} else {
-			lcd_puts (fd, 0, 0, "Network Error! ");
-			lcd_puts (fd, 0, 1, "Check ETH Cable");
+		// transitions to the event ring. (wlan bitrate : up / down only)
+		if (net_alive != was_alive)
+			evlog_add (EVLOG_PROBE, net_alive, rtt < 0 ? 0 : rtt);
+		if (my_net_ip != last_ip)
+			evlog_add (EVLOG_ADDR, my_net_ip != 0, my_net_ip);
+		if ((wireless ? speed > 0 : speed) != link)
+			evlog_add (EVLOG_LINK, speed > 0, speed);
+		last_ip = my_net_ip;
+		link    = wireless ? speed > 0 : speed;
+
+		// state change : ip, link speed, duplex, ssid, alive. (rtt, signal : no)
+		changed = (net_alive != was_alive);
+		was_alive = net_alive;
+		if (net_alive && wireless) {
+			changed |= widget_value (&WifiPage[0], my_net_ip);
+			changed |= widget_text  (&WifiPage[1], wlan.ssid);
+			widget_value (&WifiPage[2], wlan.signal);
+			widget_value (&WifiPage[3], wlan.bitrate);
+		} else if (net_alive) {
+			changed |= widget_value (&NetPage[0], my_net_ip);
+			changed |= widget_value (&NetPage[1], speed);
+			changed |= widget_value (&NetPage[2], duplex);
+			widget_value (&NetPage[3], rtt);
 		}
-		sleep(OPT_DISPLAY_DELAY); 
+		if (changed)
+			idle_activity ();
 
-		if (OPT_TIME_DISPLAY) {
-			time_display (fd, OPT_TIME_OFFSET);
-			sleep(OPT_DISPLAY_DELAY);
+		// idle : no page, printer fault only.
+		if (idle) {
+			usblp_status_poll ();
+			if (!usblp_status_fault (lp_fault, sizeof(lp_fault)) != !fault) {
+				fault = !fault;
+				idle_activity ();
+			}
+		}
+		if (idle && !idle_expired (OPT_IDLE)) {
+			idle = false;
+			idle_mode (fd, false);
+		} else if (!idle && idle_expired (OPT_IDLE)) {
+			idle = true;
+			idle_mode (fd, true);
+		}
+		if (idle) {
+			Events = 0;
+			continue;
+		}
+
+		// unchanged values : no formatting, no bus traffic.
+		if (net_alive && wireless)
+			widget_page (fd, WifiPage, WIDGET_COUNT(WifiPage));
+		else if (net_alive)
+			widget_page (fd, NetPage, WIDGET_COUNT(NetPage));
+		else
+			widget_page (fd, ErrPage, WIDGET_COUNT(ErrPage));
+		// i2c lcd : DDRAM readback (within the bus budget), repair corrupted cells.
+		if (LcdDriver && !OPT_LCD_SHIELD) {
+			if (lcd_budget (lcd_verify_cost ()))
+				lcd_verify (fd);
+			i2c_sched_report ();
+			lcd_pace_report ();
+		}
+		if (page_wait () & IDLE_EV_BUTTON)
+			goto button;
+
+		if (fleet_summary (&fleet)) {
+			widget_value (&FleetPage[0], fleet.up);
+			widget_value (&FleetPage[1], fleet.down);
+			widget_value (&FleetPage[2], fleet.changed);
+			widget_text  (&FleetPage[3], fleet.worst);
+			widget_value (&FleetPage[4], fleet.worst_rtt);
+			widget_page (fd, FleetPage, WIDGET_COUNT(FleetPage));
+			if (page_wait () & IDLE_EV_BUTTON)
+				goto button;
+		}
+
+		if (OPT_LLDP && lldp_neighbor (&nb)) {
+			widget_text (&LldpPage[0], nb.system);
+			widget_text (&LldpPage[1], nb.port);
+			widget_page (fd, LldpPage, WIDGET_COUNT(LldpPage));
+			if (page_wait () & IDLE_EV_BUTTON)
+				goto button;
 		}
 
-		if (!digitalRead(PORT_BUTTON1) || !digitalRead(PORT_BUTTON2)) {
+		if (history_page (fd) && (page_wait () & IDLE_EV_BUTTON))
+			goto button;
+
+		// label printer status (paper out, head open ...)
+		usblp_status_poll ();
+		if (!usblp_status_fault (lp_fault, sizeof(lp_fault)) != !fault) {
+			fault = !fault;
+			idle_activity ();
+		}
+		if (fault) {
+			widget_text (&FaultPage[1], lp_fault);
+			widget_page (fd, FaultPage, WIDGET_COUNT(FaultPage));
+			if (page_wait () & IDLE_EV_BUTTON)
+				goto button;
+		}
+
+		if (OPT_HEALTH)
+			health_page (fd, OPT_DISPLAY_DELAY);
+
+		if (OPT_TIME_DISPLAY && !(Events & IDLE_EV_BUTTON))
+			clock_page (fd, OPT_DISPLAY_DELAY);
+
+		// button : straight here from the page it was pressed on.
+button:
+		if ((Events & IDLE_EV_BUTTON) ||
+			!digitalRead(PORT_BUTTON1) || !digitalRead(PORT_BUTTON2)) {
+			idle_activity ();
+			widget_leave ();
 			lcd_clr(fd, -1);
 			lcd_puts (fd, 0, 0, "Reconfigure    ");
 			lcd_puts (fd, 0, 1, "  Label Printer");
@@ -410,6 +1195,10 @@ int main(int argc, char **argv)
 				lcd_clr(fd, -1);
 				lcd_puts (fd, 0, 0, "Label Printer  ");
 				lcd_puts (fd, 0, 1, "Setup complete ");
+			} else if (usblp_status_fault (lp_fault, sizeof(lp_fault))) {
+				lcd_clr(fd, -1);
+				lcd_puts (fd, 0, 0, "Printer Fault  ");
+				lcd_puts (fd, 0, 1, "%s", lp_fault);
 			} else {
 				lcd_clr(fd, -1);
 				lcd_puts (fd, 0, 0, "Can't found    ");
@@ -417,6 +1206,7 @@ int main(int argc, char **argv)
 			}
 			sleep(OPT_DISPLAY_DELAY);
 		}
+		Events = 0;
 	}
 	return 0;
 }
@@ -0,0 +1,352 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Remote framebuffer. (UDP, chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "typedefs.h"
+#include "rfb.h"
+
+//------------------------------------------------------------------------------
+static	ulong_t	rfb_msec		(void);
+static	int		rfb_addr		(const char *arg, struct sockaddr_in *sa);
+static	int		rfb_run			(const char *cur, int a, int e);
+static	void	rfb_ack			(int sock, struct sockaddr_in *to, uint_t seq, byte_t flags);
+		int		rfb_encode		(const char *ref, const char *cur, int n, byte_t *out);
+		int		rfb_decode		(char *cells, int n, const byte_t *in, int len);
+		int		rfb_agent		(int fd, const char *addr,
+									int (*write)(int fd, int x, int y, const char *s, int len),
+									int (*clear)(int fd, int line));
+		int		rfb_host_open	(rfb_host_t *h, const char *addr, int width, int height);
+		int		rfb_host_frame	(rfb_host_t *h, const char *cells);
+
+//------------------------------------------------------------------------------
+static ulong_t rfb_msec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+// "auto" : any address, "port", "addr:port"
+//------------------------------------------------------------------------------
+static int rfb_addr (const char *arg, struct sockaddr_in *sa)
+{
+	char host[32], *p;
+
+	memset (sa, 0, sizeof(*sa));
+	sa->sin_family      = AF_INET;
+	sa->sin_port        = htons (RFB_PORT);
+	sa->sin_addr.s_addr = htonl (INADDR_ANY);
+	if (!strcmp (arg, "auto"))
+		return true;
+	if (!strchr (arg, ':') && !strchr (arg, '.')) {
+		sa->sin_port = htons (atoi (arg));
+		return true;
+	}
+
+	snprintf (host, sizeof(host), "%s", arg);
+	if ((p = strchr (host, ':')) != NULL) {
+		*p++ = 0;
+		sa->sin_port = htons (atoi (p));
+	}
+	if (!inet_pton (AF_INET, host, &sa->sin_addr)) {
+		err ("rfb address : %s\n", arg);
+		return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// same char run from a. (max 0x7f)
+//------------------------------------------------------------------------------
+static int rfb_run (const char *cur, int a, int e)
+{
+	int r;
+
+	for (r = 1; (a + r < e) && (r < 0x7f) && (cur[a + r] == cur[a]); r++)
+		;
+	return r;
+}
+
+//------------------------------------------------------------------------------
+static void rfb_ack (int sock, struct sockaddr_in *to, uint_t seq, byte_t flags)
+{
+	rfb_ack_t ack;
+
+	ack.magic = htonl (RFB_MAGIC);
+	ack.seq   = htonl (seq);
+	ack.flags = flags;
+	sendto (sock, &ack, sizeof(ack), 0, (struct sockaddr *)to, sizeof(*to));
+}
+
+//------------------------------------------------------------------------------
+// ops of the cells changed from ref. (ref NULL : all cells, return length)
+//------------------------------------------------------------------------------
+int rfb_encode (const char *ref, const char *cur, int n, byte_t *out)
+{
+	byte_t *p = out;
+	int a = 0, b, e, gap, r, start;
+
+	while (a < n) {
+		if (ref && (ref[a] == cur[a])) {
+			a++;
+			continue;
+		}
+		// a few unchanged cells are cheaper than a new op header.
+		for (b = a + 1, gap = 0; b < n; b++) {
+			if (!ref || (ref[b] != cur[b]))
+				gap = 0;
+			else if (++gap > RFB_GAP_MAX) {
+				b++;
+				break;
+			}
+		}
+		e = b - gap;
+
+		while (a < e) {
+			if ((r = rfb_run (cur, a, e)) >= RFB_FILL_MIN) {
+				*p++ = a;	*p++ = RFB_FILL | r;	*p++ = cur[a];
+				a += r;
+				continue;
+			}
+			// literal up to the next fill run.
+			for (start = a; (a < e) && (a - start < 0x7f); a += r) {
+				if ((r = rfb_run (cur, a, e)) >= RFB_FILL_MIN)
+					break;
+			}
+			if (a - start > 0x7f)
+				a = start + 0x7f;
+			*p++ = start;	*p++ = a - start;
+			memcpy (p, &cur[start], a - start);
+			p += a - start;
+		}
+	}
+	return p - out;
+}
+
+//------------------------------------------------------------------------------
+int rfb_decode (char *cells, int n, const byte_t *in, int len)
+{
+	const byte_t *end = in + len;
+	int pos, cnt;
+
+	while (in < end) {
+		if (end - in < 3)
+			return false;
+		pos = *in++;
+		cnt = *in & 0x7f;
+		if (pos + cnt > n)
+			return false;
+		if (*in++ & RFB_FILL) {
+			memset (&cells[pos], *in++, cnt);
+			continue;
+		}
+		if (end - in < cnt)
+			return false;
+		memcpy (&cells[pos], in, cnt);
+		in += cnt;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// thin display agent. (lcd_write / lcd_clear backend)
+//------------------------------------------------------------------------------
+int rfb_agent (int fd, const char *addr,
+				int (*write)(int fd, int x, int y, const char *s, int len),
+				int (*clear)(int fd, int line))
+{
+	static byte_t pkt[RFB_PACKET_MAX];
+	static char h_cells[RFB_HISTORY][RFB_CELLS];
+	static uint_t h_seq[RFB_HISTORY];
+	static word_t h_dim[RFB_HISTORY];		// width << 8 | height, 0 : empty
+	char frame[RFB_CELLS], glass[RFB_CELLS];
+	rfb_hdr_t *hdr = (rfb_hdr_t *)pkt;
+	struct sockaddr_in sa, from;
+	socklen_t fromlen;
+	uint_t seq, cur = 0;
+	int sock, len, n, i, x, y, a, b, w, h;
+	bool have = false;
+
+	if (!rfb_addr (addr, &sa))
+		return false;
+	if (((sock = socket (AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0) ||
+		(bind (sock, (struct sockaddr *)&sa, sizeof(sa)) < 0)) {
+		err ("rfb agent : %s (%s)\n", addr, strerror (errno));
+		return false;
+	}
+	info ("rfb agent : %s:%d\n", inet_ntoa (sa.sin_addr), ntohs (sa.sin_port));
+
+	clear (fd, -1);
+	memset (glass, ' ', sizeof(glass));
+
+	while (true) {
+		fromlen = sizeof(from);
+		len = recvfrom (sock, pkt, sizeof(pkt), 0, (struct sockaddr *)&from, &fromlen);
+		if ((len < (int)sizeof(rfb_hdr_t)) || (ntohl (hdr->magic) != RFB_MAGIC))
+			continue;
+		w = hdr->width;	h = hdr->height;	n = w * h;
+		if (!n || (w > LCD_COL_MAX) || (h > LCD_ROW_MAX))
+			continue;
+
+		// old / repeated delta : ack again. (lost ack)
+		// a key frame always resyncs. (host restarted, seq from 1)
+		seq = ntohl (hdr->seq);
+		if (have && (hdr->type != RFB_KEY) && ((int)(seq - cur) <= 0)) {
+			rfb_ack (sock, &from, cur, 0);
+			continue;
+		}
+		if (hdr->type == RFB_KEY) {
+			// resync : deltas of the old numbering are gone.
+			if (have && ((int)(seq - cur) <= 0))
+				memset (h_dim, 0, sizeof(h_dim));
+			memset (frame, ' ', n);
+		} else {
+			for (i = 0; i < RFB_HISTORY; i++) {
+				if (h_dim[i] && (h_seq[i] == ntohl (hdr->base)) && (h_dim[i] == ((w << 8) | h)))
+					break;
+			}
+			if (i == RFB_HISTORY) {
+				rfb_ack (sock, &from, cur, RFB_ACK_KEY);
+				continue;
+			}
+			memcpy (frame, h_cells[i], n);
+		}
+		if (!rfb_decode (frame, n, pkt + sizeof(rfb_hdr_t), len - sizeof(rfb_hdr_t)))
+			continue;
+
+		// changed span of each row to the lcd. (backend sends changed cells only)
+		for (y = 0; y < h; y++) {
+			for (a = 0; (a < w) && (frame[y * w + a] == glass[y * LCD_COL_MAX + a]); a++)
+				;
+			if (a == w)
+				continue;
+			for (b = w - 1; frame[y * w + b] == glass[y * LCD_COL_MAX + b]; b--)
+				;
+			if (write (fd, a, y, &frame[y * w + a], b - a + 1))
+				memcpy (&glass[y * LCD_COL_MAX + a], &frame[y * w + a], b - a + 1);
+		}
+		// glass outside a smaller frame : spaces.
+		for (y = 0; y < LCD_ROW_MAX; y++) {
+			for (x = (y < h) ? w : 0; x < LCD_COL_MAX; x++) {
+				if (glass[y * LCD_COL_MAX + x] == ' ')
+					continue;
+				memset (&glass[y * LCD_COL_MAX + x], ' ', LCD_COL_MAX - x);
+				write (fd, x, y, &glass[y * LCD_COL_MAX + x], LCD_COL_MAX - x);
+				break;
+			}
+		}
+
+		i = seq % RFB_HISTORY;
+		memcpy (h_cells[i], frame, n);
+		h_seq[i] = seq;
+		h_dim[i] = (w << 8) | h;
+		cur  = seq;
+		have = true;
+		rfb_ack (sock, &from, cur, 0);
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+int rfb_host_open (rfb_host_t *h, const char *addr, int width, int height)
+{
+	struct sockaddr_in sa;
+
+	memset (h, 0, sizeof(rfb_host_t));
+	if (!rfb_addr (addr, &sa))
+		return false;
+	if (((h->fd = socket (AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0) ||
+		(connect (h->fd, (struct sockaddr *)&sa, sizeof(sa)) < 0)) {
+		err ("rfb host : %s (%s)\n", addr, strerror (errno));
+		return false;
+	}
+	h->width  = width  > LCD_COL_MAX ? LCD_COL_MAX : width;
+	h->height = height > LCD_ROW_MAX ? LCD_ROW_MAX : height;
+	// the first frame is a key frame, the agent resyncs on it.
+	h->seq    = 1;
+	h->acked  = -1;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// cells : width * height. (unchanged and acked : nothing sent)
+//------------------------------------------------------------------------------
+int rfb_host_frame (rfb_host_t *h, const char *cells)
+{
+	byte_t pkt[RFB_PACKET_MAX];
+	rfb_hdr_t *hdr = (rfb_hdr_t *)pkt;
+	rfb_ack_t ack;
+	ulong_t now = rfb_msec ();
+	int n = h->width * h->height, i, len;
+	uint_t seq;
+
+	while (recv (h->fd, &ack, sizeof(ack), MSG_DONTWAIT) == sizeof(ack)) {
+		if (ntohl (ack.magic) != RFB_MAGIC)
+			continue;
+		if (ack.flags & RFB_ACK_KEY)
+			h->key = true;
+		seq = ntohl (ack.seq);
+		for (i = 0; i < RFB_HISTORY; i++) {
+			if ((h->h_seq[i] != seq) || !h->frames)
+				continue;
+			if ((h->acked < 0) || ((int)(seq - h->h_seq[h->acked]) > 0))
+				h->acked = i;
+		}
+	}
+
+	if (h->frames && !h->key && !memcmp (cells, h->last, n) &&
+		(now - h->t_key < RFB_KEY_MS)) {
+		// last frame acked, or the ack is not late yet.
+		if (((h->acked >= 0) && (h->h_seq[h->acked] == h->seq - 1)) ||
+			(now - h->t_send < RFB_RESEND_MS))
+			return true;
+	}
+
+	// the slot of this frame must not be the base.
+	i = h->seq % RFB_HISTORY;
+	if ((h->acked < 0) || (h->acked == i) || (now - h->t_key >= RFB_KEY_MS))
+		h->key = true;
+
+	hdr->magic  = htonl (RFB_MAGIC);
+	hdr->seq    = htonl (h->seq);
+	hdr->base   = htonl (h->key ? h->seq : h->h_seq[h->acked]);
+	hdr->type   = h->key ? RFB_KEY : RFB_DELTA;
+	hdr->width  = h->width;
+	hdr->height = h->height;
+	len = sizeof(rfb_hdr_t) +
+		rfb_encode (h->key ? NULL : h->h_cells[h->acked], cells, n, pkt + sizeof(rfb_hdr_t));
+
+	if (h->acked == i)
+		h->acked = -1;
+	memcpy (h->h_cells[i], cells, n);
+	h->h_seq[i] = h->seq++;
+	memcpy (h->last, cells, n);
+
+	if (send (h->fd, pkt, len, 0) != len)
+		return false;
+	if (h->key) {
+		h->t_key = now;
+		h->key   = false;
+	}
+	h->t_send = now;
+	h->bytes += len;
+	h->frames++;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
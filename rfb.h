@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Remote framebuffer. (UDP, chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __RFB_H__
+#define __RFB_H__
+
+#include "typedefs.h"
+#include "i2c-lcd.h"
+//------------------------------------------------------------------------------
+/*
+	A host drives the lcd of the agent (-r) with numbered frames.
+
+	frame : rfb_hdr_t + ops, cells are width * height row order.
+		op : pos, len, data
+			len & RFB_FILL : (len & 0x7f) cells of one char. (data 1 byte)
+			else           : len cells. (data len bytes)
+	key frame   : every cell from spaces.
+	delta frame : changed cells against the frame base, the last frame the
+	              agent acked. (the host resends the whole change until acked)
+
+	The agent keeps the last RFB_HISTORY frames, a delta of an unknown base
+	is answered with RFB_ACK_KEY. The applied frame is compared with the
+	glass and the changed rows go to the lcd backend right away, then acked.
+*/
+//------------------------------------------------------------------------------
+#define	RFB_PORT			7779
+#define	RFB_MAGIC			0x52464231	// "RFB1"
+#define	RFB_HISTORY			8
+#define	RFB_CELLS			(LCD_COL_MAX * LCD_ROW_MAX)
+#define	RFB_PACKET_MAX		(sizeof(rfb_hdr_t) + RFB_CELLS * 3)
+#define	RFB_FILL			0x80
+#define	RFB_FILL_MIN		4			// shorter : literal
+#define	RFB_GAP_MAX			2			// unchanged cells kept in a run
+#define	RFB_KEY_MS			5000		// host key frame period
+#define	RFB_RESEND_MS		200			// host, no ack : send again
+
+enum {
+	RFB_KEY = 0,
+	RFB_DELTA,
+};
+
+#define	RFB_ACK_KEY			0x01		// agent : key frame please
+
+//------------------------------------------------------------------------------
+typedef struct rfb_hdr__t {
+	uint_t		magic;
+	uint_t		seq;
+	uint_t		base;				// RFB_DELTA : reference frame
+	byte_t		type;
+	byte_t		width, height;
+}	__attribute__((packed)) rfb_hdr_t;
+
+typedef struct rfb_ack__t {
+	uint_t		magic;
+	uint_t		seq;				// last applied frame
+	byte_t		flags;
+}	__attribute__((packed)) rfb_ack_t;
+
+typedef struct rfb_host__t {
+	int			fd;
+	byte_t		width, height;
+	uint_t		seq;
+	int			acked;				// history index, -1 : no base
+	bool		key;				// key frame requested
+	ulong_t		t_key;				// msec, last key frame
+	ulong_t		t_send;
+	// sent frames (acks point here)
+	uint_t		h_seq[RFB_HISTORY];
+	char		h_cells[RFB_HISTORY][RFB_CELLS];
+	char		last[RFB_CELLS];
+	ulong_t		bytes, frames;
+}	rfb_host_t;
+
+//------------------------------------------------------------------------------
+extern int	rfb_encode		(const char *ref, const char *cur, int n, byte_t *out);
+extern int	rfb_decode		(char *cells, int n, const byte_t *in, int len);
+
+// agent : never returns.
+extern int	rfb_agent		(int fd, const char *addr,
+								int (*write)(int fd, int x, int y, const char *s, int len),
+								int (*clear)(int fd, int line));
+
+// host
+extern int	rfb_host_open	(rfb_host_t *h, const char *addr, int width, int height);
+extern int	rfb_host_frame	(rfb_host_t *h, const char *cells);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __RFB_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
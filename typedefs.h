@@ -9,9 +9,12 @@
 //------------------------------------------------------------------------------------------------
 // #define	dbg(fmt, args...)
 // #define	err(fmt, args...)
-#define	dbg(fmt, args...)	fprintf(stdout,"[DBG] %s(%d) : " fmt, __func__, __LINE__, ##args)
-#define	err(fmt, args...)	fprintf(stderr,"[ERR] %s (%s - %d)] : " fmt, __FILE__, __func__, __LINE__, ##args)
-#define	info(fmt, args...)	fprintf(stdout,"[INFO] : " fmt, ##args)
+// rate limited, written by the logger thread. (logger.h)
+#include "logger.h"
+#define	dbg(fmt, args...)	LOGGER(LV_DBG,  fmt, ##args)
+#define	err(fmt, args...)	LOGGER(LV_ERR,  fmt, ##args)
+#define	warn(fmt, args...)	LOGGER(LV_WARN, fmt, ##args)
+#define	info(fmt, args...)	LOGGER(LV_INFO, fmt, ##args)
 
 //------------------------------------------------------------------------------------------------
 typedef unsigned char       byte_t;
@@ -0,0 +1,715 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 USB Label printer barcode (Code128, QR) encoder. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "typedefs.h"
+#include "usblp-form.h"
+#include "usblp-code.h"
+
+//------------------------------------------------------------------------------
+// Code128 bar/space widths. (0 ~ 102 : symbol value, 103 ~ 105 : start A/B/C)
+//------------------------------------------------------------------------------
+static const char *C128_PATTERN[107] = {
+	"212222", "222122", "222221", "121223", "121322", "131222", "122213", "122312",
+	"132212", "221213", "221312", "231212", "112232", "122132", "122231", "113222",
+	"123122", "123221", "223211", "221132", "221231", "213212", "223112", "312131",
+	"311222", "321122", "321221", "312212", "322112", "322211", "212123", "212321",
+	"232121", "111323", "131123", "131321", "112313", "132113", "132311", "211313",
+	"231113", "231311", "112133", "112331", "132131", "113123", "113321", "133121",
+	"313121", "211331", "231131", "213113", "213311", "213131", "311123", "311321",
+	"331121", "312113", "312311", "332111", "314111", "221411", "431111", "111224",
+	"111422", "121124", "121421", "141122", "141221", "112214", "112412", "122114",
+	"122411", "142112", "142211", "241211", "221114", "413111", "241112", "134111",
+	"111242", "121142", "121241", "114212", "124112", "124211", "411212", "421112",
+	"421211", "212141", "214121", "412121", "111143", "111341", "131141", "114113",
+	"114311", "411113", "411311", "113141", "114131", "311141", "411131", "211412",
+	"211214", "211232", "2331112",
+};
+
+#define	C128_START_B	104
+#define	C128_START_C	105
+#define	C128_STOP		106
+
+//------------------------------------------------------------------------------
+// QR version 1 ~ 10, error correction level M
+//------------------------------------------------------------------------------
+static const struct {
+	byte_t	ec;			// ec codewords per block
+	byte_t	b1, d1;		// group 1 blocks, data codewords
+	byte_t	b2, d2;		// group 2 blocks, data codewords
+	byte_t	align;		// alignment pattern position (besides 6)
+	byte_t	align2;
+}	QR_VER[BC_QR_VERSION_MAX +1] = {
+	{  0, 0,  0, 0,  0,  0,  0 },
+	{ 10, 1, 16, 0,  0,  0,  0 },
+	{ 16, 1, 28, 0,  0, 18,  0 },
+	{ 26, 1, 44, 0,  0, 22,  0 },
+	{ 18, 2, 32, 0,  0, 26,  0 },
+	{ 24, 2, 43, 0,  0, 30,  0 },
+	{ 16, 4, 27, 0,  0, 34,  0 },
+	{ 18, 4, 31, 0,  0, 22, 38 },
+	{ 22, 2, 38, 2, 39, 24, 42 },
+	{ 22, 3, 36, 2, 37, 26, 46 },
+	{ 26, 4, 43, 1, 44, 28, 50 },
+};
+
+// ec level M format bits = 00
+#define	QR_ECL_M		0x00
+#define	QR_CW_MAX		346
+#define	QR_EC_MAX		26
+
+//------------------------------------------------------------------------------
+static	char	*put_dec		(char *p, uint_t v);
+static	char	*put_str		(char *p, const char *s);
+static	int		qr_version		(int len);
+static	byte_t	gf_mul			(byte_t x, byte_t y);
+static	void	rs_encode		(const byte_t *data, int len, int ec, byte_t *out);
+static	void	qr_set			(byte_t m[][BC_QR_SIZE_MAX], byte_t f[][BC_QR_SIZE_MAX],
+									int x, int y, int v);
+static	void	qr_function		(byte_t m[][BC_QR_SIZE_MAX], byte_t f[][BC_QR_SIZE_MAX],
+									int ver, int size);
+static	void	qr_format		(byte_t m[][BC_QR_SIZE_MAX], byte_t f[][BC_QR_SIZE_MAX],
+									int size, int mask);
+static	int		qr_mask_bit		(int mask, int x, int y);
+static	int		qr_penalty		(byte_t m[][BC_QR_SIZE_MAX], int size);
+		int		bc_code128		(const char *s, int len, byte_t *modules, int size);
+		int		bc_qr			(const char *s, int len, byte_t m[][BC_QR_SIZE_MAX]);
+		int		bc_pack			(const byte_t *mods, int stride, int w, int h,
+									int sx, int sy, bool invert,
+									byte_t *out, int size, int *bpr);
+		int		bc_max_len		(const bc_param_t *p, int data_max);
+		int		bc_emit			(const bc_param_t *p, const char *s, int len,
+									char *out, int size);
+		int		bc_cached		(bc_cache_t *c, int key, const bc_param_t *p,
+									const char *s, int len, char *out, int size);
+		void	bc_cache_free	(bc_cache_t *c);
+
+//------------------------------------------------------------------------------
+static char *put_dec (char *p, uint_t v)
+{
+	char tmp[10];
+	int i = 0;
+
+	do {
+		tmp[i++] = '0' + (v % 10);
+		v /= 10;
+	} while (v);
+
+	while (i)
+		*p++ = tmp[--i];
+	return p;
+}
+
+//------------------------------------------------------------------------------
+static char *put_str (char *p, const char *s)
+{
+	while (*s)
+		*p++ = *s++;
+	return p;
+}
+
+//------------------------------------------------------------------------------
+// Code128 modules (1 = bar). return module count or 0.
+//------------------------------------------------------------------------------
+int bc_code128 (const char *s, int len, byte_t *modules, int size)
+{
+	int sym[BC_C128_MAX + 3], n = 0, i, j, w, pos, sum;
+	bool set_c = (len >= 4) && !(len & 1);
+
+	if (len > BC_C128_MAX)
+		return 0;
+
+	for (i = 0; set_c && (i < len); i++)
+		set_c = (s[i] >= '0') && (s[i] <= '9');
+
+	sym[n++] = set_c ? C128_START_C : C128_START_B;
+	for (i = 0; i < len; i++) {
+		if (set_c) {
+			sym[n++] = (s[i] - '0') * 10 + (s[i+1] - '0');
+			i++;
+		} else {
+			if ((s[i] < 0x20) || (s[i] > 0x7E))
+				return 0;
+			sym[n++] = s[i] - 0x20;
+		}
+	}
+	// modulo 103 check symbol
+	for (i = 1, sum = sym[0]; i < n; i++)
+		sum += sym[i] * i;
+	sym[n++] = sum % 103;
+	sym[n++] = C128_STOP;
+
+	if (size < (n * 11 + 2))
+		return 0;
+
+	for (i = 0, pos = 0; i < n; i++) {
+		const char *pat = C128_PATTERN[sym[i]];
+		for (j = 0; pat[j]; j++)
+			for (w = pat[j] - '0'; w; w--)
+				modules[pos++] = !(j & 1);
+	}
+	return pos;
+}
+
+//------------------------------------------------------------------------------
+static int qr_version (int len)
+{
+	int ver, data_cw;
+
+	for (ver = 1; ver <= BC_QR_VERSION_MAX; ver++) {
+		data_cw = QR_VER[ver].b1 * QR_VER[ver].d1 + QR_VER[ver].b2 * QR_VER[ver].d2;
+		// mode(4) + count(8 or 16) + data
+		if ((4 + (ver < 10 ? 8 : 16) + len * 8) <= data_cw * 8)
+			return ver;
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// GF(256), x^8 + x^4 + x^3 + x^2 + 1
+//------------------------------------------------------------------------------
+static byte_t gf_mul (byte_t x, byte_t y)
+{
+	int z = 0, i;
+
+	for (i = 7; i >= 0; i--) {
+		z = (z << 1) ^ ((z >> 7) * 0x11D);
+		z ^= ((y >> i) & 1) * x;
+	}
+	return z;
+}
+
+//------------------------------------------------------------------------------
+static void rs_encode (const byte_t *data, int len, int ec, byte_t *out)
+{
+	byte_t gen[QR_EC_MAX], root = 1, factor;
+	int i, j;
+
+	// generator polynomial (x - a^0)(x - a^1)...(x - a^(ec-1))
+	memset (gen, 0, sizeof(gen));
+	gen[ec - 1] = 1;
+	for (i = 0; i < ec; i++) {
+		for (j = 0; j < ec; j++) {
+			gen[j] = gf_mul (gen[j], root);
+			if (j + 1 < ec)
+				gen[j] ^= gen[j + 1];
+		}
+		root = gf_mul (root, 0x02);
+	}
+
+	memset (out, 0, ec);
+	for (i = 0; i < len; i++) {
+		factor = data[i] ^ out[0];
+		memmove (out, out + 1, ec - 1);
+		out[ec - 1] = 0;
+		for (j = 0; j < ec; j++)
+			out[j] ^= gf_mul (gen[j], factor);
+	}
+}
+
+//------------------------------------------------------------------------------
+static void qr_set (byte_t m[][BC_QR_SIZE_MAX], byte_t f[][BC_QR_SIZE_MAX],
+					int x, int y, int v)
+{
+	m[y][x] = v ? 1 : 0;
+	f[y][x] = 1;
+}
+
+//------------------------------------------------------------------------------
+// timing, finder, alignment, dark module, version info
+//------------------------------------------------------------------------------
+static void qr_function (byte_t m[][BC_QR_SIZE_MAX], byte_t f[][BC_QR_SIZE_MAX],
+						int ver, int size)
+{
+	int pos[3], npos = 0, i, j, dx, dy, d;
+	int cx[3] = { 3, size - 4, 3 }, cy[3] = { 3, 3, size - 4 };
+
+	for (i = 0; i < size; i++) {
+		qr_set (m, f, 6, i, !(i & 1));
+		qr_set (m, f, i, 6, !(i & 1));
+	}
+	// finder + separator
+	for (i = 0; i < 3; i++) {
+		for (dy = -4; dy <= 4; dy++) {
+			for (dx = -4; dx <= 4; dx++) {
+				int x = cx[i] + dx, y = cy[i] + dy;
+				if ((x < 0) || (x >= size) || (y < 0) || (y >= size))
+					continue;
+				d = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+				qr_set (m, f, x, y, (d != 2) && (d != 4));
+			}
+		}
+	}
+	// alignment
+	if (QR_VER[ver].align) {
+		pos[npos++] = 6;
+		pos[npos++] = QR_VER[ver].align;
+		if (QR_VER[ver].align2)
+			pos[npos++] = QR_VER[ver].align2;
+	}
+	for (i = 0; i < npos; i++) {
+		for (j = 0; j < npos; j++) {
+			if ((!i && !j) || (!i && (j == npos - 1)) || ((i == npos - 1) && !j))
+				continue;
+			for (dy = -2; dy <= 2; dy++)
+				for (dx = -2; dx <= 2; dx++) {
+					d = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+					qr_set (m, f, pos[i] + dx, pos[j] + dy, d != 1);
+				}
+		}
+	}
+	// format area reserved (written by qr_format)
+	qr_format (m, f, size, 0);
+
+	// version info (version 7 ~)
+	if (ver >= 7) {
+		int rem = ver;
+		long bits;
+
+		for (i = 0; i < 12; i++)
+			rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+		bits = ((long)ver << 12) | rem;
+		for (i = 0; i < 18; i++) {
+			int a = size - 11 + i % 3, b = i / 3, bit = (bits >> i) & 1;
+			qr_set (m, f, a, b, bit);
+			qr_set (m, f, b, a, bit);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+static void qr_format (byte_t m[][BC_QR_SIZE_MAX], byte_t f[][BC_QR_SIZE_MAX],
+						int size, int mask)
+{
+	int data = (QR_ECL_M << 3) | mask, rem = data, bits, i;
+
+	for (i = 0; i < 10; i++)
+		rem = (rem << 1) ^ ((rem >> 9) * 0x537);
+	bits = ((data << 10) | rem) ^ 0x5412;
+
+	for (i = 0; i <= 5; i++)
+		qr_set (m, f, 8, i, (bits >> i) & 1);
+	qr_set (m, f, 8, 7, (bits >> 6) & 1);
+	qr_set (m, f, 8, 8, (bits >> 7) & 1);
+	qr_set (m, f, 7, 8, (bits >> 8) & 1);
+	for (i = 9; i < 15; i++)
+		qr_set (m, f, 14 - i, 8, (bits >> i) & 1);
+
+	for (i = 0; i < 8; i++)
+		qr_set (m, f, size - 1 - i, 8, (bits >> i) & 1);
+	for (i = 8; i < 15; i++)
+		qr_set (m, f, 8, size - 15 + i, (bits >> i) & 1);
+	qr_set (m, f, 8, size - 8, 1);
+}
+
+//------------------------------------------------------------------------------
+static int qr_mask_bit (int mask, int x, int y)
+{
+	switch (mask) {
+		case	0:	return !((x + y) % 2);
+		case	1:	return !(y % 2);
+		case	2:	return !(x % 3);
+		case	3:	return !((x + y) % 3);
+		case	4:	return !((x / 3 + y / 2) % 2);
+		case	5:	return !(x * y % 2 + x * y % 3);
+		case	6:	return !((x * y % 2 + x * y % 3) % 2);
+		default :
+		case	7:	return !(((x + y) % 2 + x * y % 3) % 2);
+	}
+}
+
+//------------------------------------------------------------------------------
+// mask penalty (N1 run, N2 2x2 block, N3 finder like, N4 dark ratio)
+//------------------------------------------------------------------------------
+static int qr_penalty (byte_t m[][BC_QR_SIZE_MAX], int size)
+{
+	static const byte_t f1[11] = { 1,0,1,1,1,0,1,0,0,0,0 };
+	static const byte_t f2[11] = { 0,0,0,0,1,0,1,1,1,0,1 };
+	int p = 0, x, y, i, run, dark = 0, dir;
+
+	for (dir = 0; dir < 2; dir++) {
+		for (y = 0; y < size; y++) {
+			for (x = 0, run = 0; x < size; x++) {
+				byte_t c = dir ? m[x][y] : m[y][x];
+				byte_t prev = x ? (dir ? m[x-1][y] : m[y][x-1]) : 2;
+
+				run = (c == prev) ? run + 1 : 1;
+				if (run == 5)		p += 3;
+				else if (run > 5)	p += 1;
+
+				if (x + 11 <= size) {
+					bool a = true, b = true;
+					for (i = 0; i < 11 && (a || b); i++) {
+						byte_t v = dir ? m[x+i][y] : m[y][x+i];
+						a = a && (v == f1[i]);
+						b = b && (v == f2[i]);
+					}
+					if (a)	p += 40;
+					if (b)	p += 40;
+				}
+			}
+		}
+	}
+	for (y = 0; y < size; y++) {
+		for (x = 0; x < size; x++) {
+			dark += m[y][x];
+			if ((x + 1 < size) && (y + 1 < size) &&
+				(m[y][x] == m[y][x+1]) && (m[y][x] == m[y+1][x]) &&
+				(m[y][x] == m[y+1][x+1]))
+				p += 3;
+		}
+	}
+	p += (abs(dark * 20 - size * size * 10) / (size * size)) * 10;
+	return p;
+}
+
+//------------------------------------------------------------------------------
+// QR matrix (1 = dark). return matrix size or 0.
+//------------------------------------------------------------------------------
+int bc_qr (const char *s, int len, byte_t m[][BC_QR_SIZE_MAX])
+{
+	static const byte_t pad[2] = { 0xEC, 0x11 };
+	byte_t f[BC_QR_SIZE_MAX][BC_QR_SIZE_MAX], best[BC_QR_SIZE_MAX][BC_QR_SIZE_MAX];
+	byte_t data[QR_CW_MAX], code[QR_CW_MAX], ec[5][QR_EC_MAX];
+	int ver, size, data_cw, nblk, i, j, b, bit, n, mask, p, best_p = -1;
+	int x, y, right, vert, up;
+
+	if (!(ver = qr_version (len)))
+		return 0;
+
+	size    = 17 + 4 * ver;
+	nblk    = QR_VER[ver].b1 + QR_VER[ver].b2;
+	data_cw = QR_VER[ver].b1 * QR_VER[ver].d1 + QR_VER[ver].b2 * QR_VER[ver].d2;
+
+	// byte mode bit stream
+	memset (data, 0, sizeof(data));
+	bit = 0;
+#define	PUT_BITS(v, cnt)	\
+	for (i = (cnt) - 1; i >= 0; i--, bit++)	\
+		data[bit >> 3] |= (((v) >> i) & 1) << (7 - (bit & 7));
+
+	PUT_BITS (0x4, 4);
+	PUT_BITS (len, ver < 10 ? 8 : 16);
+	for (j = 0; j < len; j++) {
+		PUT_BITS ((byte_t)s[j], 8);
+	}
+#undef	PUT_BITS
+	// terminator(0000) is already zero. pad to byte and pad codewords.
+	for (n = (bit + 4 + 7) / 8 < data_cw ? (bit + 4 + 7) / 8 : data_cw, j = 0;
+		n < data_cw; n++, j++)
+		data[n] = pad[j & 1];
+
+	// ec per block + interleave
+	for (b = 0, n = 0; b < nblk; b++) {
+		int dlen = (b < QR_VER[ver].b1) ? QR_VER[ver].d1 : QR_VER[ver].d2;
+		rs_encode (&data[n], dlen, QR_VER[ver].ec, ec[b]);
+		n += dlen;
+	}
+	for (i = 0, n = 0; i < QR_VER[ver].d2 || i < QR_VER[ver].d1; i++) {
+		int off = 0;
+		for (b = 0; b < nblk; b++) {
+			int dlen = (b < QR_VER[ver].b1) ? QR_VER[ver].d1 : QR_VER[ver].d2;
+			if (i < dlen)
+				code[n++] = data[off + i];
+			off += dlen;
+		}
+	}
+	for (i = 0; i < QR_VER[ver].ec; i++)
+		for (b = 0; b < nblk; b++)
+			code[n++] = ec[b][i];
+
+	// function patterns + data placement (zigzag, right to left)
+	memset (m, 0, sizeof(byte_t) * BC_QR_SIZE_MAX * BC_QR_SIZE_MAX);
+	memset (f, 0, sizeof(f));
+	qr_function (m, f, ver, size);
+
+	for (right = size - 1, i = 0; right >= 1; right -= 2) {
+		if (right == 6)
+			right = 5;
+		up = !((right + 1) & 2);
+		for (vert = 0; vert < size; vert++) {
+			for (j = 0; j < 2; j++) {
+				x = right - j;
+				y = up ? size - 1 - vert : vert;
+				if (!f[y][x] && (i < n * 8)) {
+					m[y][x] = (code[i >> 3] >> (7 - (i & 7))) & 1;
+					i++;
+				}
+			}
+		}
+	}
+
+	// choose the mask of the lowest penalty
+	for (mask = 0; mask < 8; mask++) {
+		for (y = 0; y < size; y++)
+			for (x = 0; x < size; x++)
+				if (!f[y][x])
+					m[y][x] ^= qr_mask_bit (mask, x, y);
+		qr_format (m, f, size, mask);
+
+		p = qr_penalty (m, size);
+		if ((best_p < 0) || (p < best_p)) {
+			best_p = p;
+			memcpy (best, m, sizeof(best));
+		}
+		// undo
+		for (y = 0; y < size; y++)
+			for (x = 0; x < size; x++)
+				if (!f[y][x])
+					m[y][x] ^= qr_mask_bit (mask, x, y);
+	}
+	memcpy (m, best, sizeof(best));
+	return size;
+}
+
+//------------------------------------------------------------------------------
+// 1-bpp raster (msb first). each module byte row is packed 8 modules at once,
+// spread by the scale table and written / inverted a 64bit word at a time.
+// return raster size or -1.
+//------------------------------------------------------------------------------
+int bc_pack (const byte_t *mods, int stride, int w, int h, int sx, int sy,
+			bool invert, byte_t *out, int size, int *bpr)
+{
+	uint64_t spread[256], v;
+	byte_t bits[(BC_MODULES_MAX + 7) / 8 +8], *row;
+	int x, y, i, k, r, nbits, row_bytes;
+
+	if ((sx < 1) || (sx > BC_DOTS_MAX) || (sy < 1) || (w < 1) || (w > BC_MODULES_MAX))
+		return -1;
+
+	row_bytes = (w * sx + 7) / 8;
+	if (row_bytes * h * sy > size)
+		return -1;
+
+	// 8 modules -> 8 * sx bits
+	for (i = 0; i < 256; i++) {
+		for (k = 0, v = 0; k < 8; k++) {
+			v <<= sx;
+			if (i & (0x80 >> k))
+				v |= (1ULL << sx) - 1;
+		}
+		spread[i] = v << (64 - 8 * sx);
+	}
+
+	for (y = 0, row = out; y < h; y++) {
+		const byte_t *src = &mods[y * stride];
+
+		// modules -> bits
+		memset (bits, 0, sizeof(bits));
+		for (x = 0; x < w; x++)
+			bits[x >> 3] |= (src[x] ? 0x80 : 0) >> (x & 7);
+
+		// bits -> scaled bits, 'sx' bytes for each module byte
+		for (i = 0, nbits = 0; i < (w + 7) / 8; i++) {
+			v = spread[bits[i]];
+			for (k = 0; (k < sx) && (nbits < row_bytes); k++, nbits++)
+				row[nbits] = v >> (56 - 8 * k);
+		}
+		if (invert) {
+			for (k = 0; k + 8 <= row_bytes; k += 8) {
+				uint64_t word;
+				memcpy (&word, &row[k], 8);
+				word = ~word;
+				memcpy (&row[k], &word, 8);
+			}
+			for (; k < row_bytes; k++)
+				row[k] = ~row[k];
+		}
+		// vertical scale
+		for (r = 1; r < sy; r++)
+			memcpy (row + r * row_bytes, row, row_bytes);
+		row += row_bytes * sy;
+	}
+	*bpr = row_bytes;
+	return row_bytes * h * sy;
+}
+
+//------------------------------------------------------------------------------
+// largest command size for data_max characters.
+//------------------------------------------------------------------------------
+int bc_max_len (const bc_param_t *p, int data_max)
+{
+	int w, h, sx, sy, ver;
+	// command text, position, size parameters
+	const int header = 64;
+
+	if (p->mode == BC_MODE_NATIVE)
+		return header + data_max;
+
+	if (p->sym == BC_SYM_QR) {
+		if (!(ver = qr_version (data_max)))
+			ver = BC_QR_VERSION_MAX;
+		w = h = 17 + 4 * ver;
+		sx = sy = p->scale;
+	} else {
+		w = (data_max + 3) * 11 + 2;
+		h = 1;
+		sx = p->scale;
+		sy = p->height;
+	}
+	return header + ((w * sx + 7) / 8) * h * sy;
+}
+
+//------------------------------------------------------------------------------
+// barcode command into out. return size or -1.
+//------------------------------------------------------------------------------
+int bc_emit (const bc_param_t *p, const char *s, int len, char *out, int size)
+{
+	static __thread byte_t m[BC_QR_SIZE_MAX][BC_QR_SIZE_MAX];
+	static __thread byte_t mods[BC_C128_MODULES_MAX];
+	char text[BC_DATA_MAX +1], *o = out;
+	int w, h, sx, sy, bpr, n;
+	const byte_t *src;
+	bool epl = (p->lang == LBL_LANG_EPL);
+
+	if ((len > BC_DATA_MAX) || (size < bc_max_len (p, len)))
+		return -1;
+	memcpy (text, s, len);
+	text[len] = 0;
+
+	if (p->mode == BC_MODE_NATIVE) {
+		if (epl) {
+			// Bx,y,rot,1(code128 auto),narrow,wide,height,N,"data"
+			// bx,y,Q,m2,s{scale},eM,"data"
+			o = put_str (o, p->sym == BC_SYM_QR ? "b" : "B");
+			o = put_dec (o, p->x);	*o++ = ',';
+			o = put_dec (o, p->y);	*o++ = ',';
+			if (p->sym == BC_SYM_QR) {
+				o = put_str (o, "Q,m2,s");
+				o = put_dec (o, p->scale);
+				o = put_str (o, ",eM,\"");
+			} else {
+				o = put_str (o, "0,1,");
+				o = put_dec (o, p->scale);	*o++ = ',';
+				o = put_dec (o, p->scale);	*o++ = ',';
+				o = put_dec (o, p->height);
+				o = put_str (o, ",N,\"");
+			}
+			o = put_str (o, text);
+			o = put_str (o, "\"\n");
+		} else {
+			o = put_str (o, "^FO");
+			o = put_dec (o, p->x);	*o++ = ',';
+			o = put_dec (o, p->y);
+			if (p->sym == BC_SYM_QR) {
+				o = put_str (o, "^BQN,2,");
+				o = put_dec (o, p->scale);
+				o = put_str (o, "^FDMA,");
+			} else {
+				o = put_str (o, "^BY");
+				o = put_dec (o, p->scale);
+				o = put_str (o, "^BCN,");
+				o = put_dec (o, p->height);
+				o = put_str (o, ",N,N,N^FD");
+			}
+			o = put_str (o, text);
+			o = put_str (o, "^FS\n");
+		}
+		return o - out;
+	}
+
+	// bitmap
+	if (p->sym == BC_SYM_QR) {
+		if (!(w = h = bc_qr (text, len, m)))
+			return -1;
+		src = &m[0][0];
+		sx = sy = p->scale;
+		n = BC_QR_SIZE_MAX;
+	} else {
+		if (!(w = bc_code128 (text, len, mods, sizeof(mods))))
+			return -1;
+		src = mods;
+		h = 1;
+		sx = p->scale;	sy = p->height;
+		n = w;
+	}
+
+	if (epl) {
+		// GWx,y,bytes per row,rows,<binary>
+		o = put_str (o, "GW");
+		o = put_dec (o, p->x);	*o++ = ',';
+		o = put_dec (o, p->y);	*o++ = ',';
+		o = put_dec (o, (w * sx + 7) / 8);	*o++ = ',';
+		o = put_dec (o, h * sy);	*o++ = ',';
+	} else {
+		// ^FOx,y^GFB,total,total,bytes per row,<binary>^FS
+		int total = ((w * sx + 7) / 8) * h * sy;
+		o = put_str (o, "^FO");
+		o = put_dec (o, p->x);	*o++ = ',';
+		o = put_dec (o, p->y);
+		o = put_str (o, "^GFB,");
+		o = put_dec (o, total);	*o++ = ',';
+		o = put_dec (o, total);	*o++ = ',';
+		o = put_dec (o, (w * sx + 7) / 8);	*o++ = ',';
+	}
+	if ((n = bc_pack (src, n, w, h, sx, sy, epl,
+						(byte_t *)o, size - (o - out) - 4, &bpr)) < 0)
+		return -1;
+	o += n;
+	o = put_str (o, epl ? "\n" : "^FS\n");
+	return o - out;
+}
+
+//------------------------------------------------------------------------------
+// bc_emit through the payload cache. (key : barcode slot of the form)
+//------------------------------------------------------------------------------
+int bc_cached (bc_cache_t *c, int key, const bc_param_t *p,
+				const char *s, int len, char *out, int size)
+{
+	bc_entry_t *e;
+	uint_t hash = 2166136261u ^ key;
+	int i, ret;
+
+	if (len > BC_DATA_MAX)
+		return -1;
+
+	// fnv-1a
+	for (i = 0; i < len; i++)
+		hash = (hash ^ (byte_t)s[i]) * 16777619u;
+
+	e = &c->entry[hash % BC_CACHE_SIZE];
+	if (e->out && (e->hash == hash) && (e->key == key) &&
+		!strncmp (e->data, s, len) && !e->data[len]) {
+		if (e->len > size)
+			return -1;
+		memcpy (out, e->out, e->len);
+		c->hit++;
+		return e->len;
+	}
+
+	c->miss++;
+	if ((ret = bc_emit (p, s, len, out, size)) < 0)
+		return ret;
+
+	free (e->out);
+	if ((e->out = malloc (ret)) != NULL) {
+		memcpy (e->out, out, ret);
+		memcpy (e->data, s, len);
+		e->data[len] = 0;
+		e->hash = hash;
+		e->key  = key;
+		e->len  = ret;
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+void bc_cache_free (bc_cache_t *c)
+{
+	int i;
+
+	for (i = 0; i < BC_CACHE_SIZE; i++) {
+		free (c->entry[i].out);
+		c->entry[i].out = NULL;
+	}
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
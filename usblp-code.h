@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 USB Label printer barcode (Code128, QR) encoder. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __USBLP_CODE_H__
+#define __USBLP_CODE_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	Code128 : code set B (code set C for an even number of digits)
+	QR      : byte mode, error correction level M, version 1 ~ BC_QR_VERSION_MAX
+
+	native  : printer barcode command (EPL B/b, ZPL ^BC/^BQ)
+	bitmap  : 1-bpp raster for EPL GW / ZPL ^GF (binary)
+	          EPL GW prints '0' bits, ZPL ^GF prints '1' bits.
+*/
+//------------------------------------------------------------------------------
+#define	BC_QR_VERSION_MAX	10
+#define	BC_QR_SIZE_MAX		(17 + 4 * BC_QR_VERSION_MAX)
+#define	BC_QR_SCALE			4		// dots per module
+#define	BC_C128_MODULE		2		// dots per module
+#define	BC_C128_HEIGHT		50		// dots
+#define	BC_C128_MAX			64		// data characters
+#define	BC_C128_MODULES_MAX	((BC_C128_MAX + 3) * 11 + 2)
+#define	BC_MODULES_MAX		(BC_C128_MODULES_MAX > BC_QR_SIZE_MAX ? \
+								BC_C128_MODULES_MAX : BC_QR_SIZE_MAX)
+#define	BC_DOTS_MAX			8
+#define	BC_DATA_MAX			64
+
+#define	BC_CACHE_SIZE		64		// direct mapped cache entries
+
+enum {
+	BC_SYM_C128 = 0,
+	BC_SYM_QR,
+};
+
+enum {
+	BC_MODE_NATIVE = 0,
+	BC_MODE_BITMAP,
+};
+
+//------------------------------------------------------------------------------
+typedef struct bc_param__t {
+	int		sym;
+	int		mode;
+	int		lang;
+	int		x, y;
+	// QR : dots per module, Code128 : module width / bar height
+	int		scale;
+	int		height;
+}	bc_param_t;
+
+typedef struct bc_entry__t {
+	uint_t	hash;
+	int		key;
+	char	data[BC_DATA_MAX +1];
+	char	*out;
+	int		len;
+}	bc_entry_t;
+
+typedef struct bc_cache__t {
+	bc_entry_t	entry[BC_CACHE_SIZE];
+	ulong_t		hit, miss;
+}	bc_cache_t;
+
+//------------------------------------------------------------------------------
+extern int	bc_code128		(const char *s, int len, byte_t *modules, int size);
+extern int	bc_qr			(const char *s, int len, byte_t m[][BC_QR_SIZE_MAX]);
+extern int	bc_pack			(const byte_t *mods, int stride, int w, int h,
+								int sx, int sy, bool invert,
+								byte_t *out, int size, int *bpr);
+extern int	bc_max_len		(const bc_param_t *p, int data_max);
+extern int	bc_emit			(const bc_param_t *p, const char *s, int len,
+								char *out, int size);
+extern int	bc_cached		(bc_cache_t *c, int key, const bc_param_t *p,
+								const char *s, int len, char *out, int size);
+extern void	bc_cache_free	(bc_cache_t *c);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __USBLP_CODE_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
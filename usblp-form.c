@@ -0,0 +1,404 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 USB Label printer form template. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "typedefs.h"
+#include "usblp-form.h"
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+const char *USBLP_EPL_FORM =
+	"I8,0,001\n"
+	"Q78,16\n"
+	"q240\n"
+	"rN\n"
+	"S4\n"
+	"D15\n"
+	"ZB\n"
+	"JF\n"
+	"O\n"
+	"R304,10\n"
+	"f100\n"
+	"N\n"
+	"A10,0,0,2,1,1,N,\"EPL Printer Test\"\n"
+	"A16,32,0,2,1,1,N,\"{MAC}\"\n"
+	"P{COPIES}\n";
+
+const char *USBLP_ZPL_FORM =
+	"^XA\n"
+	"^CFC\n"
+	"^LH0,0\n"
+	"^FO310,25^FDZPL Printer Test^FS\n"
+	"^FO316,55^FD{MAC}^FS\n"
+	"^PQ{COPIES}\n"
+	"^XZ\n";
+
+// EPL 'b' (QR) is not in every EPL firmware, QR goes as a graphic.
+const char *USBLP_EPL_CODE_FORM =
+	"I8,0,001\n"
+	"Q78,16\n"
+	"q240\n"
+	"rN\n"
+	"S4\n"
+	"D15\n"
+	"ZB\n"
+	"JF\n"
+	"O\n"
+	"R304,10\n"
+	"f100\n"
+	"N\n"
+	"A10,0,0,2,1,1,N,\"{MAC}\"\n"
+	"{C128:MAC,10,28,1,40}"
+	"{QR_BMP:MAC,150,0,3}"
+	"P{COPIES}\n";
+
+const char *USBLP_ZPL_CODE_FORM =
+	"^XA\n"
+	"^CFC\n"
+	"^LH0,0\n"
+	"^FO310,10^FD{MAC}^FS\n"
+	"{C128:MAC,310,40,1,40}"
+	"{QR:MAC,560,0,3}"
+	"^PQ{COPIES}\n"
+	"^XZ\n";
+
+//------------------------------------------------------------------------------
+static const struct {
+	const char	*name;
+	int			max_len;
+}	LBL_FIELDS[LBL_FIELD_END] = {
+	[LBL_FIELD_MAC]    = { "MAC",    17 },
+	[LBL_FIELD_SERIAL] = { "SERIAL", LBL_SERIAL_MAX },
+	[LBL_FIELD_IP]     = { "IP",     15 },
+	[LBL_FIELD_DATE]   = { "DATE",   10 },
+	[LBL_FIELD_COUNT]  = { "COUNT",  10 },
+	[LBL_FIELD_COPIES] = { "COPIES", 10 },
+};
+
+static const struct {
+	const char	*name;
+	int			sym;
+	int			mode;
+	int			scale;
+	int			height;
+}	LBL_CODES[] = {
+	{ "C128",     BC_SYM_C128, BC_MODE_NATIVE, BC_C128_MODULE, BC_C128_HEIGHT },
+	{ "QR",       BC_SYM_QR,   BC_MODE_NATIVE, BC_QR_SCALE,    0 },
+	{ "C128_BMP", BC_SYM_C128, BC_MODE_BITMAP, BC_C128_MODULE, BC_C128_HEIGHT },
+	{ "QR_BMP",   BC_SYM_QR,   BC_MODE_BITMAP, BC_QR_SCALE,    0 },
+};
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+//------------------------------------------------------------------------------
+static 	int		field_lookup	(const char *name, int len);
+static	int		code_parse		(lbl_prog_t *prog, const char *s, int len);
+static	int		emit_lit		(lbl_prog_t *prog, const char *s, int len);
+static 	char	*put_dec		(char *p, uint_t v);
+static 	char	*put_date		(lbl_prog_t *prog, char *p, time_t date);
+static	char	*put_field		(lbl_prog_t *prog, int id, const lbl_fields_t *f,
+									char *p);
+		int		lbl_compile		(lbl_prog_t *prog, int lang, const char *form);
+		int		lbl_render		(lbl_prog_t *prog, const lbl_fields_t *f,
+									char *buf, int size);
+		int		lbl_fields_equal(const lbl_prog_t *prog,
+									const lbl_fields_t *a, const lbl_fields_t *b);
+		void	lbl_free		(lbl_prog_t *prog);
+
+//------------------------------------------------------------------------------
+static int field_lookup (const char *name, int len)
+{
+	int i;
+
+	for (i = 0; i < LBL_FIELD_END; i++) {
+		if (((int)strlen(LBL_FIELDS[i].name) == len) &&
+			!strncmp(LBL_FIELDS[i].name, name, len))
+			return i;
+	}
+	return -1;
+}
+
+//------------------------------------------------------------------------------
+// barcode slot "NAME:FIELD,x,y[,scale[,height]]". return slot or -1.
+//------------------------------------------------------------------------------
+static int code_parse (lbl_prog_t *prog, const char *s, int len)
+{
+	const char *colon = memchr (s, ':', len), *end = s + len, *p;
+	bc_param_t *bc = &prog->bc[prog->bcs];
+	int i, id, n, v[4];
+	char *next;
+
+	if ((colon == NULL) || (prog->bcs >= LBL_CODE_MAX))
+		return -1;
+
+	for (i = 0; i < (int)(sizeof(LBL_CODES) / sizeof(LBL_CODES[0])); i++) {
+		if (((int)strlen(LBL_CODES[i].name) == colon - s) &&
+			!strncmp(LBL_CODES[i].name, s, colon - s))
+			break;
+	}
+	if (i == (int)(sizeof(LBL_CODES) / sizeof(LBL_CODES[0])))
+		return -1;
+
+	if ((p = memchr (colon, ',', end - colon)) == NULL)
+		return -1;
+	if ((id = field_lookup (colon + 1, p - colon - 1)) < 0)
+		return -1;
+
+	v[2] = LBL_CODES[i].scale;
+	v[3] = LBL_CODES[i].height;
+	for (n = 0; (n < 4) && (p < end) && (*p == ','); n++) {
+		v[n] = strtol (p + 1, &next, 10);
+		if ((next == p + 1) || (v[n] < 0))
+			return -1;
+		p = next;
+	}
+	if ((p != end) || (n < 2) || (v[2] < 1) || (v[2] > BC_DOTS_MAX))
+		return -1;
+
+	bc->sym    = LBL_CODES[i].sym;
+	bc->mode   = LBL_CODES[i].mode;
+	bc->lang   = prog->lang;
+	bc->x      = v[0];
+	bc->y      = v[1];
+	bc->scale  = v[2];
+	bc->height = v[3] ? v[3] : 1;
+	prog->bc_field[prog->bcs] = id;
+	return prog->bcs++;
+}
+
+//------------------------------------------------------------------------------
+static int emit_lit (lbl_prog_t *prog, const char *s, int len)
+{
+	while (len > 0) {
+		int chunk = len > 0xFFFF ? 0xFFFF : len;
+
+		if (prog->size + chunk + 4 > LBL_PROG_MAX)
+			return 0;
+		prog->code[prog->size++] = LBL_OP_LIT;
+		prog->code[prog->size++] = (chunk     ) & 0xFF;
+		prog->code[prog->size++] = (chunk >> 8) & 0xFF;
+		memcpy (&prog->code[prog->size], s, chunk);
+		prog->size    += chunk;
+		prog->max_len += chunk;
+		s += chunk;	len -= chunk;
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// compile the form text into a byte program. (literal span + field slot)
+//------------------------------------------------------------------------------
+int lbl_compile (lbl_prog_t *prog, int lang, const char *form)
+{
+	const char *p = form, *lit = form, *end;
+	int id;
+
+	memset (prog, 0, sizeof(lbl_prog_t));
+	prog->lang     = lang;
+	prog->date_key = -1;
+
+	while ((p = strchr(p, '{')) != NULL) {
+		if ((end = strchr(p, '}')) == NULL)
+			break;
+		if ((id = field_lookup(p + 1, end - p - 1)) >= 0) {
+			if (!emit_lit (prog, lit, p - lit))
+				goto overflow;
+			if (prog->size + 3 > LBL_PROG_MAX)
+				goto overflow;
+			prog->code[prog->size++] = LBL_OP_FIELD;
+			prog->code[prog->size++] = id;
+			prog->max_len += LBL_FIELDS[id].max_len;
+			prog->fields  |= 1 << id;
+		} else if ((id = code_parse(prog, p + 1, end - p - 1)) >= 0) {
+			if (!emit_lit (prog, lit, p - lit))
+				goto overflow;
+			if (prog->size + 3 > LBL_PROG_MAX)
+				goto overflow;
+			prog->code[prog->size++] = LBL_OP_CODE;
+			prog->code[prog->size++] = id;
+			prog->max_len += bc_max_len (&prog->bc[id],
+									LBL_FIELDS[prog->bc_field[id]].max_len);
+			prog->fields  |= 1 << prog->bc_field[id];
+		} else {
+			// unknown token is copied as literal text.
+			p++;
+			continue;
+		}
+		p = lit = end + 1;
+	}
+	if (!emit_lit (prog, lit, strlen(lit)))
+		goto overflow;
+	prog->code[prog->size++] = LBL_OP_END;
+	return 1;
+overflow:
+	err ("label form is too large (max %d bytes)\n", LBL_PROG_MAX);
+	prog->size = 0;
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+static char *put_dec (char *p, uint_t v)
+{
+	char tmp[10];
+	int i = 0;
+
+	do {
+		tmp[i++] = '0' + (v % 10);
+		v /= 10;
+	} while (v);
+
+	while (i)
+		*p++ = tmp[--i];
+	return p;
+}
+
+//------------------------------------------------------------------------------
+static char *put_date (lbl_prog_t *prog, char *p, time_t date)
+{
+	// localtime only when the minute changes.
+	if (prog->date_key != (date / 60)) {
+		struct tm tm;
+		int y;
+
+		localtime_r (&date, &tm);
+		y = tm.tm_year + 1900;
+		prog->date_text[0] = '0' + (y / 1000) % 10;
+		prog->date_text[1] = '0' + (y / 100) % 10;
+		prog->date_text[2] = '0' + (y / 10) % 10;
+		prog->date_text[3] = '0' + (y     ) % 10;
+		prog->date_text[4] = '-';
+		prog->date_text[5] = '0' + (tm.tm_mon + 1) / 10;
+		prog->date_text[6] = '0' + (tm.tm_mon + 1) % 10;
+		prog->date_text[7] = '-';
+		prog->date_text[8] = '0' + tm.tm_mday / 10;
+		prog->date_text[9] = '0' + tm.tm_mday % 10;
+		prog->date_key = date / 60;
+	}
+	memcpy (p, prog->date_text, sizeof(prog->date_text));
+	return p + sizeof(prog->date_text);
+}
+
+//------------------------------------------------------------------------------
+static char *put_field (lbl_prog_t *prog, int id, const lbl_fields_t *f, char *p)
+{
+	int i;
+
+	switch (id) {
+	case	LBL_FIELD_MAC:
+		for (i = 0; i < 6; i++) {
+			*p++ = HEX_DIGITS[f->mac[i] >> 4];
+			*p++ = HEX_DIGITS[f->mac[i] & 0x0F];
+			if (i < 5)
+				*p++ = ':';
+		}
+		break;
+	case	LBL_FIELD_SERIAL:
+		for (i = 0; (i < LBL_SERIAL_MAX) && f->serial[i]; i++)
+			*p++ = f->serial[i];
+		break;
+	case	LBL_FIELD_IP:
+		{
+			const byte_t *ip = (const byte_t *)&f->ip;
+			for (i = 0; i < 4; i++) {
+				p = put_dec (p, ip[i]);
+				if (i < 3)
+					*p++ = '.';
+			}
+		}
+		break;
+	case	LBL_FIELD_DATE:
+		p = put_date (prog, p, f->date);
+		break;
+	case	LBL_FIELD_COUNT:
+		p = put_dec (p, f->count);
+		break;
+	case	LBL_FIELD_COPIES:
+		p = put_dec (p, f->copies ? f->copies : 1);
+		break;
+	}
+	return p;
+}
+
+//------------------------------------------------------------------------------
+// render the label into buf. return rendered size or -1(buffer too small)
+//------------------------------------------------------------------------------
+int lbl_render (lbl_prog_t *prog, const lbl_fields_t *f, char *buf, int size)
+{
+	const byte_t *pc = prog->code;
+	char *p = buf, text[BC_DATA_MAX +1];
+	int len, slot;
+
+	// checked once, the loop below never overruns buf.
+	if (!prog->size || (size < prog->max_len))
+		return -1;
+
+	while (true) {
+		switch (*pc++) {
+		case	LBL_OP_LIT:
+			len = pc[0] | (pc[1] << 8);
+			memcpy (p, pc + 2, len);
+			p += len;	pc += len + 2;
+			break;
+		case	LBL_OP_FIELD:
+			p = put_field (prog, *pc++, f, p);
+			break;
+		case	LBL_OP_CODE:
+			slot = *pc++;
+			len  = put_field (prog, prog->bc_field[slot], f, text) - text;
+			text[len] = 0;
+			if ((prog->cache == NULL) &&
+				((prog->cache = calloc (1, sizeof(bc_cache_t))) == NULL))
+				len = bc_emit (&prog->bc[slot], text, len,
+								p, size - (p - buf));
+			else
+				len = bc_cached (prog->cache, slot, &prog->bc[slot], text, len,
+								p, size - (p - buf));
+			// not encodable value (e.g. non ascii serial) : no label without it.
+			if (len < 0) {
+				err ("barcode %d : can't encode \"%s\"\n", slot, text);
+				return -1;
+			}
+			p += len;
+			break;
+		default :
+		case	LBL_OP_END:
+			return p - buf;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// same label content? (copies are not compared, the label counter only if
+// the form prints it)
+//------------------------------------------------------------------------------
+int lbl_fields_equal (const lbl_prog_t *prog,
+						const lbl_fields_t *a, const lbl_fields_t *b)
+{
+	return	!memcmp (a->mac, b->mac, sizeof(a->mac)) &&
+			!strncmp(a->serial, b->serial, LBL_SERIAL_MAX) &&
+			(a->ip    == b->ip)   &&
+			(a->date / 60 == b->date / 60) &&
+			(!(prog->fields & (1 << LBL_FIELD_COUNT)) || (a->count == b->count));
+}
+
+//------------------------------------------------------------------------------
+// release the barcode cache. (lbl_compile does not free the old one)
+//------------------------------------------------------------------------------
+void lbl_free (lbl_prog_t *prog)
+{
+	if (prog->cache) {
+		bc_cache_free (prog->cache);
+		free (prog->cache);
+		prog->cache = NULL;
+	}
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 USB Label printer form template. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __USBLP_FORM_H__
+#define __USBLP_FORM_H__
+
+#include <time.h>
+#include "typedefs.h"
+#include "usblp-code.h"
+//------------------------------------------------------------------------------
+/*
+	Label template syntax : printer commands(EPL or ZPL) with field slots.
+
+	{MAC}       00:1E:06:12:34:56  (6 byte hw address)
+	{SERIAL}    serial number string (max LBL_SERIAL_MAX)
+	{IP}        192.168.0.10       (ipv4, network byte order)
+	{DATE}      2022-12-01
+	{COUNT}     label counter      (decimal)
+	{COPIES}    copy count         (decimal, used by P<n> / ^PQ<n>)
+
+	Barcode slots (field value encoded by usblp-code.c) :
+	{C128:FIELD,x,y[,module[,height]]}      printer Code128 command
+	{QR:FIELD,x,y[,scale]}                  printer QR command
+	{C128_BMP:FIELD,x,y[,module[,height]]}  Code128 graphic (GW / ^GF)
+	{QR_BMP:FIELD,x,y[,scale]}              QR graphic (GW / ^GF)
+
+	The template is compiled once into a byte program.
+	program : [LBL_OP_LIT][len lo][len hi][literal bytes...]
+	          [LBL_OP_FIELD][field id]
+	          [LBL_OP_CODE][barcode slot]
+	          ...
+	          [LBL_OP_END]
+*/
+//------------------------------------------------------------------------------
+#define	LBL_PROG_MAX		2048
+#define	LBL_SERIAL_MAX		32
+#define	LBL_CODE_MAX		4		// barcode slots per form
+
+#define	LBL_OP_END			0x00
+#define	LBL_OP_LIT			0x01
+#define	LBL_OP_FIELD		0x02
+#define	LBL_OP_CODE			0x03
+
+enum {
+	LBL_FIELD_MAC = 0,
+	LBL_FIELD_SERIAL,
+	LBL_FIELD_IP,
+	LBL_FIELD_DATE,
+	LBL_FIELD_COUNT,
+	LBL_FIELD_COPIES,
+	LBL_FIELD_END
+};
+
+enum {
+	LBL_LANG_EPL = 0,
+	LBL_LANG_ZPL,
+};
+
+//------------------------------------------------------------------------------
+typedef struct lbl_fields__t {
+	byte_t		mac[6];
+	char		serial[LBL_SERIAL_MAX +1];
+	uint_t		ip;
+	time_t		date;
+	uint_t		count;
+	uint_t		copies;
+}	lbl_fields_t;
+
+typedef struct lbl_prog__t {
+	byte_t		code[LBL_PROG_MAX];
+	int			size;
+	int			lang;
+	// max rendered size (literals + max field width)
+	int			max_len;
+	// fields printed, 1 << LBL_FIELD_xxx (text or barcode)
+	uint_t		fields;
+
+	// date field cache (date text changes once a day)
+	time_t		date_key;
+	char		date_text[10];
+
+	// barcode slots and the encoded output cache (allocated on first use)
+	bc_param_t	bc[LBL_CODE_MAX];
+	byte_t		bc_field[LBL_CODE_MAX];
+	int			bcs;
+	bc_cache_t	*cache;
+}	lbl_prog_t;
+
+//------------------------------------------------------------------------------
+extern int	lbl_compile	(lbl_prog_t *prog, int lang, const char *form);
+extern int	lbl_render	(lbl_prog_t *prog, const lbl_fields_t *f,
+							char *buf, int size);
+extern int	lbl_fields_equal (const lbl_prog_t *prog,
+							const lbl_fields_t *a, const lbl_fields_t *b);
+extern void	lbl_free	(lbl_prog_t *prog);
+
+extern const char *USBLP_EPL_FORM;
+extern const char *USBLP_ZPL_FORM;
+extern const char *USBLP_EPL_CODE_FORM;
+extern const char *USBLP_ZPL_CODE_FORM;
+
+//------------------------------------------------------------------------------
+#endif  //  #define __USBLP_FORM_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
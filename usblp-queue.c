@@ -0,0 +1,556 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 USB Label printer job queue. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "typedefs.h"
+#include "idle.h"
+#include "usblp-form.h"
+#include "usblp-queue.h"
+
+//------------------------------------------------------------------------------
+// form text [form][lang]
+//------------------------------------------------------------------------------
+static const char **USBLP_FORMS[USBLP_FORM_END][2] = {
+	[USBLP_FORM_TEST] = { &USBLP_EPL_FORM, &USBLP_ZPL_FORM },
+	[USBLP_FORM_CODE] = { &USBLP_EPL_CODE_FORM, &USBLP_ZPL_CODE_FORM },
+};
+
+//------------------------------------------------------------------------------
+// one entry per attached printer (cups queue), served by its own worker.
+//------------------------------------------------------------------------------
+typedef struct usblp__t {
+	char			lpq[32];
+	char			uri[512];
+	int				lang;
+	int				gen;
+
+	pthread_t		thread;
+	pthread_cond_t	cond;
+	bool			run;
+
+	// job ring buffer
+	usblp_job_t		jobs[USBLP_QUEUE_MAX];
+	int				head, count;
+	// labels waiting / labels in the current transfer
+	int				pending, inflight;
+	// printer status readback (usblp-status.c)
+	bool			ready;
+	ulong_t			t_retry;
+
+	usblp_stats_t	stats;
+
+	// worker only (own copy of the forms : date / barcode caches)
+	lbl_prog_t		progs[USBLP_FORM_END][2];
+	usblp_job_t		batch[USBLP_BATCH_MAX];
+	char			buf[USBLP_BATCH_SIZE];
+}	usblp_t;
+
+static usblp_t			Printers[USBLP_MAX];
+static int				PrinterCount = 0;
+static pthread_mutex_t	Lock = PTHREAD_MUTEX_INITIALIZER;
+
+static lbl_prog_t		Progs[USBLP_FORM_END][2];
+static bool				ProgsReady = false;
+
+//------------------------------------------------------------------------------
+static	ulong_t	usblp_usec			(void);
+static	int		job_labels			(const usblp_job_t *job);
+static	int		usblp_push			(usblp_t *lp, const usblp_job_t *job, bool front);
+static	int		usblp_pick			(usblp_t *exclude);
+static	void	usblp_failover		(usblp_t *lp);
+static	void	usblp_failover_all	(void);
+static	int		usblp_transfer		(const char *lpq, const char *buf, int size);
+static	int		usblp_batch			(usblp_t *lp, int *count, const char *lpq, int lang);
+static	void	*usblp_worker		(void *arg);
+static	int		usblp_compile		(void);
+		int		usblp_queue_add		(const char *lpq, const char *uri, int lang, int gen);
+		void	usblp_queue_sweep	(int gen);
+		void	usblp_queue_stop	(void);
+		int		usblp_print			(int form, const lbl_fields_t *f);
+		int		usblp_print_to		(int idx, int form, const lbl_fields_t *f);
+		int		usblp_queue_stats	(int idx, usblp_stats_t *s);
+		void	usblp_queue_ready	(int idx, bool ready);
+
+//------------------------------------------------------------------------------
+static ulong_t usblp_usec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+static int job_labels (const usblp_job_t *job)
+{
+	return job->fields.copies ? job->fields.copies : 1;
+}
+
+//------------------------------------------------------------------------------
+// (Lock held) add a job to the printer ring.
+//------------------------------------------------------------------------------
+static int usblp_push (usblp_t *lp, const usblp_job_t *job, bool front)
+{
+	if (lp->count >= USBLP_QUEUE_MAX)
+		return 0;
+
+	if (front) {
+		lp->head = (lp->head + USBLP_QUEUE_MAX - 1) % USBLP_QUEUE_MAX;
+		lp->jobs[lp->head] = *job;
+	} else
+		lp->jobs[(lp->head + lp->count) % USBLP_QUEUE_MAX] = *job;
+
+	lp->count++;
+	lp->pending += job_labels (job);
+	if (lp->count > lp->stats.depth_max)
+		lp->stats.depth_max = lp->count;
+
+	pthread_cond_signal (&lp->cond);
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// (Lock held) least outstanding work printer. error printers are used only
+// when no healthy printer is left, so the jobs wait there for the retry.
+//------------------------------------------------------------------------------
+static int usblp_pick (usblp_t *exclude)
+{
+	int i, best = -1, weight, best_weight = 0;
+	bool best_ok = false;
+
+	for (i = 0; i < PrinterCount; i++) {
+		usblp_t *lp = &Printers[i];
+		bool ok = (lp->stats.state == USBLP_STATE_OK) && lp->ready;
+
+		if ((lp == exclude) || (lp->count >= USBLP_QUEUE_MAX))
+			continue;
+		if (!ok && (lp->stats.state != USBLP_STATE_ERROR))
+			continue;
+		if (!ok && (exclude != NULL))
+			continue;
+
+		weight = lp->pending + lp->inflight;
+		if ((best < 0) || (ok && !best_ok) ||
+			((ok == best_ok) && (weight < best_weight))) {
+			best = i;	best_weight = weight;	best_ok = ok;
+		}
+	}
+	return best;
+}
+
+//------------------------------------------------------------------------------
+// (Lock held) move the waiting jobs to the other healthy printers.
+//------------------------------------------------------------------------------
+static void usblp_failover (usblp_t *lp)
+{
+	usblp_job_t *job;
+	int idx;
+
+	while (lp->count) {
+		if ((idx = usblp_pick (lp)) < 0)
+			break;
+
+		job = &lp->jobs[lp->head];
+		if (!usblp_push (&Printers[idx], job, false))
+			break;
+
+		lp->head = (lp->head + 1) % USBLP_QUEUE_MAX;
+		lp->count--;
+		lp->pending -= job_labels (job);
+		lp->stats.failover++;
+	}
+}
+
+//------------------------------------------------------------------------------
+static void usblp_failover_all (void)
+{
+	int i;
+
+	for (i = 0; i < PrinterCount; i++) {
+		if ((Printers[i].stats.state != USBLP_STATE_OK) || !Printers[i].ready)
+			usblp_failover (&Printers[i]);
+	}
+}
+
+//------------------------------------------------------------------------------
+// one lpr per batch. (raw data through the pipe, no spool file)
+//------------------------------------------------------------------------------
+static int usblp_transfer (const char *lpq, const char *buf, int size)
+{
+	FILE *fp;
+	char cmd_line[64];
+	int ret;
+
+	snprintf (cmd_line, sizeof(cmd_line), "lpr -P %s", lpq);
+	if ((fp = popen(cmd_line, "w")) == NULL)
+		return 0;
+
+	ret = (fwrite (buf, 1, size, fp) == (size_t)size);
+	if (pclose(fp))
+		ret = 0;
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// render the batch into one buffer, identical labels become one form (copies)
+// jobs that can't be rendered are dropped, *count : the jobs left.
+//------------------------------------------------------------------------------
+static int usblp_batch (usblp_t *lp, int *count, const char *lpq, int lang)
+{
+	usblp_job_t *batch = lp->batch;
+	lbl_fields_t fields;
+	bool failed[USBLP_BATCH_MAX];
+	int i, j, k, len, ret, labels, depth, n = *count, dropped = 0;
+	ulong_t t_start, now, latency, avg, max;
+
+	for (i = 0, len = 0, labels = 0; i < n; i = j) {
+		fields = batch[i].fields;
+		fields.copies = job_labels (&batch[i]);
+
+		for (j = i + 1; j < n; j++) {
+			if ((batch[j].form != batch[i].form) ||
+				!lbl_fields_equal (&lp->progs[batch[i].form][lang],
+									&batch[j].fields, &batch[i].fields))
+				break;
+			fields.copies += job_labels (&batch[j]);
+		}
+		ret = lbl_render (&lp->progs[batch[i].form][lang], &fields,
+							&lp->buf[len], sizeof(lp->buf) - len);
+		for (k = i; k < j; k++)
+			failed[k] = (ret < 0);
+		if (ret < 0) {
+			err ("label render error. (form = %d)\n", batch[i].form);
+			dropped += j - i;
+			continue;
+		}
+		len += ret;	labels += fields.copies;
+	}
+	// dropped jobs out of the batch. (not counted, not put back on an error)
+	for (i = 0, j = 0; i < n; i++) {
+		if (!failed[i])
+			batch[j++] = batch[i];
+	}
+	*count = n = j;
+
+	t_start = usblp_usec ();
+	ret = len ? usblp_transfer (lpq, lp->buf, len) : 1;
+	now = usblp_usec ();
+
+	pthread_mutex_lock (&Lock);
+	lp->stats.batches++;
+	lp->stats.render_errors += dropped;
+	if (ret) {
+		lp->stats.jobs   += n;
+		lp->stats.labels += labels;
+		lp->stats.bytes  += len;
+		if (now > t_start)
+			lp->stats.throughput += ((long)(labels * 60000000UL / (now - t_start))
+									- (long)lp->stats.throughput) / 8;
+		for (i = 0; i < n; i++) {
+			latency = now - batch[i].t_enq;
+			if (latency > lp->stats.latency_max)
+				lp->stats.latency_max = latency;
+			// ewma 1/8
+			lp->stats.latency_avg += ((long)latency - (long)lp->stats.latency_avg) / 8;
+		}
+	} else
+		lp->stats.errors++;
+	// summary of the locked values.
+	depth = lp->count;
+	avg   = lp->stats.latency_avg;
+	max   = lp->stats.latency_max;
+	pthread_mutex_unlock (&Lock);
+
+	info ("usblp : %s batch %d jobs (%d labels, %d bytes, %d dropped) %s, "
+			"depth = %d, latency avg = %lu us, max = %lu us\n",
+			lpq, n, labels, len, dropped, ret ? "done" : "error", depth, avg, max);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+static void *usblp_worker (void *arg)
+{
+	usblp_t *lp = (usblp_t *)arg;
+	char lpq[sizeof(lp->lpq)];
+	int n, i, lang, size;
+
+	pthread_mutex_lock (&Lock);
+	while (lp->run) {
+		if (!lp->count) {
+			pthread_cond_wait (&lp->cond, &Lock);
+			idle_wakeup ();
+			continue;
+		}
+		if ((lp->stats.state != USBLP_STATE_OK) || !lp->ready) {
+			usblp_failover (lp);
+			if (!lp->count)
+				continue;
+			// no other printer. jobs wait here for the retry / new printer.
+			if ((lp->stats.state == USBLP_STATE_GONE) || !lp->ready ||
+				(usblp_usec () < lp->t_retry)) {
+				struct timespec ts;
+				clock_gettime (CLOCK_REALTIME, &ts);
+				ts.tv_sec += 1;
+				pthread_cond_timedwait (&lp->cond, &Lock, &ts);
+				idle_wakeup ();
+				continue;
+			}
+		}
+		// take all pending jobs (up to the batch size) at once.
+		lang = lp->lang;
+		for (n = 0, size = 0; (n < USBLP_BATCH_MAX) && lp->count; n++) {
+			size += lp->progs[lp->jobs[lp->head].form][lang].max_len;
+			if (n && (size > USBLP_BATCH_SIZE))
+				break;
+			lp->batch[n] = lp->jobs[lp->head];
+			lp->head = (lp->head + 1) % USBLP_QUEUE_MAX;
+			lp->count--;
+			lp->pending  -= job_labels (&lp->batch[n]);
+			lp->inflight += job_labels (&lp->batch[n]);
+		}
+		memcpy (lpq, lp->lpq, sizeof(lpq));
+		pthread_mutex_unlock (&Lock);
+
+		i = usblp_batch (lp, &n, lpq, lang);
+
+		pthread_mutex_lock (&Lock);
+		lp->inflight = 0;
+		if (i) {
+			if (lp->stats.state == USBLP_STATE_ERROR)
+				lp->stats.state = USBLP_STATE_OK;
+			continue;
+		}
+		// transfer error : put the batch back and hand it to the others.
+		if (lp->stats.state == USBLP_STATE_OK)
+			lp->stats.state = USBLP_STATE_ERROR;
+		lp->t_retry = usblp_usec () + USBLP_RETRY_SEC * 1000000UL;
+		for (i = n - 1; i >= 0; i--) {
+			if (!usblp_push (lp, &lp->batch[i], true))
+				err ("%s : queue full, job dropped.\n", lpq);
+		}
+		usblp_failover (lp);
+	}
+	pthread_mutex_unlock (&Lock);
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int usblp_compile (void)
+{
+	int form, lang;
+
+	if (ProgsReady)
+		return 1;
+
+	for (form = 0; form < USBLP_FORM_END; form++) {
+		for (lang = LBL_LANG_EPL; lang <= LBL_LANG_ZPL; lang++) {
+			if (!lbl_compile (&Progs[form][lang], lang, *USBLP_FORMS[form][lang]))
+				return 0;
+			if (Progs[form][lang].max_len > USBLP_LABEL_MAX) {
+				err ("label form %d is too large.\n", form);
+				return 0;
+			}
+		}
+	}
+	ProgsReady = true;
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// add (or refresh) a printer. return printer index or -1.
+//------------------------------------------------------------------------------
+int usblp_queue_add (const char *lpq, const char *uri, int lang, int gen)
+{
+	usblp_t *lp = NULL;
+	int i;
+
+	if (!usblp_compile ())
+		return -1;
+
+	pthread_mutex_lock (&Lock);
+	// same device or same cups queue name.
+	for (i = 0; (i < PrinterCount) && (lp == NULL); i++) {
+		if (!strcmp (Printers[i].uri, uri))
+			lp = &Printers[i];
+	}
+	for (i = 0; (i < PrinterCount) && (lp == NULL); i++) {
+		if (!strcmp (Printers[i].lpq, lpq))
+			lp = &Printers[i];
+	}
+	if (lp == NULL) {
+		if (PrinterCount >= USBLP_MAX) {
+			pthread_mutex_unlock (&Lock);
+			err ("too many label printers. (max %d)\n", USBLP_MAX);
+			return -1;
+		}
+		lp = &Printers[PrinterCount++];
+		pthread_cond_init (&lp->cond, NULL);
+		lp->ready = true;
+		memcpy (lp->progs, Progs, sizeof(Progs));
+	}
+
+	strncpy (lp->lpq, lpq, sizeof(lp->lpq) - 1);
+	strncpy (lp->uri, uri, sizeof(lp->uri) - 1);
+	strncpy (lp->stats.lpq, lpq, sizeof(lp->stats.lpq) - 1);
+	lp->lang = lang;
+	lp->gen  = gen;
+	lp->stats.state = USBLP_STATE_OK;
+
+	if (!lp->run) {
+		lp->run = true;
+		if (pthread_create (&lp->thread, NULL, usblp_worker, lp)) {
+			err ("%s : usblp worker thread create fail!\n", lpq);
+			lp->run = false;
+			lp->stats.state = USBLP_STATE_ERROR;
+		}
+	}
+	// jobs waiting on a failed printer can go to this one now.
+	usblp_failover_all ();
+	pthread_cond_signal (&lp->cond);
+	pthread_mutex_unlock (&Lock);
+
+	return lp - Printers;
+}
+
+//------------------------------------------------------------------------------
+// printers not found in this scan (gen) are gone.
+//------------------------------------------------------------------------------
+void usblp_queue_sweep (int gen)
+{
+	int i;
+
+	pthread_mutex_lock (&Lock);
+	for (i = 0; i < PrinterCount; i++) {
+		usblp_t *lp = &Printers[i];
+
+		if ((lp->gen != gen) && (lp->stats.state != USBLP_STATE_GONE)) {
+			info ("usblp : %s removed.\n", lp->lpq);
+			lp->stats.state = USBLP_STATE_GONE;
+			usblp_failover (lp);
+			pthread_cond_signal (&lp->cond);
+		}
+	}
+	pthread_mutex_unlock (&Lock);
+}
+
+//------------------------------------------------------------------------------
+void usblp_queue_stop (void)
+{
+	int i;
+
+	pthread_mutex_lock (&Lock);
+	for (i = 0; i < PrinterCount; i++) {
+		Printers[i].run = false;
+		pthread_cond_signal (&Printers[i].cond);
+	}
+	pthread_mutex_unlock (&Lock);
+
+	for (i = 0; i < PrinterCount; i++) {
+		int form;
+
+		pthread_join (Printers[i].thread, NULL);
+		for (form = 0; form < USBLP_FORM_END; form++) {
+			lbl_free (&Printers[i].progs[form][LBL_LANG_EPL]);
+			lbl_free (&Printers[i].progs[form][LBL_LANG_ZPL]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// enqueue a label job. never blocks, return 0 if no printer can take it.
+//------------------------------------------------------------------------------
+int usblp_print (int form, const lbl_fields_t *f)
+{
+	usblp_job_t job;
+	int idx, ret = 0;
+
+	if ((form < 0) || (form >= USBLP_FORM_END))
+		return 0;
+
+	job.form   = form;
+	job.fields = *f;
+	job.t_enq  = usblp_usec ();
+
+	pthread_mutex_lock (&Lock);
+	if ((idx = usblp_pick (NULL)) >= 0)
+		ret = usblp_push (&Printers[idx], &job, false);
+	pthread_mutex_unlock (&Lock);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// enqueue a label job to the given printer. (printer test)
+//------------------------------------------------------------------------------
+int usblp_print_to (int idx, int form, const lbl_fields_t *f)
+{
+	usblp_job_t job;
+	int ret = 0;
+
+	if ((form < 0) || (form >= USBLP_FORM_END))
+		return 0;
+
+	job.form   = form;
+	job.fields = *f;
+	job.t_enq  = usblp_usec ();
+
+	pthread_mutex_lock (&Lock);
+	if ((idx >= 0) && (idx < PrinterCount))
+		ret = usblp_push (&Printers[idx], &job, false);
+	pthread_mutex_unlock (&Lock);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// return 0 if idx is not a printer.
+//------------------------------------------------------------------------------
+int usblp_queue_stats (int idx, usblp_stats_t *s)
+{
+	usblp_t *lp;
+
+	pthread_mutex_lock (&Lock);
+	if ((idx < 0) || (idx >= PrinterCount)) {
+		pthread_mutex_unlock (&Lock);
+		return 0;
+	}
+	lp = &Printers[idx];
+	*s = lp->stats;
+	s->ready       = lp->ready;
+	s->depth       = lp->count;
+	s->outstanding = lp->pending + lp->inflight;
+	pthread_mutex_unlock (&Lock);
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// printer status (paper out, head open ...) gates the jobs of the printer.
+//------------------------------------------------------------------------------
+void usblp_queue_ready (int idx, bool ready)
+{
+	usblp_t *lp;
+
+	pthread_mutex_lock (&Lock);
+	if ((idx >= 0) && (idx < PrinterCount)) {
+		lp = &Printers[idx];
+		if (lp->ready != ready)
+			info ("usblp : %s %s\n", lp->lpq, ready ? "ready" : "not ready");
+		lp->ready = ready;
+		if (ready)
+			usblp_failover_all ();
+		else
+			usblp_failover (lp);
+		pthread_cond_signal (&lp->cond);
+	}
+	pthread_mutex_unlock (&Lock);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,76 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 USB Label printer job queue. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __USBLP_QUEUE_H__
+#define __USBLP_QUEUE_H__
+
+#include "typedefs.h"
+#include "usblp-form.h"
+//------------------------------------------------------------------------------
+#define	USBLP_MAX			4		// attached label printers
+#define	USBLP_QUEUE_MAX		256		// pending jobs (per printer)
+#define	USBLP_BATCH_MAX		64		// jobs per one lpr transfer
+#define	USBLP_LABEL_MAX		8192	// rendered label size (barcode graphics)
+#define	USBLP_BATCH_SIZE	65536	// rendered batch size (one lpr transfer)
+#define	USBLP_RETRY_SEC		5		// error printer retry interval
+
+enum {
+	USBLP_FORM_TEST = 0,
+	USBLP_FORM_CODE,	// mac address Code128 + QR
+	USBLP_FORM_END
+};
+
+enum {
+	USBLP_STATE_NONE = 0,
+	USBLP_STATE_OK,
+	USBLP_STATE_ERROR,	// lpr failed, retry after USBLP_RETRY_SEC
+	USBLP_STATE_GONE,	// printer removed
+};
+
+//------------------------------------------------------------------------------
+typedef struct usblp_job__t {
+	int				form;
+	lbl_fields_t	fields;
+	// enqueue time (usec, monotonic)
+	ulong_t			t_enq;
+}	usblp_job_t;
+
+typedef struct usblp_stats__t {
+	char	lpq[32];
+	int		state;
+	bool	ready;
+	int		depth;
+	int		depth_max;
+	// labels waiting + printing (dispatch weight)
+	int		outstanding;
+	ulong_t	jobs;
+	ulong_t	labels;
+	ulong_t	bytes;
+	ulong_t	batches;
+	ulong_t	errors;
+	// jobs dropped, the label can't be rendered (barcode value)
+	ulong_t	render_errors;
+	ulong_t	failover;
+	// job latency (enqueue -> transfer complete, usec)
+	ulong_t	latency_avg;
+	ulong_t	latency_max;
+	// labels per minute (ewma of the batch transfer rate)
+	ulong_t	throughput;
+}	usblp_stats_t;
+
+//------------------------------------------------------------------------------
+extern int	usblp_queue_add		(const char *lpq, const char *uri, int lang, int gen);
+extern void	usblp_queue_sweep	(int gen);
+extern void	usblp_queue_stop	(void);
+extern int	usblp_print			(int form, const lbl_fields_t *f);
+extern int	usblp_print_to		(int idx, int form, const lbl_fields_t *f);
+extern int	usblp_queue_stats	(int idx, usblp_stats_t *s);
+extern void	usblp_queue_ready	(int idx, bool ready);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __USBLP_QUEUE_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,439 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 USB Label printer status readback. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+
+#include "typedefs.h"
+#include "usblp-form.h"
+#include "usblp-queue.h"
+#include "usblp-status.h"
+
+//------------------------------------------------------------------------------
+// usblp kernel driver (drivers/usb/class/usblp.c)
+//------------------------------------------------------------------------------
+#define	IOCNR_GET_DEVICE_ID		1
+#define	LPIOC_GET_DEVICE_ID(len) _IOC(_IOC_READ, 'P', IOCNR_GET_DEVICE_ID, len)
+
+#define	USBLP_DEV_MAX			16
+
+// EPL : ^ee (error report), ZPL : ~HS (host status)
+#define	EPL_STATUS_QUERY		"\n^ee\n"
+#define	ZPL_STATUS_QUERY		"~HS"
+
+#define	STX		0x02
+#define	ETX		0x03
+
+enum {
+	CHAN_IDLE = 0,
+	CHAN_WAIT,
+};
+
+//------------------------------------------------------------------------------
+typedef struct usblp_chan__t {
+	int				fd;
+	int				lang;
+	int				state;
+	int				lpnum;
+	int				no_resp;
+	bool			ready;
+	ulong_t			t_next, t_sent;
+	char			rx[USBLP_STATUS_RX_MAX];
+	int				rxlen;
+	usblp_status_t	st;
+}	usblp_chan_t;
+
+static usblp_chan_t	Chans[USBLP_MAX];
+
+//------------------------------------------------------------------------------
+static	ulong_t	status_msec		(void);
+static	void	uri_decode		(char *dst, const char *src, int size);
+static	int		id_field		(const char *id, const char *key, char *val, int size);
+static	int		match_device	(int lpnum, const char *uri);
+static	bool	status_fault	(const usblp_status_t *st);
+static	int		parse_zpl		(usblp_chan_t *ch);
+static	int		parse_epl		(usblp_chan_t *ch);
+static	void	chan_update		(int idx, usblp_chan_t *ch);
+static	void	chan_close		(usblp_chan_t *ch);
+static	void	chan_poll		(int idx, usblp_chan_t *ch, ulong_t now);
+		int		usblp_status_attach	(int idx, const char *uri, int lang);
+		void	usblp_status_detach	(int idx);
+		void	usblp_status_poll	(void);
+		int		usblp_status_query	(int idx);
+		int		usblp_status_get	(int idx, usblp_status_t *s);
+		int		usblp_status_fault	(char *msg, int size);
+
+//------------------------------------------------------------------------------
+static ulong_t status_msec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+// cups uri "%20" -> ' '
+//------------------------------------------------------------------------------
+static void uri_decode (char *dst, const char *src, int size)
+{
+	int i;
+
+	for (i = 0; *src && (i < size - 1); i++) {
+		if ((src[0] == '%') && src[1] && src[2]) {
+			char hex[3] = { src[1], src[2], 0 };
+			dst[i] = strtol (hex, NULL, 16);
+			src += 3;
+		} else
+			dst[i] = *src++;
+	}
+	dst[i] = 0;
+}
+
+//------------------------------------------------------------------------------
+// IEEE 1284 device id field. ("MFG:Zebra;MDL:LP 2844;SN:xxx;")
+//------------------------------------------------------------------------------
+static int id_field (const char *id, const char *key, char *val, int size)
+{
+	const char *p = strstr (id, key);
+	int len;
+
+	if (p == NULL)
+		return 0;
+	p += strlen(key);
+	len = strcspn (p, ";");
+	len = len < size - 1 ? len : size - 1;
+	strncpy (val, p, len);
+	val[len] = 0;
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// usb://Zebra/LP%202844?serial=xxx  <-> device id MDL / SN
+//------------------------------------------------------------------------------
+static int match_device (int lpnum, const char *uri)
+{
+	char dev[32], id[1024], model[128], val[128], *p;
+	int fd, len;
+
+	snprintf (dev, sizeof(dev), "%s%d", USBLP_STATUS_DEV, lpnum);
+	if ((fd = open (dev, O_RDWR | O_NONBLOCK)) < 0)
+		return -1;
+
+	memset (id, 0x00, sizeof(id));
+	if (ioctl (fd, LPIOC_GET_DEVICE_ID(sizeof(id) - 1), id) < 0) {
+		close (fd);
+		return -1;
+	}
+	// 2 byte big-endian length + id string
+	len = ((id[0] & 0xFF) << 8) | (id[1] & 0xFF);
+	len = (len > 2) && (len < (int)sizeof(id) - 1) ? len : (int)sizeof(id) - 1;
+	id[len] = 0;
+
+	// model name : usb://{make}/{model}?...
+	if ((p = strstr (uri, "://")) != NULL && (p = strchr (p + 3, '/')) != NULL) {
+		uri_decode (model, p + 1, sizeof(model));
+		model[strcspn (model, "?")] = 0;
+		if (id_field (&id[2], "MDL:", val, sizeof(val)) && strcmp (val, model))
+			goto mismatch;
+	}
+	if ((p = strstr (uri, "serial=")) != NULL) {
+		uri_decode (model, p + 7, sizeof(model));
+		model[strcspn (model, "&")] = 0;
+		if ((id_field (&id[2], "SN:", val, sizeof(val)) ||
+			 id_field (&id[2], "SERN:", val, sizeof(val))) && strcmp (val, model))
+			goto mismatch;
+	}
+	return fd;
+mismatch:
+	close (fd);
+	return -1;
+}
+
+//------------------------------------------------------------------------------
+static bool status_fault (const usblp_status_t *st)
+{
+	if (!st->valid)
+		return false;
+
+	return	st->paper_out || st->head_open || st->ribbon_out ||
+			st->paused || st->buffer_full || st->code;
+}
+
+//------------------------------------------------------------------------------
+// ~HS : <STX>aaa,b,c,dddd,eee,f,...<ETX> <STX>mmm,n,o,p,...<ETX> <STX>...<ETX>
+//   string 1 : b = paper out, c = pause, eee = formats in buffer, f = buffer full
+//   string 2 : o = head up, p = ribbon out
+//------------------------------------------------------------------------------
+static int parse_zpl (usblp_chan_t *ch)
+{
+	char *p = ch->rx, *end, *s;
+	int i, n, f[2][6];
+
+	memset (f, 0, sizeof(f));
+	for (i = 0; i < 3; i++) {
+		if ((p = memchr (p, STX, ch->rx + ch->rxlen - p)) == NULL)
+			return 0;
+		if ((end = memchr (p, ETX, ch->rx + ch->rxlen - p)) == NULL)
+			return 0;
+		// comma separated numbers of string 1, 2
+		for (n = 0, s = p + 1; (i < 2) && (n < 6) && (s < end); n++) {
+			f[i][n] = strtol (s, NULL, 10);
+			if ((s = memchr (s, ',', end - s)) == NULL)
+				break;
+			s++;
+		}
+		p = end + 1;
+	}
+	ch->st.paper_out   = f[0][1];
+	ch->st.paused      = f[0][2];
+	ch->st.formats     = f[0][4];
+	ch->st.buffer_full = f[0][5];
+	ch->st.head_open   = f[1][2];
+	ch->st.ribbon_out  = f[1][3];
+	ch->st.code        = 0;
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// ^ee : "nn\r\n" error number. (00 = no error, 07 = paper or ribbon empty)
+//------------------------------------------------------------------------------
+static int parse_epl (usblp_chan_t *ch)
+{
+	char *p;
+
+	ch->rx[ch->rxlen] = 0;
+	if ((p = strpbrk (ch->rx, "0123456789")) == NULL)
+		return 0;
+	if (strpbrk (p, "\r\n") == NULL)
+		return 0;
+
+	ch->st.code       = atoi (p);
+	ch->st.paper_out  = (ch->st.code == 7);
+	ch->st.head_open  = ch->st.ribbon_out = ch->st.paused = false;
+	ch->st.buffer_full = false;
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// tell the job queue when the printer can (not) take jobs.
+//------------------------------------------------------------------------------
+static void chan_update (int idx, usblp_chan_t *ch)
+{
+	bool ready = !status_fault (&ch->st);
+
+	if (ready != ch->ready) {
+		if (!ready)
+			ch->st.faults++;
+		ch->ready = ready;
+		usblp_queue_ready (idx, ready);
+	}
+}
+
+//------------------------------------------------------------------------------
+static void chan_close (usblp_chan_t *ch)
+{
+	if (ch->st.channel)
+		close (ch->fd);
+	ch->st.channel = false;
+	ch->st.valid   = false;
+	ch->state      = CHAN_IDLE;
+}
+
+//------------------------------------------------------------------------------
+static void chan_poll (int idx, usblp_chan_t *ch, ulong_t now)
+{
+	const char *query;
+	int n;
+
+	if (!ch->st.channel)
+		return;
+
+	if (ch->state == CHAN_IDLE) {
+		if (now < ch->t_next)
+			return;
+		query = (ch->lang == LBL_LANG_EPL) ? EPL_STATUS_QUERY : ZPL_STATUS_QUERY;
+		if (write (ch->fd, query, strlen(query)) != (ssize_t)strlen(query)) {
+			if ((errno == ENODEV) || (errno == EIO))
+				goto gone;
+			ch->t_next = now + USBLP_STATUS_INTERVAL;
+			return;
+		}
+		ch->st.polls++;
+		ch->state  = CHAN_WAIT;
+		ch->t_sent = now;
+		ch->rxlen  = 0;
+		return;
+	}
+
+	n = read (ch->fd, &ch->rx[ch->rxlen], sizeof(ch->rx) - 1 - ch->rxlen);
+	if (n > 0)
+		ch->rxlen += n;
+	else if ((n < 0) && ((errno == ENODEV) || (errno == EIO)))
+		goto gone;
+
+	if ((ch->lang == LBL_LANG_EPL) ? parse_epl (ch) : parse_zpl (ch)) {
+		ch->st.responses++;
+		ch->st.valid = true;
+		ch->no_resp  = 0;
+		ch->state    = CHAN_IDLE;
+		ch->t_next   = now + USBLP_STATUS_INTERVAL;
+		chan_update (idx, ch);
+		return;
+	}
+	if ((now - ch->t_sent > USBLP_STATUS_TIMEOUT) ||
+		(ch->rxlen >= (int)sizeof(ch->rx) - 1)) {
+		ch->st.timeouts++;
+		ch->state  = CHAN_IDLE;
+		ch->t_next = now + USBLP_STATUS_INTERVAL;
+		// no answer : status unknown, do not hold the jobs for it.
+		if (++ch->no_resp >= 3) {
+			ch->st.valid = false;
+			chan_update (idx, ch);
+		}
+	}
+	return;
+gone:
+	chan_close (ch);
+	chan_update (idx, ch);
+}
+
+//------------------------------------------------------------------------------
+// open the status channel (/dev/usb/lpN) of the printer.
+//------------------------------------------------------------------------------
+int usblp_status_attach (int idx, const char *uri, int lang)
+{
+	usblp_chan_t *ch;
+	int lpnum, i, fd;
+
+	if ((idx < 0) || (idx >= USBLP_MAX))
+		return 0;
+
+	ch = &Chans[idx];
+	if (ch->st.channel)
+		return 1;
+
+	for (lpnum = 0; lpnum < USBLP_DEV_MAX; lpnum++) {
+		// already used by the other printer.
+		for (i = 0; i < USBLP_MAX; i++) {
+			if (Chans[i].st.channel && (Chans[i].lpnum == lpnum))
+				break;
+		}
+		if (i < USBLP_MAX)
+			continue;
+		if ((fd = match_device (lpnum, uri)) < 0)
+			continue;
+
+		memset (ch, 0x00, sizeof(usblp_chan_t));
+		ch->fd    = fd;
+		ch->lang  = lang;
+		ch->lpnum = lpnum;
+		ch->ready = true;
+		ch->st.channel = true;
+		info ("usblp : status channel %s%d\n", USBLP_STATUS_DEV, lpnum);
+		return 1;
+	}
+	info ("usblp : no status channel for %s\n", uri);
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+void usblp_status_detach (int idx)
+{
+	if ((idx < 0) || (idx >= USBLP_MAX))
+		return;
+
+	chan_close (&Chans[idx]);
+	chan_update (idx, &Chans[idx]);
+}
+
+//------------------------------------------------------------------------------
+// called from the main loop. never blocks.
+//------------------------------------------------------------------------------
+void usblp_status_poll (void)
+{
+	ulong_t now = status_msec ();
+	int i;
+
+	for (i = 0; i < USBLP_MAX; i++) {
+		chan_poll (i, &Chans[i], now);
+		// the answer of a new query may already be there.
+		if (Chans[i].state == CHAN_WAIT)
+			chan_poll (i, &Chans[i], now);
+	}
+}
+
+//------------------------------------------------------------------------------
+// query now, the answer comes with usblp_status_poll. never blocks.
+// return the last status. (1 = ready, 0 = fault, -1 = unknown)
+//------------------------------------------------------------------------------
+int usblp_status_query (int idx)
+{
+	usblp_chan_t *ch;
+	ulong_t now;
+
+	if ((idx < 0) || (idx >= USBLP_MAX) || !Chans[idx].st.channel)
+		return -1;
+
+	ch = &Chans[idx];
+	now = status_msec ();
+	ch->state  = CHAN_IDLE;
+	ch->t_next = now;
+	chan_poll (idx, ch, now);
+	if (!ch->st.valid)
+		return -1;
+	return status_fault (&ch->st) ? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
+int usblp_status_get (int idx, usblp_status_t *s)
+{
+	if ((idx < 0) || (idx >= USBLP_MAX))
+		return 0;
+
+	*s = Chans[idx].st;
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// first printer fault text for the lcd. ("zebra1 PAPER OUT")
+//------------------------------------------------------------------------------
+int usblp_status_fault (char *msg, int size)
+{
+	usblp_stats_t stats;
+	usblp_status_t *st;
+	const char *fault;
+	char code[16];
+	int i;
+
+	for (i = 0; i < USBLP_MAX; i++) {
+		st = &Chans[i].st;
+		if (!status_fault (st) || !usblp_queue_stats (i, &stats))
+			continue;
+
+		if      (st->paper_out)		fault = "PAPER OUT";
+		else if (st->head_open)		fault = "HEAD OPEN";
+		else if (st->ribbon_out)	fault = "RIBBON OUT";
+		else if (st->buffer_full)	fault = "BUFFER FULL";
+		else if (st->paused)		fault = "PAUSED";
+		else {
+			snprintf (code, sizeof(code), "ERROR %02d", st->code);
+			fault = code;
+		}
+		snprintf (msg, size, "%s %s", stats.lpq, fault);
+		return 1;
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
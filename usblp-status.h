@@ -0,0 +1,49 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 USB Label printer status readback. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __USBLP_STATUS_H__
+#define __USBLP_STATUS_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+#define	USBLP_STATUS_DEV		"/dev/usb/lp"
+#define	USBLP_STATUS_INTERVAL	1000	// msec, status query interval
+#define	USBLP_STATUS_TIMEOUT	3000	// msec, response timeout
+#define	USBLP_STATUS_RX_MAX		256
+
+//------------------------------------------------------------------------------
+typedef struct usblp_status__t {
+	// status channel opened / response received at least once.
+	bool	channel;
+	bool	valid;
+
+	bool	paper_out;
+	bool	head_open;
+	bool	ribbon_out;
+	bool	paused;
+	bool	buffer_full;
+	// EPL ^ee error code, ZPL formats in the receive buffer.
+	int		code;
+	int		formats;
+
+	ulong_t	polls;
+	ulong_t	responses;
+	ulong_t	timeouts;
+	ulong_t	faults;
+}	usblp_status_t;
+
+//------------------------------------------------------------------------------
+extern int	usblp_status_attach	(int idx, const char *uri, int lang);
+extern void	usblp_status_detach	(int idx);
+extern void	usblp_status_poll	(void);
+extern int	usblp_status_query	(int idx);
+extern int	usblp_status_get	(int idx, usblp_status_t *s);
+extern int	usblp_status_fault	(char *msg, int size);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __USBLP_STATUS_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
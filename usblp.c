@@ -20,64 +20,28 @@
 #include <sys/mman.h>
 #include <linux/fb.h>
 #include <getopt.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 
 #include "typedefs.h"
 #include "usblp.h"
+#include "usblp-form.h"
+#include "usblp-queue.h"
+#include "usblp-status.h"
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 #define	TEXT_WIDTH	80
 
-const int8_t USBLP_EPL_FORM[][TEXT_WIDTH] = {
-	"I8,0,001\n",
-	"Q78,16\n",
-	"q240\n",
-	"rN\n",
-	"S4\n",
-	"D15\n",
-	"ZB\n",
-	"JF\n",
-	"O\n",
-	"R304,10\n",
-	"f100\n",
-	"N\n",
-	"A10,0,0,2,1,1,N,\"EPL Printer Test\"\n",
-	"A16,32,0,2,1,1,N,\"00:1E:06:xx:xx:xx\"\n",
-	"P1\n"
-};
-
-const int8_t USBLP_ZPL_FORM[][TEXT_WIDTH] = {
-	"I8,0,001\n",
-	"Q78,16\n",
-	"q240\n",
-	"rN\n",
-	"S4\n",
-	"D15\n",
-	"ZB\n",
-	"JF\n",
-	"O\n",
-	"R304,10\n",
-	"f100\n",
-	"N\n",
-	"A10,0,0,2,1,1,N,\"ZPL Printer Test\"\n",
-	"A16,32,0,2,1,1,N,\"00:1E:06:xx:xx:xx\"\n",
-	"P1\n"
-};
 #if 0
 const int8_t USBLP_ZPL_INIT[TEXT_WIDTH] = {
 	"^XA^JUF^XZ\n"
 };
-
-const int8_t USBLP_ZPL_FORM[][TEXT_WIDTH] = {
-	"^XA\n",
-	"^CFC\n",
-	"^LH0,0\n",
-	"^FO310,25^FDZPL Printer Test^FS\n",
-	"^FO316,55^FD00:1E:06:xx:xx:xx^FS\n",
-	"^XZ\n"
-};
 #endif
 
+static uint_t		LabelCount = 0;
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 // check the usb label printer connection.
@@ -105,12 +69,13 @@ static int32_t check_usblp_connection (void)
 }
 
 //------------------------------------------------------------------------------
-// get the usb label printer info.
+// get the usb label printer info. (all attached zebra printers)
 //------------------------------------------------------------------------------
-static int32_t get_usblp_device (int8_t *lpname)
+static int32_t get_usblp_devices (char lpname[][512], int32_t max)
 {
 	FILE *fp;
-	int8_t cmd_line[1024], *ptr;
+	char cmd_line[1024], *ptr;
+	int32_t count = 0;
 
 	memset (cmd_line, 0x00, sizeof(cmd_line));
 	sprintf (cmd_line, "%s", "lpinfo -v | grep usb 2<&1");
@@ -118,30 +83,33 @@ static int32_t get_usblp_device (int8_t *lpname)
 	if ((fp = popen(cmd_line, "r")) != NULL) {
 		memset (cmd_line, 0x00, sizeof(cmd_line));
 		while (fgets (cmd_line, sizeof(cmd_line), fp) != NULL) {
-			if ((ptr = strstr (cmd_line, "usb:")) != NULL) {
-				strncpy (lpname, ptr, strlen(ptr));
-				pclose (fp);
-				return 1;
+			if (((ptr = strstr (cmd_line, "usb:")) != NULL) &&
+				(strstr (ptr, "Zebra") != NULL) && (count < max)) {
+				int32_t len = strcspn (ptr, "\r\n");
+
+				memset (lpname[count], 0x00, 512);
+				strncpy (lpname[count], ptr, len < 511 ? len : 511);
+				count++;
 			}
 			memset (cmd_line, 0x00, sizeof(cmd_line));
 		}
 		pclose(fp);
 	}
-	return 0;
+	return count;
 }
 
 //------------------------------------------------------------------------------
 // set the usb label printer info.
 //------------------------------------------------------------------------------
-static int32_t set_usblp_device (int8_t *lpname)
+static int32_t set_usblp_device (const char *lpq, char *lpname)
 {
 	FILE *fp;
-	int8_t cmd_line[1024], s_lpname[512];
+	char cmd_line[1024], s_lpname[512];
 
 	memset (s_lpname, 0x00, sizeof(s_lpname));
 	{
 		int32_t i, pos;
-		for (i = 0, pos = 0; i < strlen(lpname); i++, pos++) {
+		for (i = 0, pos = 0; i < (int32_t)strlen(lpname); i++, pos++) {
 			if ((lpname[i] == '(') || (lpname[i] == ')'))
 				s_lpname [pos++] = '\\';
 			s_lpname [pos] = lpname[i];
@@ -149,7 +117,7 @@ static int32_t set_usblp_device (int8_t *lpname)
 	}
 
 	memset (cmd_line, 0x00, sizeof(cmd_line));
-	sprintf (cmd_line, "lpadmin -p zebra -E -v %s 2<&1", s_lpname);
+	sprintf (cmd_line, "lpadmin -p %s -E -v %s 2<&1", lpq, s_lpname);
 
 	if ((fp = popen(cmd_line, "w")) != NULL) {
 		pclose(fp);
@@ -159,12 +127,15 @@ static int32_t set_usblp_device (int8_t *lpname)
 }
 
 //------------------------------------------------------------------------------
-// confirm the usb label printer info.
+// confirm the usb label printer info. ("device for {lpq}: {lpname}")
 //------------------------------------------------------------------------------
-static int32_t confirm_usblp_device (int8_t *lpname)
+static int32_t confirm_usblp_device (const char *lpq, char *lpname)
 {
 	FILE *fp;
-	int8_t cmd_line[1024], *ptr;
+	char cmd_line[1024], lp_dev[64], *ptr;
+
+	memset (lp_dev, 0x00, sizeof(lp_dev));
+	snprintf (lp_dev, sizeof(lp_dev), "device for %s:", lpq);
 
 	memset (cmd_line, 0x00, sizeof(cmd_line));
 	sprintf (cmd_line, "%s", "lpstat -v | grep usb 2<&1");
@@ -172,8 +143,11 @@ static int32_t confirm_usblp_device (int8_t *lpname)
 	if ((fp = popen(cmd_line, "r")) != NULL) {
 		memset (cmd_line, 0x00, sizeof(cmd_line));
 		while (fgets (cmd_line, sizeof(cmd_line), fp) != NULL) {
-			if ((ptr = strstr (cmd_line, "usb:")) != NULL) {
-				if (!strncmp (lpname, ptr, strlen(ptr)-1)) {
+			if ((strstr (cmd_line, lp_dev) != NULL) &&
+				((ptr = strstr (cmd_line, "usb:")) != NULL)) {
+				int32_t len = strcspn (ptr, "\r\n");
+
+				if (((int32_t)strlen (lpname) == len) && !strncmp (lpname, ptr, len)) {
 					pclose (fp);
 					return 1;
 				}
@@ -186,37 +160,40 @@ static int32_t confirm_usblp_device (int8_t *lpname)
 }
 
 //------------------------------------------------------------------------------
-// Label printer test.
+// label field data (hw address & ip of the network device)
 //------------------------------------------------------------------------------
-static void test_usblp_device (int8_t *lpname)
+static void get_usblp_fields (lbl_fields_t *f, const char *ifname)
 {
-	FILE *fp = fopen ("usblp.txt", "w");
-	const int8_t *form;
-	int8_t cmd_line[1024], *ptr, lines, i;
+	struct ifreq ifr;
+	int fd;
 
-	if (fp == NULL) {
-		fprintf (stdout, "%s : couuld not create file for usblp test. ", __func__);
-		return;
-	}
+	memset (f, 0x00, sizeof(lbl_fields_t));
+	f->date   = time(NULL);
+	f->count  = ++LabelCount;
+	f->copies = 1;
 
-	if (strstr (lpname, "EPL") != NULL) {
-		lines = sizeof (USBLP_EPL_FORM) / sizeof (USBLP_EPL_FORM[0]);
-		form = USBLP_EPL_FORM[0];
-	} else {
-		lines = sizeof (USBLP_ZPL_FORM) / sizeof (USBLP_ZPL_FORM[0]);
-		form = USBLP_ZPL_FORM[0];
-	}
+	if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+		return;
 
-	for (i = 0; i < lines; i++, form += TEXT_WIDTH)
-		fputs (form, fp);
-	fclose(fp);
+	memset (&ifr, 0x00, sizeof(ifr));
+	strncpy (ifr.ifr_name, ifname, IFNAMSIZ - 1);
+	if (!ioctl(fd, SIOCGIFHWADDR, &ifr))
+		memcpy (f->mac, ifr.ifr_hwaddr.sa_data, sizeof(f->mac));
+	if (!ioctl(fd, SIOCGIFADDR, &ifr))
+		f->ip = ((struct sockaddr_in *)&ifr.ifr_addr)->sin_addr.s_addr;
+	close(fd);
+}
 
-	memset (cmd_line, 0x00, sizeof(cmd_line));
-	sprintf (cmd_line, "%s", "lpr usblp.txt -P zebra 2<&1");
+//------------------------------------------------------------------------------
+// Label printer test. (queued, printed by the printer worker thread)
+//------------------------------------------------------------------------------
+static void test_usblp_device (int32_t idx)
+{
+	lbl_fields_t fields;
 
-	if ((fp = popen(cmd_line, "w")) != NULL) {
-		pclose(fp);
-	}
+	get_usblp_fields (&fields, "eth0");
+	if (!usblp_print_to (idx, USBLP_FORM_TEST, &fields))
+		err ("usblp queue is full.\n");
 }
 
 //------------------------------------------------------------------------------
@@ -230,7 +207,7 @@ static void init_zpl_device (void)
 	int8_t cmd_line[1024], *ptr, lines, i;
 
 	if (fp == NULL) {
-		fprintf (stdout, "%s : couuld not create file for usblp test. ", __func__);
+		err ("couuld not create file for usblp test.\n");
 		return;
 	}
 	fputs (USBLP_ZPL_INIT, fp);
@@ -245,45 +222,131 @@ static void init_zpl_device (void)
 }
 #endif
 
+//------------------------------------------------------------------------------
+// cups queue name of the printer : zebra-{serial}, no serial : zebra-{uri hash}.
+// (the same queue for the same printer, whatever the usb scan order)
+//------------------------------------------------------------------------------
+static void get_usblp_queue (const char *lpname, char *lpq, int32_t size)
+{
+	const char *p;
+	uint32_t hash = 2166136261U;
+	int32_t pos;
+
+	if ((p = strstr (lpname, "serial=")) != NULL) {
+		pos = snprintf (lpq, size, "zebra-");
+		for (p += 7; *p && (*p != '&') && (pos < size - 1); p++) {
+			// %xx : escaped, not a name character.
+			if ((*p == '%') && p[1] && p[2]) {
+				p += 2;
+				continue;
+			}
+			if (isalnum ((uint8_t)*p))
+				lpq[pos++] = *p;
+		}
+		lpq[pos] = 0;
+		if (pos > (int32_t)strlen ("zebra-"))
+			return;
+	}
+	for (p = lpname; *p; p++)
+		hash = (hash ^ (uint8_t)*p) * 16777619U;
+	snprintf (lpq, size, "zebra-%08x", hash);
+}
+
+//------------------------------------------------------------------------------
+// setup the cups queue of one printer.
+//------------------------------------------------------------------------------
+static int32_t setup_usblp_device (const char *lpq, char *usblp_device)
+{
+	if (!confirm_usblp_device (lpq, usblp_device)) {
+		err ("The usblp information is different. (%s)\n", lpq);
+		if (!set_usblp_device (lpq, usblp_device)) {
+			err ("Failed to configure usblp.\n");
+			return 0;
+		}
+		if (!confirm_usblp_device (lpq, usblp_device)) {
+			err ("The usblp settings have not been changed.\n");
+			return 0;
+		}
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// return the number of the ready printers.
 //------------------------------------------------------------------------------
 int32_t usblp_reconfig (void)
 {
-	int8_t usblp_device[512];
+	static int32_t gen = 0;
+	char usblp_device[USBLP_MAX][512], lpq[USBLP_MAX][32];
+	int32_t i, j, count, idx, lang, ready = 0, found[USBLP_MAX];
 
+	gen++;
+	memset (found, 0x00, sizeof(found));
 	memset (usblp_device, 0x00, sizeof(usblp_device));
 	if (!check_usblp_connection ()) {
-		fprintf (stdout, "Error : Zebra USB Label Printer not found\n");
+		err ("Zebra USB Label Printer not found\n");
+		usblp_queue_sweep (gen);
+		for (i = 0; i < USBLP_MAX; i++)
+			usblp_status_detach (i);
 		return 0;
 	}
 
-	if (!get_usblp_device (usblp_device)) {
-		fprintf (stdout, "Error : Unable to get usblp infomation.\n");
+	if (!(count = get_usblp_devices (usblp_device, USBLP_MAX))) {
+		err ("Unable to get usblp infomation.\n");
+		usblp_queue_sweep (gen);
+		for (i = 0; i < USBLP_MAX; i++)
+			usblp_status_detach (i);
 		return 0;
 	}
-	
-	if (!confirm_usblp_device (usblp_device)) {
-		fprintf (stdout, "Error : The usblp information is different.\n");
-		if (!set_usblp_device (usblp_device)) {
-			fprintf (stdout, "Error : Failed to configure usblp.\n");
-			return 0;
+
+	for (i = 0; i < count; i++) {
+		memset (lpq[i], 0x00, sizeof(lpq[i]));
+		get_usblp_queue (usblp_device[i], lpq[i], sizeof(lpq[i]));
+		// the same model without a serial : the scan order tells them apart.
+		for (j = 0; j < i; j++) {
+			if (!strcmp (lpq[i], lpq[j])) {
+				lpq[i][24] = 0;
+				sprintf (lpq[i] + strlen (lpq[i]), "-%d", i);
+				break;
+			}
 		}
-		if (!confirm_usblp_device (usblp_device)) {
-			fprintf (stdout, "Error : The usblp settings have not been changed.\n");
-			return 0;
+
+		if (!setup_usblp_device (lpq[i], usblp_device[i]))
+			continue;
+		#if 0
+		if (!zpl_init && strstr (usblp_device[i], "ZPL") != NULL) {
+			// factory setup
+			init_zpl_device ();
+			zpl_init = 1;
+			sleep(5);
+		}
+		#endif
+		lang = (strstr (usblp_device[i], "EPL") != NULL) ? LBL_LANG_EPL : LBL_LANG_ZPL;
+		if ((idx = usblp_queue_add (lpq[i], usblp_device[i], lang, gen)) < 0)
+			continue;
+		found[idx] = 1;
+
+		info ("*** Printer Queue : %s, Device Name : %s\n",
+				lpq[i], usblp_device[i]);
+
+		// printer status readback. (no status channel : -1, unknown)
+		// the answer comes with usblp_status_poll of the main loop, a fault
+		// holds the queue (test label too) until it clears.
+		usblp_status_attach (idx, usblp_device[i], lang);
+		if (!usblp_status_query (idx)) {
+			err ("%s is not ready.\n", lpq[i]);
+			continue;
 		}
+		info ("*** USB Label Printer setup is complete. ***\n");
+		test_usblp_device (idx);
+		ready++;
 	}
-	#if 0
-	if (!zpl_init && strstr (usblp_device, "ZPL") != NULL) {
-		// factory setup
-		init_zpl_device ();
-		zpl_init = 1;
-		sleep(5);
+	usblp_queue_sweep (gen);
+	for (i = 0; i < USBLP_MAX; i++) {
+		if (!found[i])
+			usblp_status_detach (i);
 	}
-	#endif
-	fprintf (stdout, "*** USB Label Printer setup is complete. ***\n");
-	fprintf (stdout, "*** Printer Device Name : %s\n", usblp_device);
-	test_usblp_device (usblp_device);
-	return 1;
+	return ready;
 }
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
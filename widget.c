@@ -0,0 +1,212 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Display field widgets. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "typedefs.h"
+#include "widget.h"
+
+//------------------------------------------------------------------------------
+static	int		(*WidgetWrite)(int fd, int x, int y, const char *s, int len);
+static	int		(*WidgetClear)(int fd, int line);
+static	widget_t	*Shown;			// page on the glass
+
+// local time of the minute. (zone offset changes are on the minute)
+static	time_t		ClockBase = -1;
+static	struct tm	ClockTm;
+
+//------------------------------------------------------------------------------
+static	int		widget_format		(widget_t *w, char *buf, int size);
+static	void	widget_cells		(widget_t *w);
+		void	widget_init			(int (*write)(int fd, int x, int y, const char *s, int len),
+										int (*clear)(int fd, int line));
+		int		widget_value		(widget_t *w, long v);
+		int		widget_text			(widget_t *w, const char *s);
+		void	widget_page			(int fd, widget_t *page, int n);
+		int		widget_dirty		(widget_t *page, int n);
+		void	widget_leave		(void);
+		void	widget_localtime	(time_t t, struct tm *tm);
+		void	widget_tz_reset		(void);
+
+//------------------------------------------------------------------------------
+// source value -> text. (return length)
+//------------------------------------------------------------------------------
+static int widget_format (widget_t *w, char *buf, int size)
+{
+	struct in_addr in;
+	struct tm tm;
+	time_t t;
+	long v = w->value;
+
+	buf[0] = 0;
+	switch (w->type) {
+		case	W_TEXT:
+			snprintf (buf, size, "%s", w->text);
+			break;
+		case	W_INT:
+			snprintf (buf, size, w->fmt ? w->fmt : "%ld", v);
+			break;
+		case	W_IPV4:
+			in.s_addr = (uint_t)v;
+			inet_ntop (AF_INET, &in, buf, size);
+			break;
+		case	W_DUPLEX:
+			snprintf (buf, size, "%s", v == 1 ? "FULL" : v == 0 ? "HALF" : "????");
+			break;
+		case	W_RTT:
+			if		(v < 0)			snprintf (buf, size, "---");
+			else if (v < 10000)		snprintf (buf, size, "%ld.%ldms", v / 1000, (v / 100) % 10);
+			else if (v < 1000000)	snprintf (buf, size, "%ldms", v / 1000);
+			else					snprintf (buf, size, "%lds", v / 1000000);
+			break;
+		case	W_CLOCK:
+			t = v;
+			widget_localtime (t, &tm);
+			if (!strftime (buf, size, w->fmt ? w->fmt : "%H:%M:%S", &tm))
+				buf[0] = 0;
+			break;
+		case	W_PERCENT:
+			if (v < 0)	snprintf (buf, size, "%s--", w->fmt ? w->fmt : "");
+			else		snprintf (buf, size, "%s%ld%%", w->fmt ? w->fmt : "", v);
+			break;
+		case	W_TEMP:
+			if (v < -273000)	snprintf (buf, size, "--C");
+			else				snprintf (buf, size, "%s%ld.%ldC", v < 0 ? "-" : "",
+										labs (v) / 1000, (labs (v) / 100) % 10);
+			break;
+		default :
+			break;
+	}
+	return strlen (buf);
+}
+
+//------------------------------------------------------------------------------
+// text cut / padded to the width, dirty only if a cell changed.
+//------------------------------------------------------------------------------
+static void widget_cells (widget_t *w)
+{
+	char buf[LCD_COL_MAX +1], cells[LCD_COL_MAX];
+	int len, pad;
+
+	len = widget_format (w, buf, sizeof(buf));
+	len = len > w->width ? w->width : len;
+	pad = w->width - len;
+	pad = (w->align == W_RIGHT) ? pad : (w->align == W_CENTER) ? pad / 2 : 0;
+
+	memset (cells, ' ', w->width);
+	memcpy (&cells[pad], buf, len);
+	if (memcmp (w->cells, cells, w->width)) {
+		memcpy (w->cells, cells, w->width);
+		w->dirty = true;
+	}
+	w->valid = true;
+}
+
+//------------------------------------------------------------------------------
+void widget_init (int (*write)(int fd, int x, int y, const char *s, int len),
+					int (*clear)(int fd, int line))
+{
+	WidgetWrite = write;
+	WidgetClear = clear;
+	Shown       = NULL;
+}
+
+//------------------------------------------------------------------------------
+// return true if the value changed.
+//------------------------------------------------------------------------------
+int widget_value (widget_t *w, long v)
+{
+	if (w->valid && (w->value == v))
+		return false;
+	if (w->width > LCD_COL_MAX)
+		w->width = LCD_COL_MAX;
+	w->value = v;
+	widget_cells (w);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+int widget_text (widget_t *w, const char *s)
+{
+	if (w->valid && !strncmp (w->text, s, sizeof(w->text)))
+		return false;
+	if (w->width > LCD_COL_MAX)
+		w->width = LCD_COL_MAX;
+	strncpy (w->text, s, sizeof(w->text) -1);
+	widget_cells (w);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// show the page. (clear once on a page change, then dirty widgets only)
+//------------------------------------------------------------------------------
+void widget_page (int fd, widget_t *page, int n)
+{
+	int i;
+
+	if (Shown != page) {
+		WidgetClear (fd, -1);
+		for (i = 0; i < n; i++)
+			page[i].dirty = page[i].valid;
+		Shown = page;
+	}
+	for (i = 0; i < n; i++) {
+		if (!page[i].dirty)
+			continue;
+		if (WidgetWrite (fd, page[i].x, page[i].y, page[i].cells, page[i].width))
+			page[i].dirty = false;
+	}
+}
+
+//------------------------------------------------------------------------------
+// cells of the next widget_page. (page change : the whole page)
+//------------------------------------------------------------------------------
+int widget_dirty (widget_t *page, int n)
+{
+	int i, cells = 0;
+
+	for (i = 0; i < n; i++)
+		if ((Shown != page) ? page[i].valid : page[i].dirty)
+			cells += page[i].width;
+	return cells;
+}
+
+//------------------------------------------------------------------------------
+// the screen was written without widgets. (next widget_page redraws)
+//------------------------------------------------------------------------------
+void widget_leave (void)
+{
+	Shown = NULL;
+}
+
+//------------------------------------------------------------------------------
+// localtime_r once a minute, the seconds are added in between.
+//------------------------------------------------------------------------------
+void widget_localtime (time_t t, struct tm *tm)
+{
+	if ((ClockBase < 0) || (t < ClockBase) || (t - ClockBase >= 60)) {
+		localtime_r (&t, &ClockTm);
+		ClockBase = t - ClockTm.tm_sec;
+	}
+	*tm = ClockTm;
+	tm->tm_sec = t - ClockBase;
+}
+
+//------------------------------------------------------------------------------
+// clock set / zone changed.
+//------------------------------------------------------------------------------
+void widget_tz_reset (void)
+{
+	tzset ();
+	ClockBase = -1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
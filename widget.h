@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 Display field widgets. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __WIDGET_H__
+#define __WIDGET_H__
+
+#include <time.h>
+#include "typedefs.h"
+#include "i2c-lcd.h"
+//------------------------------------------------------------------------------
+/*
+	A widget is a fixed region of the screen bound to one source value.
+	widget_value / widget_text compare the value first, the cells are only
+	formatted (bounded, padded to the width) when the value changed, and only
+	the changed widget is marked dirty. widget_page sends the dirty widgets,
+	a page shown again after another page sends its cached cells as they are.
+	widget_dirty : cells widget_page would send, the cost of a low priority
+	page refresh. (lcd_cost_us) Not sent, the values keep coalescing.
+*/
+//------------------------------------------------------------------------------
+enum {
+	W_LEFT = 0,
+	W_RIGHT,
+	W_CENTER,
+};
+
+enum {
+	W_TEXT = 0,		// widget_text
+	W_INT,			// fmt : printf long ("%ld" default)
+	W_IPV4,			// network order address, 0 : "0.0.0.0"
+	W_DUPLEX,		// ethtool duplex (0 half, 1 full, other unknown)
+	W_RTT,			// usec, < 0 : no reply
+	W_CLOCK,		// time_t, fmt : strftime (local time)
+	W_PERCENT,		// fmt : label, < 0 : no sample ("--")
+	W_TEMP,			// milli degree C, < -273000 : no sensor
+};
+
+//------------------------------------------------------------------------------
+typedef struct widget__t {
+	byte_t		x, y, width;
+	byte_t		align;
+	byte_t		type;
+	const char	*fmt;
+	// source value of the cells
+	bool		valid;
+	long		value;
+	char		text[LCD_COL_MAX +1];
+	// formatted cells, dirty : not sent yet
+	char		cells[LCD_COL_MAX];
+	bool		dirty;
+}	widget_t;
+
+#define	WIDGET(x, y, width, align, type, fmt)	\
+	{ x, y, width, align, type, fmt, false, 0, "", "", false }
+
+#define	WIDGET_COUNT(page)	(int)(sizeof(page) / sizeof(page[0]))
+
+//------------------------------------------------------------------------------
+extern void	widget_init			(int (*write)(int fd, int x, int y, const char *s, int len),
+									int (*clear)(int fd, int line));
+extern int	widget_value		(widget_t *w, long v);
+extern int	widget_text			(widget_t *w, const char *s);
+extern void	widget_page			(int fd, widget_t *page, int n);
+extern int	widget_dirty		(widget_t *page, int n);
+extern void	widget_leave		(void);
+extern void	widget_localtime	(time_t t, struct tm *tm);
+extern void	widget_tz_reset		(void);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __WIDGET_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,361 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 nl80211 Wi-Fi status. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include <linux/nl80211.h>
+
+#include "typedefs.h"
+#include "wifi.h"
+
+#ifndef SOL_NETLINK
+#define	SOL_NETLINK		270
+#endif
+
+//------------------------------------------------------------------------------
+static	int			ReqFd = -1, EvFd = -1;
+static	int			Family, IfIndex;
+static	uint_t		Seq;
+static	byte_t		Buf[WIFI_BUF_SIZE];
+static	bool		Dirty = true;
+static	wifi_t		Cur;			// shown values
+static	ulong_t		TSignal;
+
+//------------------------------------------------------------------------------
+static	ulong_t			wifi_msec		(void);
+static	struct nlattr	*nla_put		(struct nlmsghdr *nh, int type, const void *data, int len);
+static	struct nlattr	*nla_find		(void *head, int len, int type);
+static	int				nl_request		(int family, int cmd, int flags, const char *name);
+static	int				nl_reply		(int (*parse)(struct nlmsghdr *nh, void *arg), void *arg);
+static	int				parse_family	(struct nlmsghdr *nh, void *arg);
+static	int				parse_iface		(struct nlmsghdr *nh, void *arg);
+static	int				parse_station	(struct nlmsghdr *nh, void *arg);
+static	int				freq_channel	(int freq);
+		int				wifi_open		(const char *ifname);
+		void			wifi_close		(void);
+		int				wifi_event_fd	(void);
+		int				wifi_events		(void);
+		int				wifi_status		(wifi_t *w);
+
+//------------------------------------------------------------------------------
+static ulong_t wifi_msec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (ulong_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+static struct nlattr *nla_put (struct nlmsghdr *nh, int type, const void *data, int len)
+{
+	struct nlattr *a = (struct nlattr *)((byte_t *)nh + NLMSG_ALIGN (nh->nlmsg_len));
+
+	a->nla_type = type;
+	a->nla_len  = NLA_HDRLEN + len;
+	memcpy ((byte_t *)a + NLA_HDRLEN, data, len);
+	nh->nlmsg_len = NLMSG_ALIGN (nh->nlmsg_len) + NLA_ALIGN (a->nla_len);
+	return a;
+}
+
+//------------------------------------------------------------------------------
+// attribute of the stream, NULL if not found.
+//------------------------------------------------------------------------------
+static struct nlattr *nla_find (void *head, int len, int type)
+{
+	struct nlattr *a = head;
+
+	while ((len >= NLA_HDRLEN) && (a->nla_len >= NLA_HDRLEN) && (a->nla_len <= len)) {
+		if ((a->nla_type & NLA_TYPE_MASK) == type)
+			return a;
+		len -= NLA_ALIGN (a->nla_len);
+		a    = (struct nlattr *)((byte_t *)a + NLA_ALIGN (a->nla_len));
+	}
+	return NULL;
+}
+
+#define	NLA_DATA(a)		((void *)((byte_t *)(a) + NLA_HDRLEN))
+#define	NLA_LEN(a)		((a)->nla_len - NLA_HDRLEN)
+#define	GENL_ATTRS(nh)	((byte_t *)NLMSG_DATA (nh) + GENL_HDRLEN)
+#define	GENL_ALEN(nh)	((int)(nh)->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN)
+
+//------------------------------------------------------------------------------
+// name : family name (GETFAMILY), otherwise the interface index goes along.
+//------------------------------------------------------------------------------
+static int nl_request (int family, int cmd, int flags, const char *name)
+{
+	struct nlmsghdr *nh = (struct nlmsghdr *)Buf;
+	struct genlmsghdr *gh = NLMSG_DATA (nh);
+	uint_t idx = IfIndex;
+
+	memset (Buf, 0, NLMSG_HDRLEN + GENL_HDRLEN);
+	nh->nlmsg_len   = NLMSG_HDRLEN + GENL_HDRLEN;
+	nh->nlmsg_type  = family;
+	nh->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | flags;
+	nh->nlmsg_seq   = ++Seq;
+	gh->cmd         = cmd;
+	gh->version     = 1;
+	if (name)
+		nla_put (nh, CTRL_ATTR_FAMILY_NAME, name, strlen (name) + 1);
+	else
+		nla_put (nh, NL80211_ATTR_IFINDEX, &idx, sizeof(idx));
+
+	return send (ReqFd, Buf, nh->nlmsg_len, 0) == (int)nh->nlmsg_len;
+}
+
+//------------------------------------------------------------------------------
+// messages of the request until ack / done. return messages parsed, -1 : error
+//------------------------------------------------------------------------------
+static int nl_reply (int (*parse)(struct nlmsghdr *nh, void *arg), void *arg)
+{
+	struct nlmsghdr *nh;
+	struct nlmsgerr *e;
+	int len, n = 0;
+
+	while ((len = recv (ReqFd, Buf, sizeof(Buf), 0)) > 0) {
+		for (nh = (struct nlmsghdr *)Buf; NLMSG_OK (nh, (uint_t)len); nh = NLMSG_NEXT (nh, len)) {
+			if (nh->nlmsg_seq != Seq)
+				continue;
+			if (nh->nlmsg_type == NLMSG_DONE)
+				return n;
+			if (nh->nlmsg_type == NLMSG_ERROR) {
+				e = NLMSG_DATA (nh);
+				return e->error ? -1 : n;
+			}
+			n += parse (nh, arg);
+		}
+	}
+	return -1;
+}
+
+//------------------------------------------------------------------------------
+// family id, "mlme" group id. (arg)
+//------------------------------------------------------------------------------
+static int parse_family (struct nlmsghdr *nh, void *arg)
+{
+	struct nlattr *a, *g, *name, *id;
+	int len;
+
+	if ((a = nla_find (GENL_ATTRS (nh), GENL_ALEN (nh), CTRL_ATTR_FAMILY_ID)) == NULL)
+		return 0;
+	Family = *(word_t *)NLA_DATA (a);
+
+	if ((a = nla_find (GENL_ATTRS (nh), GENL_ALEN (nh), CTRL_ATTR_MCAST_GROUPS)) == NULL)
+		return 1;
+	for (g = NLA_DATA (a), len = NLA_LEN (a);
+		(len >= NLA_HDRLEN) && (g->nla_len >= NLA_HDRLEN) && (g->nla_len <= len);
+		len -= NLA_ALIGN (g->nla_len), g = (struct nlattr *)((byte_t *)g + NLA_ALIGN (g->nla_len))) {
+		name = nla_find (NLA_DATA (g), NLA_LEN (g), CTRL_ATTR_MCAST_GRP_NAME);
+		id   = nla_find (NLA_DATA (g), NLA_LEN (g), CTRL_ATTR_MCAST_GRP_ID);
+		if (name && id && !strcmp (NLA_DATA (name), NL80211_MULTICAST_GROUP_MLME))
+			*(uint_t *)arg = *(uint_t *)NLA_DATA (id);
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+static int parse_iface (struct nlmsghdr *nh, void *arg)
+{
+	wifi_t *w = arg;
+	struct nlattr *a;
+	int len;
+
+	if ((a = nla_find (GENL_ATTRS (nh), GENL_ALEN (nh), NL80211_ATTR_SSID)) != NULL) {
+		len = NLA_LEN (a) > WIFI_SSID_MAX ? WIFI_SSID_MAX : NLA_LEN (a);
+		memcpy (w->ssid, NLA_DATA (a), len);
+		w->ssid[len] = 0;
+	}
+	if ((a = nla_find (GENL_ATTRS (nh), GENL_ALEN (nh), NL80211_ATTR_WIPHY_FREQ)) != NULL) {
+		w->freq    = *(uint_t *)NLA_DATA (a);
+		w->channel = freq_channel (w->freq);
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// station mode : the dump has one station, the AP.
+//------------------------------------------------------------------------------
+static int parse_station (struct nlmsghdr *nh, void *arg)
+{
+	wifi_t *w = arg;
+	struct nlattr *info, *a, *rate;
+
+	if ((info = nla_find (GENL_ATTRS (nh), GENL_ALEN (nh), NL80211_ATTR_STA_INFO)) == NULL)
+		return 0;
+	if ((a = nla_find (NLA_DATA (info), NLA_LEN (info), NL80211_STA_INFO_SIGNAL)) != NULL)
+		w->signal = *(signed char *)NLA_DATA (a);
+	if ((rate = nla_find (NLA_DATA (info), NLA_LEN (info), NL80211_STA_INFO_TX_BITRATE)) != NULL) {
+		// 100 kbit/s
+		if ((a = nla_find (NLA_DATA (rate), NLA_LEN (rate), NL80211_RATE_INFO_BITRATE32)) != NULL)
+			w->bitrate = *(uint_t *)NLA_DATA (a) / 10;
+		else if ((a = nla_find (NLA_DATA (rate), NLA_LEN (rate), NL80211_RATE_INFO_BITRATE)) != NULL)
+			w->bitrate = *(word_t *)NLA_DATA (a) / 10;
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+static int freq_channel (int freq)
+{
+	if (freq == 2484)					return 14;
+	if ((freq >= 2412) && (freq < 2484))	return (freq - 2407) / 5;
+	if ((freq >= 5160) && (freq <= 5885))	return (freq - 5000) / 5;
+	if ((freq >= 5955) && (freq <= 7115))	return (freq - 5950) / 5;
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// false : no nl80211 or not a wireless interface.
+//------------------------------------------------------------------------------
+int wifi_open (const char *ifname)
+{
+	struct timeval tv = { WIFI_RECV_TIMEOUT / 1000, (WIFI_RECV_TIMEOUT % 1000) * 1000 };
+	uint_t group = 0;
+	wifi_t w;
+
+	wifi_close ();
+	if ((IfIndex = if_nametoindex (ifname)) == 0)
+		return false;
+	if ((ReqFd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC)) < 0)
+		return false;
+	setsockopt (ReqFd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+	if (!nl_request (GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 0, NL80211_GENL_NAME) ||
+		(nl_reply (parse_family, &group) <= 0))
+		goto out;
+	// wired interface : no such device.
+	memset (&w, 0, sizeof(w));
+	if (!nl_request (Family, NL80211_CMD_GET_INTERFACE, 0, NULL) ||
+		(nl_reply (parse_iface, &w) <= 0))
+		goto out;
+
+	if (group &&
+		((EvFd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_GENERIC)) >= 0) &&
+		setsockopt (EvFd, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP, &group, sizeof(group))) {
+		close (EvFd);
+		EvFd = -1;
+	}
+	if (EvFd < 0)
+		err ("%s : nl80211 event group fail!\n", ifname);
+
+	Dirty = true;
+	info ("%s : nl80211 family %d, mlme group %u\n", ifname, Family, group);
+	return true;
+out:
+	close (ReqFd);
+	ReqFd = -1;
+	return false;
+}
+
+//------------------------------------------------------------------------------
+void wifi_close (void)
+{
+	if (ReqFd >= 0)	close (ReqFd);
+	if (EvFd  >= 0)	close (EvFd);
+	ReqFd = EvFd = -1;
+	memset (&Cur, 0, sizeof(Cur));
+}
+
+//------------------------------------------------------------------------------
+int wifi_event_fd (void)
+{
+	return EvFd;
+}
+
+//------------------------------------------------------------------------------
+// drain the event socket. return true if the interface was (dis)connected.
+//------------------------------------------------------------------------------
+int wifi_events (void)
+{
+	struct nlmsghdr *nh;
+	struct genlmsghdr *gh;
+	struct nlattr *a;
+	int len, ev = false;
+
+	if (EvFd < 0)
+		return false;
+	while ((len = recv (EvFd, Buf, sizeof(Buf), 0)) > 0) {
+		for (nh = (struct nlmsghdr *)Buf; NLMSG_OK (nh, (uint_t)len); nh = NLMSG_NEXT (nh, len)) {
+			if (nh->nlmsg_type != Family)
+				continue;
+			gh = NLMSG_DATA (nh);
+			switch (gh->cmd) {
+				case	NL80211_CMD_CONNECT:
+				case	NL80211_CMD_DISCONNECT:
+				case	NL80211_CMD_ASSOCIATE:
+				case	NL80211_CMD_DISASSOCIATE:
+				case	NL80211_CMD_DEAUTHENTICATE:
+				case	NL80211_CMD_ROAM:
+					a = nla_find (GENL_ATTRS (nh), GENL_ALEN (nh), NL80211_ATTR_IFINDEX);
+					if (a && (*(uint_t *)NLA_DATA (a) == (uint_t)IfIndex)) {
+						Dirty = true;
+						ev    = true;
+						Cur.events++;
+					}
+					break;
+				default :
+					break;
+			}
+		}
+	}
+	return ev;
+}
+
+//------------------------------------------------------------------------------
+// return true if connected. (signal, bitrate : rate limited)
+//------------------------------------------------------------------------------
+int wifi_status (wifi_t *w)
+{
+	wifi_t now;
+	ulong_t t = wifi_msec ();
+	int n;
+
+	if (ReqFd < 0)
+		return false;
+	wifi_events ();
+
+	memcpy (&now, &Cur, sizeof(now));
+	if (Dirty) {
+		now.ssid[0] = 0;
+		now.freq = now.channel = 0;
+		if (!nl_request (Family, NL80211_CMD_GET_INTERFACE, 0, NULL) ||
+			(nl_reply (parse_iface, &now) < 0))
+			return false;
+	}
+	now.signal = now.bitrate = 0;
+	if (!nl_request (Family, NL80211_CMD_GET_STATION, NLM_F_DUMP, NULL))
+		return false;
+	n = nl_reply (parse_station, &now);
+	now.connected = (n > 0);
+
+	// (re)connected or new ap : all values at once.
+	if (Dirty || (now.connected != Cur.connected)) {
+		Dirty   = false;
+		TSignal = t;
+		memcpy (&Cur, &now, sizeof(Cur));
+		Cur.updates++;
+	} else if (((abs (now.signal - Cur.signal) >= WIFI_SIGNAL_STEP) ||
+				(now.bitrate != Cur.bitrate)) && (t - TSignal >= WIFI_SIGNAL_MS)) {
+		TSignal     = t;
+		Cur.signal  = now.signal;
+		Cur.bitrate = now.bitrate;
+		Cur.updates++;
+	}
+	memcpy (w, &Cur, sizeof(wifi_t));
+	return Cur.connected;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
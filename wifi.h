@@ -0,0 +1,55 @@
+//------------------------------------------------------------------------------
+//
+// 2026.10.19 nl80211 Wi-Fi status. (chalres-park)
+//
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __WIFI_H__
+#define __WIFI_H__
+
+#include "typedefs.h"
+//------------------------------------------------------------------------------
+/*
+	Generic netlink without libnl. wifi_open resolves the nl80211 family and
+	joins its "mlme" group on a second socket : connect, disconnect,
+	(de)associate events of the interface mark the status dirty.
+	(wifi_events drains the socket, idle_watch calls it from the poll)
+
+	wifi_status : interface (ssid, frequency) is read again only when dirty,
+	the station of the AP (signal, tx bitrate) every call. One netlink round
+	trip, about the cost of the ethtool ioctl of the wired link.
+	Signal / bitrate follow the station only if the signal moved
+	WIFI_SIGNAL_STEP or more (or the bitrate changed) and WIFI_SIGNAL_MS
+	passed since the last change, so the LCD is not redrawn for noise.
+*/
+//------------------------------------------------------------------------------
+#define	WIFI_SSID_MAX		32
+#define	WIFI_SIGNAL_STEP	3			// dBm
+#define	WIFI_SIGNAL_MS		5000
+#define	WIFI_RECV_TIMEOUT	1000		// msec, request reply
+#define	WIFI_BUF_SIZE		8192
+
+//------------------------------------------------------------------------------
+typedef struct wifi__t {
+	bool		connected;
+	char		ssid[WIFI_SSID_MAX +1];
+	int			freq;				// MHz
+	int			channel;
+	int			signal;				// dBm
+	int			bitrate;			// Mbps, tx
+	// events / station changes reported
+	ulong_t		events;
+	ulong_t		updates;
+}	wifi_t;
+
+//------------------------------------------------------------------------------
+extern int	wifi_open		(const char *ifname);
+extern void	wifi_close		(void);
+extern int	wifi_event_fd	(void);
+extern int	wifi_events		(void);
+extern int	wifi_status		(wifi_t *w);
+
+//------------------------------------------------------------------------------
+#endif  //  #define __WIFI_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------